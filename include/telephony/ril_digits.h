@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RIL_DIGITS_H
+#define RIL_DIGITS_H
+
+namespace ril {
+namespace util {
+namespace digits {
+
+/**
+ * The decimal strings of 0 to 999, indexed by value
+ */
+struct Table {
+    char str[1000][4];
+};
+
+/**
+ * Build the strings of 0 to 999 at compile time
+ *
+ * @param width the number of digits to zero pad to, or 0 for as few digits as each value needs
+ *
+ * @return the table
+ */
+constexpr Table makeTable(int width) {
+    Table table{};
+    for (int value = 0; value < 1000; value++) {
+        int len = width;
+        if (len == 0) {
+            len = value >= 100 ? 3 : (value >= 10 ? 2 : 1);
+        }
+
+        int rest = value;
+        for (int i = len - 1; i >= 0; i--) {
+            table.str[value][i] = '0' + rest % 10;
+            rest /= 10;
+        }
+        table.str[value][len] = '\0';
+    }
+    return table;
+}
+
+/* "000" to "999"; skipping the first character gives the 2 digit form */
+inline constexpr Table kPadded = makeTable(3);
+
+/* "0" to "999" */
+inline constexpr Table kMinimal = makeTable(0);
+
+}
+}
+}
+#endif /* !defined(RIL_DIGITS_H) */
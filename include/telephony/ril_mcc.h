@@ -21,10 +21,26 @@
 #include <cstdio>
 #include <string>
 
+#include <telephony/ril_digits.h>
+
 namespace ril {
 namespace util {
 namespace mcc {
 
+/**
+ * Decode an integer mcc as a 3 digit string, without allocating
+ *
+ * @param an integer mcc, its range should be in 0 to 999.
+ *
+ * @return a static string representation of the MCC or an empty string
+ * if the MCC is not a valid MCC value.
+ */
+static inline const char *decodeStr(int mcc) {
+    if (mcc > 999 || mcc < 0) return "";
+
+    return digits::kPadded.str[mcc];
+}
+
 /**
  * Decode an integer mcc and encode as 3 digit string
  *
@@ -34,11 +50,7 @@ namespace mcc {
  * if the MCC is not a valid MCC value.
  */
 static inline std::string decode(int mcc) {
-    char mccStr[4] = {0};
-    if (mcc > 999 || mcc < 0) return "";
-
-    snprintf(mccStr, sizeof(mccStr), "%03d", mcc);
-    return mccStr;
+    return decodeStr(mcc);
 }
 
 // echo -e "#include \"hardware/ril/include/telephony/ril_mcc.h\"\nint main()"\
@@ -61,6 +73,12 @@ static int test() {
         if (decode(legacy_mccs[i].in).compare(legacy_mccs[i].out)) return 1;
     }
 
+    for (int mcc = 0; mcc <= 999; mcc++) {
+        char mccStr[4] = {0};
+        snprintf(mccStr, sizeof(mccStr), "%03d", mcc);
+        if (decode(mcc).compare(mccStr)) return 1;
+    }
+
     return 0;
 }
 #endif
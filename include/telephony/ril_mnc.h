@@ -21,20 +21,23 @@
 #include <cstdio>
 #include <string>
 
+#include <telephony/ril_digits.h>
+
 namespace ril {
 namespace util {
 namespace mnc {
 
 /**
- * Decode an MNC with an optional length indicator provided in the most-significant nibble.
+ * Decode an MNC with an optional length indicator provided in the most-significant nibble,
+ * without allocating.
  *
  * @param mnc an encoded MNC value; if no encoding is provided, then the string is returned
  *     as a minimum length string representing the provided integer.
  *
- * @return string representation of an encoded MNC or an empty string if the MNC is not a valid
- *     MNC value.
+ * @return a static string representation of an encoded MNC or an empty string if the MNC is
+ *     not a valid MNC value.
  */
-static inline std::string decode(int mnc) {
+static inline const char *decodeStr(int mnc) {
     if (mnc == INT_MAX || mnc < 0) return "";
     unsigned umnc = mnc;
     char mncNumDigits = (umnc >> (sizeof(int) * 8 - 4)) & 0xF;
@@ -42,26 +45,35 @@ static inline std::string decode(int mnc) {
     umnc = (umnc << 4) >> 4;
     if (umnc > 999) return "";
 
-    char mncStr[4] = {0};
     switch (mncNumDigits) {
         case 0:
             // Legacy MNC report hasn't set the number of digits; preserve current
             // behavior and make a string of the minimum number of required digits.
-            return std::to_string(umnc);
+            return digits::kMinimal.str[umnc];
 
         case 2:
-            snprintf(mncStr, sizeof(mncStr), "%03.3u", umnc);
-            return mncStr + 1;
+            return digits::kPadded.str[umnc] + 1;
 
         case 3:
-            snprintf(mncStr, sizeof(mncStr), "%03.3u", umnc);
-            return mncStr;
+            return digits::kPadded.str[umnc];
 
         default:
             // Error case
             return "";
     }
+}
 
+/**
+ * Decode an MNC with an optional length indicator provided in the most-significant nibble.
+ *
+ * @param mnc an encoded MNC value; if no encoding is provided, then the string is returned
+ *     as a minimum length string representing the provided integer.
+ *
+ * @return string representation of an encoded MNC or an empty string if the MNC is not a valid
+ *     MNC value.
+ */
+static inline std::string decode(int mnc) {
+    return decodeStr(mnc);
 }
 
 /**
@@ -139,6 +151,14 @@ static int test() {
         if (decode(legacy_mncs[i].in).compare(legacy_mncs[i].out)) return 1;
     }
 
+    for (int mnc = 0; mnc <= 999; mnc++) {
+        char mncStr[4] = {0};
+        snprintf(mncStr, sizeof(mncStr), "%03.3u", mnc);
+        if (decode(encode(mnc, 3)).compare(mncStr)) return 1;
+        if (decode(encode(mnc, 2)).compare(mncStr + 1)) return 1;
+        if (decode(mnc).compare(std::to_string(mnc))) return 1;
+    }
+
     return 0;
 }
 #endif
@@ -0,0 +1,1033 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * In-process load generator for libril itself
+ *
+ * Registers a synthetic vendor RIL that answers every request with a canned
+ * response, either inline from onRequest or after a fixed delay on the libril
+ * event loop, and installs recording IRadioResponse / IRadioIndication sinks
+ * on the slot's RadioImpl. Requests go in through the IRadio methods and come
+ * back through the response converters, so the numbers are libril's own
+ * overhead: dispatch, the pending request list, RIL_onRequestComplete, the
+ * radio service rwlock and the HIDL conversions. No modem, no binder.
+ *
+ * The "new/op" column counts operator new calls made on the driving thread
+ * per operation, which covers the hidl_vec buffers the converters allocate
+ * (hidl_string copies use malloc() and are not counted). Responses are only
+ * converted on the driving thread with -d 0.
+ *
+ * All request threads drive one slot, so they take turns in that slot's
+ * onRequest() queue; -s prints libril's own stats at the end, including the
+ * time requests spent queued there.
+ *
+ * Stop the radio HAL service first; the bench registers the same service name.
+ *
+ *   libril-bench -t 4 -n 20000 -r signal,calls,datacalls
+ *   libril-bench -t 8 -d 200 -u 2 -i signal,sms
+ *   libril-bench -t 1 -n 1000 -r cellinfo -u 1 -i cellinfo,datacalls,hwconfig
+ */
+
+#include <android/hardware/radio/1.1/IRadio.h>
+#include <android/hardware/radio/1.1/IRadioIndication.h>
+#include <android/hardware/radio/1.1/IRadioResponse.h>
+#include <android/hardware/radio/1.1/types.h>
+
+#include <telephony/ril.h>
+#include <ril_service.h>
+#include <ril_stats.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <vector>
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace android::hardware::radio;
+using namespace android::hardware::radio::V1_0;
+using ::android::hardware::Return;
+using ::android::hardware::hidl_string;
+using ::android::hardware::hidl_vec;
+using ::android::hardware::Void;
+using android::sp;
+
+extern "C" void RIL_startEventLoop(void);
+
+#define MAX_THREADS         64
+#define MAX_UNSOL_CODES     64
+#define BENCH_SLOT          0
+
+static long long nowUsec() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*** Allocation counting ***/
+
+static thread_local long long t_newCalls = 0;
+
+void *operator new(size_t size) {
+    t_newCalls++;
+    void *p = malloc(size > 0 ? size : 1);
+    if (p == NULL) {
+        abort();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t size) noexcept {
+    free(p);
+}
+
+/*** Canned vendor responses ***/
+
+static RIL_SignalStrength_v10 s_signalStrength;
+static RIL_Call s_calls[2];
+static RIL_Call *s_callList[2] = { &s_calls[0], &s_calls[1] };
+static const char *s_operator[3] = { "Android", "Android", "310260" };
+static const char *s_voiceRegState[15] = {
+    "1", "1a2b", "0000c3d4", "14", NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+    "0", NULL
+};
+static const char *s_dataRegState[11] = {
+    "1", "1a2b", "0000c3d4", "14", NULL, "20", NULL, NULL, NULL, NULL, NULL
+};
+static RIL_Data_Call_Response_v11 s_dataCalls[1];
+/* the serving LTE cell and two GSM neighbours */
+static RIL_CellInfo_v12 s_cellInfo[3];
+static RIL_HardwareConfig s_hardwareConfig[2];
+static const char *s_imsi = "310260000000000";
+static RIL_CardStatus_v6 s_cardStatus;
+static RIL_SMS_Response s_smsResponse;
+/* a 3GPP SMS-DELIVER from +15555550000, "hello" */
+static const char *s_newSmsPdu = "0891683108200505f0040b915155555500f000006220708104030005e8329bfd06";
+
+static void initCannedResponses() {
+    s_signalStrength.GW_SignalStrength.signalStrength = 20;
+    s_signalStrength.GW_SignalStrength.bitErrorRate = 99;
+    s_signalStrength.CDMA_SignalStrength.dbm = -1;
+    s_signalStrength.CDMA_SignalStrength.ecio = -1;
+    s_signalStrength.EVDO_SignalStrength.dbm = -1;
+    s_signalStrength.EVDO_SignalStrength.ecio = -1;
+    s_signalStrength.EVDO_SignalStrength.signalNoiseRatio = -1;
+    s_signalStrength.LTE_SignalStrength.signalStrength = 25;
+    s_signalStrength.LTE_SignalStrength.rsrp = 90;
+    s_signalStrength.LTE_SignalStrength.rsrq = 10;
+    s_signalStrength.LTE_SignalStrength.rssnr = 100;
+    s_signalStrength.LTE_SignalStrength.cqi = 15;
+    s_signalStrength.LTE_SignalStrength.timingAdvance = INT_MAX;
+    s_signalStrength.TD_SCDMA_SignalStrength.rscp = INT_MAX;
+
+    for (int i = 0; i < 2; i++) {
+        s_calls[i].state = i == 0 ? RIL_CALL_ACTIVE : RIL_CALL_HOLDING;
+        s_calls[i].index = i + 1;
+        s_calls[i].toa = 145;
+        s_calls[i].isMT = i;
+        s_calls[i].isVoice = 1;
+        s_calls[i].number = (char *) (i == 0 ? "+15555550000" : "+15555550001");
+        s_calls[i].numberPresentation = 0;
+        s_calls[i].namePresentation = 2;
+    }
+
+    s_dataCalls[0].status = 0;
+    s_dataCalls[0].suggestedRetryTime = -1;
+    s_dataCalls[0].cid = 1;
+    s_dataCalls[0].active = 2;
+    s_dataCalls[0].type = (char *) "IPV4V6";
+    s_dataCalls[0].ifname = (char *) "rmnet0";
+    s_dataCalls[0].addresses = (char *) "10.0.2.15/24 2001:db8::15/64";
+    s_dataCalls[0].dnses = (char *) "10.0.2.3 2001:db8::3";
+    s_dataCalls[0].gateways = (char *) "10.0.2.2 2001:db8::2";
+    s_dataCalls[0].pcscf = (char *) "";
+    s_dataCalls[0].mtu = 1500;
+
+    s_cellInfo[0].cellInfoType = RIL_CELL_INFO_TYPE_LTE;
+    s_cellInfo[0].registered = 1;
+    s_cellInfo[0].CellInfo.lte.cellIdentityLte.mcc = 310;
+    s_cellInfo[0].CellInfo.lte.cellIdentityLte.mnc = 260;
+    s_cellInfo[0].CellInfo.lte.cellIdentityLte.ci = 0x0000c3d4;
+    s_cellInfo[0].CellInfo.lte.cellIdentityLte.pci = 1;
+    s_cellInfo[0].CellInfo.lte.cellIdentityLte.tac = 0x1a2b;
+    s_cellInfo[0].CellInfo.lte.cellIdentityLte.earfcn = 5110;
+    s_cellInfo[0].CellInfo.lte.signalStrengthLte.signalStrength = 25;
+    s_cellInfo[0].CellInfo.lte.signalStrengthLte.rsrp = 90;
+    s_cellInfo[0].CellInfo.lte.signalStrengthLte.rsrq = 10;
+    s_cellInfo[0].CellInfo.lte.signalStrengthLte.rssnr = 100;
+    s_cellInfo[0].CellInfo.lte.signalStrengthLte.cqi = 15;
+    s_cellInfo[0].CellInfo.lte.signalStrengthLte.timingAdvance = INT_MAX;
+    for (int i = 1; i < 3; i++) {
+        s_cellInfo[i].cellInfoType = RIL_CELL_INFO_TYPE_GSM;
+        s_cellInfo[i].CellInfo.gsm.cellIdentityGsm.mcc = 310;
+        s_cellInfo[i].CellInfo.gsm.cellIdentityGsm.mnc = 260;
+        s_cellInfo[i].CellInfo.gsm.cellIdentityGsm.lac = 0x1a2b;
+        s_cellInfo[i].CellInfo.gsm.cellIdentityGsm.cid = 0x0000c3d4 + i;
+        s_cellInfo[i].CellInfo.gsm.cellIdentityGsm.arfcn = 128 + i;
+        s_cellInfo[i].CellInfo.gsm.cellIdentityGsm.bsic = i;
+        s_cellInfo[i].CellInfo.gsm.signalStrengthGsm.signalStrength = 10 + i;
+        s_cellInfo[i].CellInfo.gsm.signalStrengthGsm.bitErrorRate = 99;
+        s_cellInfo[i].CellInfo.gsm.signalStrengthGsm.timingAdvance = INT_MAX;
+    }
+
+    s_hardwareConfig[0].type = RIL_HARDWARE_CONFIG_MODEM;
+    strlcpy(s_hardwareConfig[0].uuid, "modem0", sizeof(s_hardwareConfig[0].uuid));
+    s_hardwareConfig[0].state = RIL_HARDWARE_CONFIG_STATE_ENABLED;
+    s_hardwareConfig[0].cfg.modem.rat = 0x1ffff;
+    s_hardwareConfig[0].cfg.modem.maxVoice = 1;
+    s_hardwareConfig[0].cfg.modem.maxData = 1;
+    s_hardwareConfig[0].cfg.modem.maxStandby = 1;
+    s_hardwareConfig[1].type = RIL_HARDWARE_CONFIG_SIM;
+    strlcpy(s_hardwareConfig[1].uuid, "sim0", sizeof(s_hardwareConfig[1].uuid));
+    s_hardwareConfig[1].state = RIL_HARDWARE_CONFIG_STATE_ENABLED;
+    strlcpy(s_hardwareConfig[1].cfg.sim.modemUuid, "modem0",
+            sizeof(s_hardwareConfig[1].cfg.sim.modemUuid));
+
+    s_cardStatus.card_state = RIL_CARDSTATE_PRESENT;
+    s_cardStatus.universal_pin_state = RIL_PINSTATE_UNKNOWN;
+    s_cardStatus.gsm_umts_subscription_app_index = 0;
+    s_cardStatus.cdma_subscription_app_index = -1;
+    s_cardStatus.ims_subscription_app_index = -1;
+    s_cardStatus.num_applications = 1;
+    s_cardStatus.applications[0].app_type = RIL_APPTYPE_USIM;
+    s_cardStatus.applications[0].app_state = RIL_APPSTATE_READY;
+    s_cardStatus.applications[0].perso_substate = RIL_PERSOSUBSTATE_READY;
+    s_cardStatus.applications[0].aid_ptr = (char *) "a0000000871002ff86ff0389ffffffff";
+    s_cardStatus.applications[0].app_label_ptr = (char *) "USIM";
+    s_cardStatus.applications[0].pin1 = RIL_PINSTATE_ENABLED_VERIFIED;
+    s_cardStatus.applications[0].pin2 = RIL_PINSTATE_ENABLED_NOT_VERIFIED;
+
+    s_smsResponse.messageRef = 7;
+    s_smsResponse.ackPDU = NULL;
+    s_smsResponse.errorCode = -1;
+}
+
+/*** Synthetic vendor RIL ***/
+
+static long long s_completionDelayUsec = 0;
+static std::atomic<long long> s_vendorRequests(0);
+
+static void completeRequest(int request, RIL_Token t) {
+    switch (request) {
+        case RIL_REQUEST_SIGNAL_STRENGTH:
+            RIL_onRequestComplete(t, RIL_E_SUCCESS, &s_signalStrength, sizeof(s_signalStrength));
+            break;
+        case RIL_REQUEST_GET_CURRENT_CALLS:
+            RIL_onRequestComplete(t, RIL_E_SUCCESS, s_callList, sizeof(s_callList));
+            break;
+        case RIL_REQUEST_OPERATOR:
+            RIL_onRequestComplete(t, RIL_E_SUCCESS, s_operator, sizeof(s_operator));
+            break;
+        case RIL_REQUEST_VOICE_REGISTRATION_STATE:
+            RIL_onRequestComplete(t, RIL_E_SUCCESS, s_voiceRegState, sizeof(s_voiceRegState));
+            break;
+        case RIL_REQUEST_DATA_REGISTRATION_STATE:
+            RIL_onRequestComplete(t, RIL_E_SUCCESS, s_dataRegState, sizeof(s_dataRegState));
+            break;
+        case RIL_REQUEST_DATA_CALL_LIST:
+            RIL_onRequestComplete(t, RIL_E_SUCCESS, s_dataCalls, sizeof(s_dataCalls));
+            break;
+        case RIL_REQUEST_GET_CELL_INFO_LIST:
+            RIL_onRequestComplete(t, RIL_E_SUCCESS, s_cellInfo, sizeof(s_cellInfo));
+            break;
+        case RIL_REQUEST_GET_IMSI:
+            RIL_onRequestComplete(t, RIL_E_SUCCESS, (void *) s_imsi, sizeof(char *));
+            break;
+        case RIL_REQUEST_GET_SIM_STATUS:
+            RIL_onRequestComplete(t, RIL_E_SUCCESS, &s_cardStatus, sizeof(s_cardStatus));
+            break;
+        case RIL_REQUEST_SEND_SMS:
+            RIL_onRequestComplete(t, RIL_E_SUCCESS, &s_smsResponse, sizeof(s_smsResponse));
+            break;
+        default:
+            RIL_onRequestComplete(t, RIL_E_SUCCESS, NULL, 0);
+            break;
+    }
+}
+
+typedef struct {
+    int request;
+    RIL_Token t;
+} DelayedCompletion;
+
+static void onCompletionTimer(void *param) {
+    DelayedCompletion *p_completion = (DelayedCompletion *) param;
+
+    completeRequest(p_completion->request, p_completion->t);
+    free(p_completion);
+}
+
+#if defined(ANDROID_MULTI_SIM)
+static void benchOnRequest(int request, void *data, size_t datalen, RIL_Token t,
+        RIL_SOCKET_ID socket_id) {
+#else
+static void benchOnRequest(int request, void *data, size_t datalen, RIL_Token t) {
+#endif
+    s_vendorRequests.fetch_add(1, std::memory_order_relaxed);
+
+    if (s_completionDelayUsec == 0) {
+        completeRequest(request, t);
+        return;
+    }
+
+    DelayedCompletion *p_completion = (DelayedCompletion *) malloc(sizeof(DelayedCompletion));
+    if (p_completion == NULL) {
+        RIL_onRequestComplete(t, RIL_E_NO_MEMORY, NULL, 0);
+        return;
+    }
+    p_completion->request = request;
+    p_completion->t = t;
+
+    struct timeval relativeTime;
+    relativeTime.tv_sec = s_completionDelayUsec / 1000000;
+    relativeTime.tv_usec = s_completionDelayUsec % 1000000;
+    RIL_requestTimedCallback(onCompletionTimer, p_completion, &relativeTime);
+}
+
+#if defined(ANDROID_MULTI_SIM)
+static RIL_RadioState benchOnStateRequest(RIL_SOCKET_ID socket_id) {
+#else
+static RIL_RadioState benchOnStateRequest() {
+#endif
+    return RADIO_STATE_ON;
+}
+
+static int benchOnSupports(int requestCode) {
+    return 1;
+}
+
+static void benchOnCancel(RIL_Token t) {
+}
+
+static const char *benchGetVersion(void) {
+    return "libril-bench";
+}
+
+static const RIL_RadioFunctions s_benchFunctions = {
+    RIL_VERSION,
+    benchOnRequest,
+    benchOnStateRequest,
+    benchOnSupports,
+    benchOnCancel,
+    benchGetVersion
+};
+
+/*** Request mix ***/
+
+typedef struct {
+    const char *name;
+    int request;
+    void (*issue)(const sp<V1_1::IRadio>& radio, int32_t serial);
+} BenchRequest;
+
+static void issueSignalStrength(const sp<V1_1::IRadio>& radio, int32_t serial) {
+    radio->getSignalStrength(serial);
+}
+
+static void issueCurrentCalls(const sp<V1_1::IRadio>& radio, int32_t serial) {
+    radio->getCurrentCalls(serial);
+}
+
+static void issueOperator(const sp<V1_1::IRadio>& radio, int32_t serial) {
+    radio->getOperator(serial);
+}
+
+static void issueVoiceRegState(const sp<V1_1::IRadio>& radio, int32_t serial) {
+    radio->getVoiceRegistrationState(serial);
+}
+
+static void issueDataRegState(const sp<V1_1::IRadio>& radio, int32_t serial) {
+    radio->getDataRegistrationState(serial);
+}
+
+static void issueDataCallList(const sp<V1_1::IRadio>& radio, int32_t serial) {
+    radio->getDataCallList(serial);
+}
+
+static void issueCellInfoList(const sp<V1_1::IRadio>& radio, int32_t serial) {
+    radio->getCellInfoList(serial);
+}
+
+static void issueImsi(const sp<V1_1::IRadio>& radio, int32_t serial) {
+    radio->getImsiForApp(serial, hidl_string("a0000000871002ff86ff0389ffffffff"));
+}
+
+static void issueSimStatus(const sp<V1_1::IRadio>& radio, int32_t serial) {
+    radio->getIccCardStatus(serial);
+}
+
+static void issueSendSms(const sp<V1_1::IRadio>& radio, int32_t serial) {
+    GsmSmsMessage message;
+    /* a 3GPP SMS-SUBMIT to +15555550000, "hello" */
+    message.pdu = "01000b915155555500f0000005e8329bfd06";
+    radio->sendSms(serial, message);
+}
+
+static const BenchRequest s_requests[] = {
+    { "signal",     RIL_REQUEST_SIGNAL_STRENGTH,            issueSignalStrength },
+    { "calls",      RIL_REQUEST_GET_CURRENT_CALLS,          issueCurrentCalls },
+    { "operator",   RIL_REQUEST_OPERATOR,                   issueOperator },
+    { "voicereg",   RIL_REQUEST_VOICE_REGISTRATION_STATE,   issueVoiceRegState },
+    { "datareg",    RIL_REQUEST_DATA_REGISTRATION_STATE,    issueDataRegState },
+    { "datacalls",  RIL_REQUEST_DATA_CALL_LIST,             issueDataCallList },
+    { "cellinfo",   RIL_REQUEST_GET_CELL_INFO_LIST,         issueCellInfoList },
+    { "imsi",       RIL_REQUEST_GET_IMSI,                   issueImsi },
+    { "simstatus",  RIL_REQUEST_GET_SIM_STATUS,             issueSimStatus },
+    { "sms",        RIL_REQUEST_SEND_SMS,                   issueSendSms },
+};
+#define NUM_REQUESTS ((int) (sizeof(s_requests) / sizeof(s_requests[0])))
+
+typedef struct {
+    const char *name;
+    int unsolResponse;
+    const void *data;
+    size_t datalen;
+} BenchIndication;
+
+static BenchIndication s_indications[] = {
+    { "signal",     RIL_UNSOL_SIGNAL_STRENGTH,                      &s_signalStrength,
+            sizeof(s_signalStrength) },
+    { "callstate",  RIL_UNSOL_RESPONSE_CALL_STATE_CHANGED,          NULL, 0 },
+    { "network",    RIL_UNSOL_RESPONSE_VOICE_NETWORK_STATE_CHANGED, NULL, 0 },
+    { "datacalls",  RIL_UNSOL_DATA_CALL_LIST_CHANGED,               s_dataCalls,
+            sizeof(s_dataCalls) },
+    { "cellinfo",   RIL_UNSOL_CELL_INFO_LIST,                       s_cellInfo,
+            sizeof(s_cellInfo) },
+    { "hwconfig",   RIL_UNSOL_HARDWARE_CONFIG_CHANGED,              s_hardwareConfig,
+            sizeof(s_hardwareConfig) },
+    { "sms",        RIL_UNSOL_RESPONSE_NEW_SMS,                     NULL, 0 },
+};
+#define NUM_INDICATIONS ((int) (sizeof(s_indications) / sizeof(s_indications[0])))
+
+/*** Driver threads ***/
+
+/* one closed-loop request driver; the response sink finds it by serial */
+typedef struct {
+    int id;
+    pthread_t tid;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int32_t serial;             /* request in flight, -1 if none */
+    bool done;
+    RadioError error;
+    long long start;
+    std::vector<long long> samples[NUM_REQUESTS];
+    int errors[NUM_REQUESTS];
+    long long newCalls[NUM_REQUESTS];
+} RequestDriver;
+
+typedef struct {
+    int id;
+    pthread_t tid;
+    std::vector<long long> samples[NUM_INDICATIONS];
+    long long newCalls[NUM_INDICATIONS];
+} IndicationDriver;
+
+static sp<V1_1::IRadio> s_radio;
+static RequestDriver s_requestDrivers[MAX_THREADS];
+static IndicationDriver s_indicationDrivers[MAX_THREADS];
+static int s_numRequestThreads = 4;
+static int s_numIndicationThreads = 0;
+static int s_requestsPerThread = 10000;
+static int s_indicationsPerThread = 10000;
+static const BenchRequest *s_requestMix[NUM_REQUESTS];
+static int s_numRequestMix = 0;
+static const BenchIndication *s_indicationMix[NUM_INDICATIONS];
+static int s_numIndicationMix = 0;
+
+static std::atomic<long long> s_unsolicitedResponses(0);
+static std::atomic<long long> s_responses(0);
+static std::atomic<long long> s_strayResponses(0);
+static std::atomic<long long> s_indicationCounts[MAX_UNSOL_CODES];
+
+static void recordResponse(const RadioResponseInfo& info) {
+    s_responses.fetch_add(1, std::memory_order_relaxed);
+
+    if (info.serial < 0) {
+        s_strayResponses.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    RequestDriver *driver = &s_requestDrivers[info.serial % s_numRequestThreads];
+
+    pthread_mutex_lock(&driver->mutex);
+    if (driver->serial != info.serial || driver->done) {
+        s_strayResponses.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        driver->error = info.error;
+        driver->done = true;
+        pthread_cond_signal(&driver->cond);
+    }
+    pthread_mutex_unlock(&driver->mutex);
+}
+
+static void recordIndication(int unsolResponse) {
+    int index = unsolResponse - RIL_UNSOL_RESPONSE_BASE;
+
+    s_unsolicitedResponses.fetch_add(1, std::memory_order_relaxed);
+    if (index >= 0 && index < MAX_UNSOL_CODES) {
+        s_indicationCounts[index].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+static void *requestLoop(void *param) {
+    RequestDriver *driver = (RequestDriver *) param;
+
+    for (int i = 0; i < s_requestsPerThread; i++) {
+        int mixIndex = (i + driver->id) % s_numRequestMix;
+        const BenchRequest *p_req = s_requestMix[mixIndex];
+
+        pthread_mutex_lock(&driver->mutex);
+        driver->serial = i * s_numRequestThreads + driver->id;
+        driver->done = false;
+        driver->start = nowUsec();
+        pthread_mutex_unlock(&driver->mutex);
+
+        long long newCalls = t_newCalls;
+        p_req->issue(s_radio, i * s_numRequestThreads + driver->id);
+        newCalls = t_newCalls - newCalls;
+
+        pthread_mutex_lock(&driver->mutex);
+        while (!driver->done) {
+            pthread_cond_wait(&driver->cond, &driver->mutex);
+        }
+        driver->samples[mixIndex].push_back(nowUsec() - driver->start);
+        driver->newCalls[mixIndex] += newCalls;
+        if (driver->error != RadioError::NONE) {
+            driver->errors[mixIndex]++;
+        }
+        driver->serial = -1;
+        pthread_mutex_unlock(&driver->mutex);
+    }
+
+    return NULL;
+}
+
+static void *indicationLoop(void *param) {
+    IndicationDriver *driver = (IndicationDriver *) param;
+
+    for (int i = 0; i < s_indicationsPerThread; i++) {
+        int mixIndex = (i + driver->id) % s_numIndicationMix;
+        const BenchIndication *p_ind = s_indicationMix[mixIndex];
+        long long start = nowUsec();
+        long long newCalls = t_newCalls;
+
+#if defined(ANDROID_MULTI_SIM)
+        RIL_onUnsolicitedResponse(p_ind->unsolResponse, p_ind->data, p_ind->datalen,
+                (RIL_SOCKET_ID) BENCH_SLOT);
+#else
+        RIL_onUnsolicitedResponse(p_ind->unsolResponse, p_ind->data, p_ind->datalen);
+#endif
+        driver->samples[mixIndex].push_back(nowUsec() - start);
+        driver->newCalls[mixIndex] += t_newCalls - newCalls;
+    }
+
+    return NULL;
+}
+
+/*** Recording sinks ***/
+
+#define BENCH_RESPONSE(name, ...) \
+    Return<void> name(const RadioResponseInfo& info, ##__VA_ARGS__) override { \
+        recordResponse(info); \
+        return Void(); \
+    }
+
+#define BENCH_INDICATION(name, unsolResponse, ...) \
+    Return<void> name(RadioIndicationType type, ##__VA_ARGS__) override { \
+        recordIndication(unsolResponse); \
+        return Void(); \
+    }
+
+struct BenchRadioResponse : public V1_1::IRadioResponse {
+    Return<void> acknowledgeRequest(int32_t serial) override {
+        return Void();
+    }
+
+    BENCH_RESPONSE(getIccCardStatusResponse, const CardStatus& cardStatus)
+    BENCH_RESPONSE(supplyIccPinForAppResponse, int32_t remainingRetries)
+    BENCH_RESPONSE(supplyIccPukForAppResponse, int32_t remainingRetries)
+    BENCH_RESPONSE(supplyIccPin2ForAppResponse, int32_t remainingRetries)
+    BENCH_RESPONSE(supplyIccPuk2ForAppResponse, int32_t remainingRetries)
+    BENCH_RESPONSE(changeIccPinForAppResponse, int32_t remainingRetries)
+    BENCH_RESPONSE(changeIccPin2ForAppResponse, int32_t remainingRetries)
+    BENCH_RESPONSE(supplyNetworkDepersonalizationResponse, int32_t remainingRetries)
+    BENCH_RESPONSE(getCurrentCallsResponse, const hidl_vec<Call>& calls)
+    BENCH_RESPONSE(dialResponse)
+    BENCH_RESPONSE(getIMSIForAppResponse, const hidl_string& imsi)
+    BENCH_RESPONSE(hangupConnectionResponse)
+    BENCH_RESPONSE(hangupWaitingOrBackgroundResponse)
+    BENCH_RESPONSE(hangupForegroundResumeBackgroundResponse)
+    BENCH_RESPONSE(switchWaitingOrHoldingAndActiveResponse)
+    BENCH_RESPONSE(conferenceResponse)
+    BENCH_RESPONSE(rejectCallResponse)
+    BENCH_RESPONSE(getLastCallFailCauseResponse, const LastCallFailCauseInfo& failCauseInfo)
+    BENCH_RESPONSE(getSignalStrengthResponse, const SignalStrength& sigStrength)
+    BENCH_RESPONSE(getVoiceRegistrationStateResponse, const VoiceRegStateResult& voiceRegResponse)
+    BENCH_RESPONSE(getDataRegistrationStateResponse, const DataRegStateResult& dataRegResponse)
+    BENCH_RESPONSE(getOperatorResponse, const hidl_string& longName, const hidl_string& shortName,
+            const hidl_string& numeric)
+    BENCH_RESPONSE(setRadioPowerResponse)
+    BENCH_RESPONSE(sendDtmfResponse)
+    BENCH_RESPONSE(sendSmsResponse, const SendSmsResult& sms)
+    BENCH_RESPONSE(sendSMSExpectMoreResponse, const SendSmsResult& sms)
+    BENCH_RESPONSE(setupDataCallResponse, const SetupDataCallResult& dcResponse)
+    BENCH_RESPONSE(iccIOForAppResponse, const IccIoResult& iccIo)
+    BENCH_RESPONSE(sendUssdResponse)
+    BENCH_RESPONSE(cancelPendingUssdResponse)
+    BENCH_RESPONSE(getClirResponse, int32_t n, int32_t m)
+    BENCH_RESPONSE(setClirResponse)
+    BENCH_RESPONSE(getCallForwardStatusResponse, const hidl_vec<CallForwardInfo>& callForwardInfos)
+    BENCH_RESPONSE(setCallForwardResponse)
+    BENCH_RESPONSE(getCallWaitingResponse, bool enable, int32_t serviceClass)
+    BENCH_RESPONSE(setCallWaitingResponse)
+    BENCH_RESPONSE(acknowledgeLastIncomingGsmSmsResponse)
+    BENCH_RESPONSE(acceptCallResponse)
+    BENCH_RESPONSE(deactivateDataCallResponse)
+    BENCH_RESPONSE(getFacilityLockForAppResponse, int32_t response)
+    BENCH_RESPONSE(setFacilityLockForAppResponse, int32_t retry)
+    BENCH_RESPONSE(setBarringPasswordResponse)
+    BENCH_RESPONSE(getNetworkSelectionModeResponse, bool manual)
+    BENCH_RESPONSE(setNetworkSelectionModeAutomaticResponse)
+    BENCH_RESPONSE(setNetworkSelectionModeManualResponse)
+    BENCH_RESPONSE(getAvailableNetworksResponse, const hidl_vec<OperatorInfo>& networkInfos)
+    BENCH_RESPONSE(startDtmfResponse)
+    BENCH_RESPONSE(stopDtmfResponse)
+    BENCH_RESPONSE(getBasebandVersionResponse, const hidl_string& version)
+    BENCH_RESPONSE(separateConnectionResponse)
+    BENCH_RESPONSE(setMuteResponse)
+    BENCH_RESPONSE(getMuteResponse, bool enable)
+    BENCH_RESPONSE(getClipResponse, ClipStatus status)
+    BENCH_RESPONSE(getDataCallListResponse, const hidl_vec<SetupDataCallResult>& dcResponse)
+    BENCH_RESPONSE(setSuppServiceNotificationsResponse)
+    BENCH_RESPONSE(writeSmsToSimResponse, int32_t index)
+    BENCH_RESPONSE(deleteSmsOnSimResponse)
+    BENCH_RESPONSE(setBandModeResponse)
+    BENCH_RESPONSE(getAvailableBandModesResponse, const hidl_vec<RadioBandMode>& bandModes)
+    BENCH_RESPONSE(sendEnvelopeResponse, const hidl_string& commandResponse)
+    BENCH_RESPONSE(sendTerminalResponseToSimResponse)
+    BENCH_RESPONSE(handleStkCallSetupRequestFromSimResponse)
+    BENCH_RESPONSE(explicitCallTransferResponse)
+    BENCH_RESPONSE(setPreferredNetworkTypeResponse)
+    BENCH_RESPONSE(getPreferredNetworkTypeResponse, PreferredNetworkType nwType)
+    BENCH_RESPONSE(getNeighboringCidsResponse, const hidl_vec<NeighboringCell>& cells)
+    BENCH_RESPONSE(setLocationUpdatesResponse)
+    BENCH_RESPONSE(setCdmaSubscriptionSourceResponse)
+    BENCH_RESPONSE(setCdmaRoamingPreferenceResponse)
+    BENCH_RESPONSE(getCdmaRoamingPreferenceResponse, CdmaRoamingType type)
+    BENCH_RESPONSE(setTTYModeResponse)
+    BENCH_RESPONSE(getTTYModeResponse, TtyMode mode)
+    BENCH_RESPONSE(setPreferredVoicePrivacyResponse)
+    BENCH_RESPONSE(getPreferredVoicePrivacyResponse, bool enable)
+    BENCH_RESPONSE(sendCDMAFeatureCodeResponse)
+    BENCH_RESPONSE(sendBurstDtmfResponse)
+    BENCH_RESPONSE(sendCdmaSmsResponse, const SendSmsResult& sms)
+    BENCH_RESPONSE(acknowledgeLastIncomingCdmaSmsResponse)
+    BENCH_RESPONSE(getGsmBroadcastConfigResponse,
+            const hidl_vec<GsmBroadcastSmsConfigInfo>& configs)
+    BENCH_RESPONSE(setGsmBroadcastConfigResponse)
+    BENCH_RESPONSE(setGsmBroadcastActivationResponse)
+    BENCH_RESPONSE(getCdmaBroadcastConfigResponse,
+            const hidl_vec<CdmaBroadcastSmsConfigInfo>& configs)
+    BENCH_RESPONSE(setCdmaBroadcastConfigResponse)
+    BENCH_RESPONSE(setCdmaBroadcastActivationResponse)
+    BENCH_RESPONSE(getCDMASubscriptionResponse, const hidl_string& mdn, const hidl_string& hSid,
+            const hidl_string& hNid, const hidl_string& min, const hidl_string& prl)
+    BENCH_RESPONSE(writeSmsToRuimResponse, uint32_t index)
+    BENCH_RESPONSE(deleteSmsOnRuimResponse)
+    BENCH_RESPONSE(getDeviceIdentityResponse, const hidl_string& imei, const hidl_string& imeisv,
+            const hidl_string& esn, const hidl_string& meid)
+    BENCH_RESPONSE(exitEmergencyCallbackModeResponse)
+    BENCH_RESPONSE(getSmscAddressResponse, const hidl_string& smsc)
+    BENCH_RESPONSE(setSmscAddressResponse)
+    BENCH_RESPONSE(reportSmsMemoryStatusResponse)
+    BENCH_RESPONSE(reportStkServiceIsRunningResponse)
+    BENCH_RESPONSE(getCdmaSubscriptionSourceResponse, CdmaSubscriptionSource source)
+    BENCH_RESPONSE(requestIsimAuthenticationResponse, const hidl_string& response)
+    BENCH_RESPONSE(acknowledgeIncomingGsmSmsWithPduResponse)
+    BENCH_RESPONSE(sendEnvelopeWithStatusResponse, const IccIoResult& iccIo)
+    BENCH_RESPONSE(getVoiceRadioTechnologyResponse, RadioTechnology rat)
+    BENCH_RESPONSE(getCellInfoListResponse, const hidl_vec<CellInfo>& cellInfo)
+    BENCH_RESPONSE(setCellInfoListRateResponse)
+    BENCH_RESPONSE(setInitialAttachApnResponse)
+    BENCH_RESPONSE(getImsRegistrationStateResponse, bool isRegistered,
+            RadioTechnologyFamily ratFamily)
+    BENCH_RESPONSE(sendImsSmsResponse, const SendSmsResult& sms)
+    BENCH_RESPONSE(iccTransmitApduBasicChannelResponse, const IccIoResult& result)
+    BENCH_RESPONSE(iccOpenLogicalChannelResponse, int32_t channelId,
+            const hidl_vec<int8_t>& selectResponse)
+    BENCH_RESPONSE(iccCloseLogicalChannelResponse)
+    BENCH_RESPONSE(iccTransmitApduLogicalChannelResponse, const IccIoResult& result)
+    BENCH_RESPONSE(nvReadItemResponse, const hidl_string& result)
+    BENCH_RESPONSE(nvWriteItemResponse)
+    BENCH_RESPONSE(nvWriteCdmaPrlResponse)
+    BENCH_RESPONSE(nvResetConfigResponse)
+    BENCH_RESPONSE(setUiccSubscriptionResponse)
+    BENCH_RESPONSE(setDataAllowedResponse)
+    BENCH_RESPONSE(getHardwareConfigResponse, const hidl_vec<HardwareConfig>& config)
+    BENCH_RESPONSE(requestIccSimAuthenticationResponse, const IccIoResult& result)
+    BENCH_RESPONSE(setDataProfileResponse)
+    BENCH_RESPONSE(requestShutdownResponse)
+    BENCH_RESPONSE(getRadioCapabilityResponse, const RadioCapability& rc)
+    BENCH_RESPONSE(setRadioCapabilityResponse, const RadioCapability& rc)
+    BENCH_RESPONSE(startLceServiceResponse, const LceStatusInfo& statusInfo)
+    BENCH_RESPONSE(stopLceServiceResponse, const LceStatusInfo& statusInfo)
+    BENCH_RESPONSE(pullLceDataResponse, const LceDataInfo& lceInfo)
+    BENCH_RESPONSE(getModemActivityInfoResponse, const ActivityStatsInfo& activityInfo)
+    BENCH_RESPONSE(setAllowedCarriersResponse, int32_t numAllowed)
+    BENCH_RESPONSE(getAllowedCarriersResponse, bool allAllowed,
+            const CarrierRestrictions& carriers)
+    BENCH_RESPONSE(sendDeviceStateResponse)
+    BENCH_RESPONSE(setIndicationFilterResponse)
+    BENCH_RESPONSE(setSimCardPowerResponse)
+
+    BENCH_RESPONSE(setCarrierInfoForImsiEncryptionResponse)
+    BENCH_RESPONSE(setSimCardPowerResponse_1_1)
+    BENCH_RESPONSE(startNetworkScanResponse)
+    BENCH_RESPONSE(stopNetworkScanResponse)
+    BENCH_RESPONSE(startKeepaliveResponse, const V1_1::KeepaliveStatus& status)
+    BENCH_RESPONSE(stopKeepaliveResponse)
+};
+
+struct BenchRadioIndication : public V1_1::IRadioIndication {
+    BENCH_INDICATION(radioStateChanged, RIL_UNSOL_RESPONSE_RADIO_STATE_CHANGED,
+            RadioState radioState)
+    BENCH_INDICATION(callStateChanged, RIL_UNSOL_RESPONSE_CALL_STATE_CHANGED)
+    BENCH_INDICATION(networkStateChanged, RIL_UNSOL_RESPONSE_VOICE_NETWORK_STATE_CHANGED)
+    BENCH_INDICATION(newSms, RIL_UNSOL_RESPONSE_NEW_SMS, const hidl_vec<uint8_t>& pdu)
+    BENCH_INDICATION(newSmsStatusReport, RIL_UNSOL_RESPONSE_NEW_SMS_STATUS_REPORT,
+            const hidl_vec<uint8_t>& pdu)
+    BENCH_INDICATION(newSmsOnSim, RIL_UNSOL_RESPONSE_NEW_SMS_ON_SIM, int32_t recordNumber)
+    BENCH_INDICATION(onUssd, RIL_UNSOL_ON_USSD, UssdModeType modeType, const hidl_string& msg)
+    BENCH_INDICATION(nitzTimeReceived, RIL_UNSOL_NITZ_TIME_RECEIVED, const hidl_string& nitzTime,
+            uint64_t receivedTime)
+    BENCH_INDICATION(currentSignalStrength, RIL_UNSOL_SIGNAL_STRENGTH,
+            const SignalStrength& signalStrength)
+    BENCH_INDICATION(dataCallListChanged, RIL_UNSOL_DATA_CALL_LIST_CHANGED,
+            const hidl_vec<SetupDataCallResult>& dcList)
+    BENCH_INDICATION(suppSvcNotify, RIL_UNSOL_SUPP_SVC_NOTIFICATION,
+            const SuppSvcNotification& suppSvc)
+    BENCH_INDICATION(stkSessionEnd, RIL_UNSOL_STK_SESSION_END)
+    BENCH_INDICATION(stkProactiveCommand, RIL_UNSOL_STK_PROACTIVE_COMMAND,
+            const hidl_string& cmd)
+    BENCH_INDICATION(stkEventNotify, RIL_UNSOL_STK_EVENT_NOTIFY, const hidl_string& cmd)
+    BENCH_INDICATION(stkCallSetup, RIL_UNSOL_STK_CALL_SETUP, int64_t timeout)
+    BENCH_INDICATION(simSmsStorageFull, RIL_UNSOL_SIM_SMS_STORAGE_FULL)
+    BENCH_INDICATION(simRefresh, RIL_UNSOL_SIM_REFRESH, const SimRefreshResult& refreshResult)
+    BENCH_INDICATION(callRing, RIL_UNSOL_CALL_RING, bool isGsm,
+            const CdmaSignalInfoRecord& record)
+    BENCH_INDICATION(simStatusChanged, RIL_UNSOL_RESPONSE_SIM_STATUS_CHANGED)
+    BENCH_INDICATION(cdmaNewSms, RIL_UNSOL_RESPONSE_CDMA_NEW_SMS, const CdmaSmsMessage& msg)
+    BENCH_INDICATION(newBroadcastSms, RIL_UNSOL_RESPONSE_NEW_BROADCAST_SMS,
+            const hidl_vec<uint8_t>& data)
+    BENCH_INDICATION(cdmaRuimSmsStorageFull, RIL_UNSOL_CDMA_RUIM_SMS_STORAGE_FULL)
+    BENCH_INDICATION(restrictedStateChanged, RIL_UNSOL_RESTRICTED_STATE_CHANGED,
+            PhoneRestrictedState state)
+    BENCH_INDICATION(enterEmergencyCallbackMode, RIL_UNSOL_ENTER_EMERGENCY_CALLBACK_MODE)
+    BENCH_INDICATION(cdmaCallWaiting, RIL_UNSOL_CDMA_CALL_WAITING,
+            const CdmaCallWaiting& callWaitingRecord)
+    BENCH_INDICATION(cdmaOtaProvisionStatus, RIL_UNSOL_CDMA_OTA_PROVISION_STATUS,
+            CdmaOtaProvisionStatus status)
+    BENCH_INDICATION(cdmaInfoRec, RIL_UNSOL_CDMA_INFO_REC, const CdmaInformationRecords& records)
+    BENCH_INDICATION(indicateRingbackTone, RIL_UNSOL_RINGBACK_TONE, bool start)
+    BENCH_INDICATION(resendIncallMute, RIL_UNSOL_RESEND_INCALL_MUTE)
+    BENCH_INDICATION(cdmaSubscriptionSourceChanged, RIL_UNSOL_CDMA_SUBSCRIPTION_SOURCE_CHANGED,
+            CdmaSubscriptionSource cdmaSource)
+    BENCH_INDICATION(cdmaPrlChanged, RIL_UNSOL_CDMA_PRL_CHANGED, int32_t version)
+    BENCH_INDICATION(exitEmergencyCallbackMode, RIL_UNSOL_EXIT_EMERGENCY_CALLBACK_MODE)
+    BENCH_INDICATION(rilConnected, RIL_UNSOL_RIL_CONNECTED)
+    BENCH_INDICATION(voiceRadioTechChanged, RIL_UNSOL_VOICE_RADIO_TECH_CHANGED,
+            RadioTechnology rat)
+    BENCH_INDICATION(cellInfoList, RIL_UNSOL_CELL_INFO_LIST, const hidl_vec<CellInfo>& records)
+    BENCH_INDICATION(imsNetworkStateChanged, RIL_UNSOL_RESPONSE_IMS_NETWORK_STATE_CHANGED)
+    BENCH_INDICATION(subscriptionStatusChanged, RIL_UNSOL_UICC_SUBSCRIPTION_STATUS_CHANGED,
+            bool activate)
+    BENCH_INDICATION(srvccStateNotify, RIL_UNSOL_SRVCC_STATE_NOTIFY, SrvccState state)
+    BENCH_INDICATION(hardwareConfigChanged, RIL_UNSOL_HARDWARE_CONFIG_CHANGED,
+            const hidl_vec<HardwareConfig>& configs)
+    BENCH_INDICATION(radioCapabilityIndication, RIL_UNSOL_RADIO_CAPABILITY,
+            const RadioCapability& rc)
+    BENCH_INDICATION(onSupplementaryServiceIndication, RIL_UNSOL_ON_SS,
+            const StkCcUnsolSsResult& ss)
+    BENCH_INDICATION(stkCallControlAlphaNotify, RIL_UNSOL_STK_CC_ALPHA_NOTIFY,
+            const hidl_string& alpha)
+    BENCH_INDICATION(lceData, RIL_UNSOL_LCEDATA_RECV, const LceDataInfo& lce)
+    BENCH_INDICATION(pcoData, RIL_UNSOL_PCO_DATA, const PcoDataInfo& pco)
+    BENCH_INDICATION(modemReset, RIL_UNSOL_MODEM_RESTART, const hidl_string& reason)
+
+    BENCH_INDICATION(carrierInfoForImsiEncryption, RIL_UNSOL_CARRIER_INFO_IMSI_ENCRYPTION)
+    BENCH_INDICATION(networkScanResult, RIL_UNSOL_NETWORK_SCAN_RESULT,
+            const V1_1::NetworkScanResult& result)
+    BENCH_INDICATION(keepaliveStatus, RIL_UNSOL_KEEPALIVE_STATUS,
+            const V1_1::KeepaliveStatus& status)
+};
+
+/*** Report ***/
+
+static long long percentile(const std::vector<long long>& samples, int pct) {
+    if (samples.empty()) {
+        return 0;
+    }
+    int index = (int) (((long long) samples.size() * pct + 99) / 100) - 1;
+    return samples[index < 0 ? 0 : index];
+}
+
+static void printRow(const char *name, std::vector<long long>& samples, int errors,
+        long long newCalls, long long elapsed) {
+    std::sort(samples.begin(), samples.end());
+
+    printf("%-10s %8zu %6d %10.1f %9lld %9lld %9lld %9lld %7.1f\n", name, samples.size(),
+            errors, elapsed > 0 ? samples.size() * 1e6 / elapsed : 0.0,
+            percentile(samples, 50), percentile(samples, 90), percentile(samples, 99),
+            samples.empty() ? 0 : samples.back(),
+            samples.empty() ? 0.0 : (double) newCalls / samples.size());
+}
+
+static void printReport(long long elapsed) {
+    long long total = 0;
+
+    printf("%-10s %8s %6s %10s %9s %9s %9s %9s %7s\n", "request", "count", "errors",
+            "ops/s", "p50 us", "p90 us", "p99 us", "max us", "new/op");
+    for (int i = 0; i < s_numRequestMix; i++) {
+        std::vector<long long> samples;
+        int errors = 0;
+        long long newCalls = 0;
+
+        for (int t = 0; t < s_numRequestThreads; t++) {
+            samples.insert(samples.end(), s_requestDrivers[t].samples[i].begin(),
+                    s_requestDrivers[t].samples[i].end());
+            errors += s_requestDrivers[t].errors[i];
+            newCalls += s_requestDrivers[t].newCalls[i];
+        }
+        total += samples.size();
+        printRow(s_requestMix[i]->name, samples, errors, newCalls, elapsed);
+    }
+    printf("\n%lld requests on %d threads in %.3f s: %.1f requests/s\n", total,
+            s_numRequestThreads, elapsed / 1e6, elapsed > 0 ? total * 1e6 / elapsed : 0.0);
+    printf("vendor requests %lld, responses %lld, stray responses %lld\n",
+            s_vendorRequests.load(), s_responses.load(), s_strayResponses.load());
+
+    if (s_numIndicationThreads == 0) {
+        return;
+    }
+
+    total = 0;
+    printf("\n%-10s %8s %6s %10s %9s %9s %9s %9s %7s\n", "indication", "posted", "",
+            "ops/s", "p50 us", "p90 us", "p99 us", "max us", "new/op");
+    for (int i = 0; i < s_numIndicationMix; i++) {
+        std::vector<long long> samples;
+        long long newCalls = 0;
+
+        for (int t = 0; t < s_numIndicationThreads; t++) {
+            samples.insert(samples.end(), s_indicationDrivers[t].samples[i].begin(),
+                    s_indicationDrivers[t].samples[i].end());
+            newCalls += s_indicationDrivers[t].newCalls[i];
+        }
+        total += samples.size();
+        printRow(s_indicationMix[i]->name, samples, 0, newCalls, elapsed);
+    }
+    printf("\n%lld indications on %d threads, %lld delivered:", total,
+            s_numIndicationThreads, s_unsolicitedResponses.load());
+    for (int i = 0; i < MAX_UNSOL_CODES; i++) {
+        long long count = s_indicationCounts[i].load();
+        if (count > 0) {
+            printf(" %d:%lld", RIL_UNSOL_RESPONSE_BASE + i, count);
+        }
+    }
+    printf("\n");
+}
+
+/*** Setup ***/
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "Usage: %s [-t threads] [-n requests] [-d delay_us] [-r mix]"
+            " [-u threads] [-m indications] [-i mix] [-s]\n", argv0);
+    fprintf(stderr, "  -t  request threads (default 4, max %d)\n", MAX_THREADS);
+    fprintf(stderr, "  -n  requests per thread (default 10000)\n");
+    fprintf(stderr, "  -d  vendor completion delay in usec; 0 completes inline (default 0)\n");
+    fprintf(stderr, "  -r  comma separated requests:");
+    for (int i = 0; i < NUM_REQUESTS; i++) {
+        fprintf(stderr, " %s", s_requests[i].name);
+    }
+    fprintf(stderr, "\n  -u  indication threads (default 0, max %d)\n", MAX_THREADS);
+    fprintf(stderr, "  -m  indications per thread (default 10000)\n");
+    fprintf(stderr, "  -i  comma separated indications:");
+    for (int i = 0; i < NUM_INDICATIONS; i++) {
+        fprintf(stderr, " %s", s_indications[i].name);
+    }
+    fprintf(stderr, "\n  -s  print libril's stats after the run\n");
+    exit(-1);
+}
+
+/* returns the number of entries parsed, or -1 on an unknown name */
+template <typename T>
+static int parseMix(char *list, const T *entries, int count, const T **mix) {
+    int num = 0;
+    char *saveptr = NULL;
+
+    for (char *name = strtok_r(list, ",", &saveptr); name != NULL;
+            name = strtok_r(NULL, ",", &saveptr)) {
+        int i;
+        for (i = 0; i < count && strcmp(name, entries[i].name) != 0; i++) {
+        }
+        if (i == count || num == count) {
+            fprintf(stderr, "unknown or repeated entry '%s'\n", name);
+            return -1;
+        }
+        mix[num++] = &entries[i];
+    }
+    return num;
+}
+
+int main(int argc, char **argv) {
+    char *requestList = NULL;
+    char *indicationList = NULL;
+    bool dumpStats = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:n:d:r:u:m:i:s")) != -1) {
+        switch (opt) {
+            case 't':
+                s_numRequestThreads = atoi(optarg);
+                break;
+            case 'n':
+                s_requestsPerThread = atoi(optarg);
+                break;
+            case 'd':
+                s_completionDelayUsec = atoll(optarg);
+                break;
+            case 'r':
+                requestList = optarg;
+                break;
+            case 'u':
+                s_numIndicationThreads = atoi(optarg);
+                break;
+            case 'm':
+                s_indicationsPerThread = atoi(optarg);
+                break;
+            case 'i':
+                indicationList = optarg;
+                break;
+            case 's':
+                dumpStats = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (s_numRequestThreads < 1 || s_numRequestThreads > MAX_THREADS
+            || s_numIndicationThreads < 0 || s_numIndicationThreads > MAX_THREADS
+            || s_requestsPerThread < 0 || s_indicationsPerThread < 0
+            || s_completionDelayUsec < 0
+            || (long long) s_requestsPerThread * s_numRequestThreads > INT32_MAX) {
+        usage(argv[0]);
+    }
+
+    if (requestList != NULL) {
+        s_numRequestMix = parseMix(requestList, s_requests, NUM_REQUESTS, s_requestMix);
+    } else {
+        for (int i = 0; i < NUM_REQUESTS; i++) {
+            s_requestMix[s_numRequestMix++] = &s_requests[i];
+        }
+    }
+    if (indicationList != NULL) {
+        s_numIndicationMix = parseMix(indicationList, s_indications, NUM_INDICATIONS,
+                s_indicationMix);
+    } else {
+        for (int i = 0; i < NUM_INDICATIONS; i++) {
+            s_indicationMix[s_numIndicationMix++] = &s_indications[i];
+        }
+    }
+    if (s_numRequestMix <= 0 || s_numIndicationMix <= 0) {
+        usage(argv[0]);
+    }
+
+    initCannedResponses();
+    s_indications[NUM_INDICATIONS - 1].data = s_newSmsPdu;
+    s_indications[NUM_INDICATIONS - 1].datalen = strlen(s_newSmsPdu);
+
+    RIL_startEventLoop();
+    RIL_register(&s_benchFunctions);
+
+    s_radio = radio::getRadioService(BENCH_SLOT);
+    if (s_radio == NULL) {
+        fprintf(stderr, "no radio service for slot %d\n", BENCH_SLOT);
+        return 1;
+    }
+    s_radio->setResponseFunctions(new BenchRadioResponse(), new BenchRadioIndication());
+
+    /* drop the indications sent on connect */
+    s_unsolicitedResponses = 0;
+    for (int i = 0; i < MAX_UNSOL_CODES; i++) {
+        s_indicationCounts[i] = 0;
+    }
+
+    for (int i = 0; i < s_numRequestThreads; i++) {
+        RequestDriver *driver = &s_requestDrivers[i];
+        driver->id = i;
+        driver->serial = -1;
+        pthread_mutex_init(&driver->mutex, NULL);
+        pthread_cond_init(&driver->cond, NULL);
+    }
+    for (int i = 0; i < s_numIndicationThreads; i++) {
+        s_indicationDrivers[i].id = i;
+    }
+
+    long long start = nowUsec();
+
+    for (int i = 0; i < s_numRequestThreads; i++) {
+        if (pthread_create(&s_requestDrivers[i].tid, NULL, requestLoop,
+                &s_requestDrivers[i]) != 0) {
+            fprintf(stderr, "pthread_create failed\n");
+            return 1;
+        }
+    }
+    for (int i = 0; i < s_numIndicationThreads; i++) {
+        if (pthread_create(&s_indicationDrivers[i].tid, NULL, indicationLoop,
+                &s_indicationDrivers[i]) != 0) {
+            fprintf(stderr, "pthread_create failed\n");
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < s_numRequestThreads; i++) {
+        pthread_join(s_requestDrivers[i].tid, NULL);
+    }
+    for (int i = 0; i < s_numIndicationThreads; i++) {
+        pthread_join(s_indicationDrivers[i].tid, NULL);
+    }
+
+    printReport(nowUsec() - start);
+    if (dumpStats) {
+        fflush(stdout);
+        android::statsDump(STDOUT_FILENO);
+    }
+    return 0;
+}
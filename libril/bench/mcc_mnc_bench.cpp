@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Microbenchmark for the MCC / MNC decoders in ril_mcc.h and ril_mnc.h
+ *
+ * Decodes one MCC and one MNC per cell, the way the cell identity converters
+ * do, over every MCC and every 2 digit, 3 digit and legacy MNC encoding:
+ *
+ *   snprintf   the old snprintf() into a std::string path, kept here verbatim
+ *   decode     the std::string decode() accessors, now backed by the tables
+ *   decodeStr  the non-allocating decodeStr() accessors
+ *
+ * The "new/op" column counts operator new calls per cell. Short strings fit
+ * in std::string's inline buffer, so the cost of the std::string paths is
+ * mostly the formatting and the copies.
+ *
+ *   ril-mcc-mnc-bench -n 20
+ */
+
+#include <telephony/ril_mcc.h>
+#include <telephony/ril_mnc.h>
+
+#include <new>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NUM_MNCS    3000
+
+static long long nowNsec() {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*** Allocation counting ***/
+
+static long long s_newCalls = 0;
+
+void *operator new(size_t size) {
+    s_newCalls++;
+    void *p = malloc(size > 0 ? size : 1);
+    if (p == NULL) {
+        abort();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t size) noexcept {
+    free(p);
+}
+
+/*** The snprintf decoders as they were ***/
+
+static std::string legacyDecodeMcc(int mcc) {
+    char mccStr[4] = {0};
+    if (mcc > 999 || mcc < 0) return "";
+
+    snprintf(mccStr, sizeof(mccStr), "%03d", mcc);
+    return mccStr;
+}
+
+static std::string legacyDecodeMnc(int mnc) {
+    if (mnc == INT_MAX || mnc < 0) return "";
+    unsigned umnc = mnc;
+    char mncNumDigits = (umnc >> (sizeof(int) * 8 - 4)) & 0xF;
+
+    umnc = (umnc << 4) >> 4;
+    if (umnc > 999) return "";
+
+    char mncStr[4] = {0};
+    switch (mncNumDigits) {
+        case 0:
+            return std::to_string(umnc);
+
+        case 2:
+            snprintf(mncStr, sizeof(mncStr), "%03.3u", umnc);
+            return mncStr + 1;
+
+        case 3:
+            snprintf(mncStr, sizeof(mncStr), "%03.3u", umnc);
+            return mncStr;
+
+        default:
+            return "";
+    }
+}
+
+/*** Cases ***/
+
+static int s_mnc[NUM_MNCS];
+
+/* the checksum keeps the compiler from dropping the decodes */
+static unsigned s_checksum = 0;
+
+static void runSnprintf(int cell) {
+    std::string mcc = legacyDecodeMcc(cell % 1000);
+    std::string mnc = legacyDecodeMnc(s_mnc[cell]);
+    s_checksum += mcc[0] + mnc.size();
+}
+
+static void runDecode(int cell) {
+    std::string mcc = ril::util::mcc::decode(cell % 1000);
+    std::string mnc = ril::util::mnc::decode(s_mnc[cell]);
+    s_checksum += mcc[0] + mnc.size();
+}
+
+static void runDecodeStr(int cell) {
+    const char *mcc = ril::util::mcc::decodeStr(cell % 1000);
+    const char *mnc = ril::util::mnc::decodeStr(s_mnc[cell]);
+    s_checksum += mcc[0] + strlen(mnc);
+}
+
+typedef struct {
+    const char *name;
+    void (*run)(int cell);
+} BenchCase;
+
+static const BenchCase s_cases[] = {
+    { "snprintf", runSnprintf },
+    { "decode", runDecode },
+    { "decodeStr", runDecodeStr },
+};
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [-n <passes over %d cells>]\n", argv0, NUM_MNCS);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    int passes = 100;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+            case 'n':
+                passes = atoi(optarg);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (passes < 1) {
+        usage(argv[0]);
+    }
+
+    for (int i = 0; i < 1000; i++) {
+        s_mnc[i] = ril::util::mnc::encode(i, 2);
+        s_mnc[1000 + i] = ril::util::mnc::encode(i, 3);
+        s_mnc[2000 + i] = i;
+    }
+
+    for (int cell = 0; cell < NUM_MNCS; cell++) {
+        if (legacyDecodeMcc(cell % 1000) != ril::util::mcc::decodeStr(cell % 1000)
+                || legacyDecodeMnc(s_mnc[cell]) != ril::util::mnc::decodeStr(s_mnc[cell])) {
+            fprintf(stderr, "mismatch at cell %d\n", cell);
+            return 1;
+        }
+    }
+
+    printf("%-10s %12s %10s %8s\n", "case", "cells", "ns/cell", "new/op");
+    for (const BenchCase& c : s_cases) {
+        long long cells = (long long) passes * NUM_MNCS;
+        long long newCalls = s_newCalls;
+        long long start = nowNsec();
+
+        for (int pass = 0; pass < passes; pass++) {
+            for (int cell = 0; cell < NUM_MNCS; cell++) {
+                c.run(cell);
+            }
+        }
+
+        long long elapsed = nowNsec() - start;
+        printf("%-10s %12lld %10.1f %8.2f\n", c.name, cells, (double) elapsed / cells,
+                (double) (s_newCalls - newCalls) / cells);
+    }
+    printf("checksum %u\n", s_checksum);
+
+    return 0;
+}
@@ -25,6 +25,7 @@
 #include <utils/Log.h>
 #include <utils/SystemClock.h>
 #include <pthread.h>
+#include <atomic>
 #include <sys/types.h>
 #include <sys/limits.h>
 #include <sys/system_properties.h>
@@ -40,11 +41,15 @@
 #include <assert.h>
 #include <ctype.h>
 #include <sys/un.h>
+#include <sys/eventfd.h>
 #include <assert.h>
 #include <netinet/in.h>
 #include <cutils/properties.h>
+#include <telephony/librilutils.h>
 #include <RilSapSocket.h>
+#include <rilObjectPool.h>
 #include <ril_service.h>
+#include <ril_stats.h>
 #include <sap_service.h>
 
 extern "C" void
@@ -58,12 +63,18 @@ namespace android {
 #define BLUETOOTH_PROCESS "bluetooth"
 
 #define ANDROID_WAKE_LOCK_NAME "radio-interface"
+#define UNSOL_COALESCE_WAKE_LOCK_NAME "radio-unsol-coalesce"
 
 #define ANDROID_WAKE_LOCK_SECS 0
 #define ANDROID_WAKE_LOCK_USECS 200000
 
 #define PROPERTY_RIL_IMPL "gsm.version.ril-impl"
 
+// Run one event loop per SIM slot instead of a single shared one
+#define PROPERTY_EVENT_LOOP_PER_SLOT "ro.vendor.ril.event_loop_per_slot"
+// Comma separated "<unsol code>:<window ms>" pairs, e.g. "1009:1000,1036:2000"
+#define PROPERTY_UNSOL_COALESCE "ro.vendor.ril.unsol_coalesce"
+
 // match with constant in RIL.java
 #define MAX_COMMAND_BYTES (8 * 1024)
 
@@ -111,34 +122,78 @@ char ril_service_name[MAX_SERVICE_NAME_LENGTH] = RIL1_SERVICE_NAME;
 RIL_RadioFunctions s_callbacks = {0, NULL, NULL, NULL, NULL, NULL};
 static int s_registerCalled = 0;
 
-static pthread_t s_tid_dispatch;
+typedef struct {
+    RIL_SOCKET_ID socket_id;
+    pthread_t tid;
+    int fdWakeup;                           // eventfd
+    std::atomic<bool> wakeupPending;        // set from the first trigger until the loop wakes
+    std::atomic<uint64_t> wakeupsIssued;    // triggers that wrote to fdWakeup
+    std::atomic<uint64_t> wakeupsCoalesced; // triggers absorbed by a pending wakeup
+    struct ril_event wakeupfd_event;
+    struct ril_event_base *base;
+    bool running;                           // came up; set before s_started counts it
+} EventLoopInfo;
+
+static EventLoopInfo s_eventLoops[SIM_COUNT];
+static int s_eventLoopCount = 1;
 static int s_started = 0;
 
-static int s_fdWakeupRead;
-static int s_fdWakeupWrite;
+// Slot on whose behalf the current thread is running; picks the event loop
+// for RIL_requestTimedCallback()
+static thread_local RIL_SOCKET_ID s_callingSocketId = RIL_SOCKET_1;
 
 int s_wakelock_count = 0;
 
-static struct ril_event s_wakeupfd_event;
-
-static pthread_mutex_t s_pendingRequestsMutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t s_wakeLockCountMutex = PTHREAD_MUTEX_INITIALIZER;
-static RequestInfo *s_pendingRequests = NULL;
 
+/**
+ * Outstanding requests of one slot, as an open addressing hash set of
+ * RequestInfo pointers keyed by generation (linear probing, NULL marks an
+ * empty bucket). Looking up and retiring a RIL_Token is O(1) on average.
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    RequestInfo **buckets;
+    size_t capacity;    // always 0 or a power of two
+    size_t count;
+    uint32_t lastGeneration;
+} PendingRequestShard;
+
+#define PENDING_REQUEST_SHARD_INITIALIZER {PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, 0}
+
+/**
+ * A RIL_Token is not a RequestInfo pointer: pooled RequestInfos are reused at
+ * once, so a late or duplicate completion would hit whichever request got the
+ * slot next. It carries the slot + 1 in the low bits and the request's
+ * generation above them, so it is never NULL and is validated without
+ * touching the RequestInfo.
+ */
+#define REQUEST_TOKEN_SLOT_BITS 3
+#define REQUEST_GENERATION_MASK 0x1FFFFFFFU
+
+// Initial bucket count of a shard; it doubles whenever it gets half full
+#define PENDING_REQUESTS_MIN_CAPACITY 32
+
+static PendingRequestShard s_pendingRequests[SIM_COUNT] = {
+    PENDING_REQUEST_SHARD_INITIALIZER,
 #if (SIM_COUNT >= 2)
-static pthread_mutex_t s_pendingRequestsMutex_socket2  = PTHREAD_MUTEX_INITIALIZER;
-static RequestInfo *s_pendingRequests_socket2          = NULL;
+    PENDING_REQUEST_SHARD_INITIALIZER,
 #endif
-
 #if (SIM_COUNT >= 3)
-static pthread_mutex_t s_pendingRequestsMutex_socket3  = PTHREAD_MUTEX_INITIALIZER;
-static RequestInfo *s_pendingRequests_socket3          = NULL;
+    PENDING_REQUEST_SHARD_INITIALIZER,
 #endif
-
 #if (SIM_COUNT >= 4)
-static pthread_mutex_t s_pendingRequestsMutex_socket4  = PTHREAD_MUTEX_INITIALIZER;
-static RequestInfo *s_pendingRequests_socket4          = NULL;
+    PENDING_REQUEST_SHARD_INITIALIZER,
 #endif
+};
+
+// Slab sizes for the RequestInfo and UserCallbackInfo pools. Allocations past
+// these still succeed from the heap; see getRequestInfoPoolStats() for sizing.
+#define REQUEST_INFO_POOL_SIZE 256
+#define USER_CALLBACK_INFO_POOL_SIZE 128
+
+static Ril_pool<RequestInfo, REQUEST_INFO_POOL_SIZE> s_requestInfoPool;
+static Ril_pool<UserCallbackInfo, USER_CALLBACK_INFO_POOL_SIZE> s_userCallbackInfoPool;
 
 static const struct timeval TIMEVAL_WAKE_TIMEOUT = {ANDROID_WAKE_LOCK_SECS,ANDROID_WAKE_LOCK_USECS};
 
@@ -151,12 +206,18 @@ static UserCallbackInfo *s_last_wake_timeout_info = NULL;
 static void *s_lastNITZTimeData = NULL;
 static size_t s_lastNITZTimeDataSize;
 
+// Held across setNitzTimeReceived() and the NITZ indication that reads it
+static pthread_mutex_t s_nitzMutex = PTHREAD_MUTEX_INITIALIZER;
+
 #if RILC_LOG
     static char printBuf[PRINTBUF_SIZE];
 #endif
 
 /*******************************************************************/
 static void grabPartialWakeLock();
+static void dispatchUnsolResponse(int unsolResponseIndex, const void *data, size_t datalen,
+        RIL_SOCKET_ID soc_id);
+static void initUnsolCoalescing();
 void releaseWakeLock();
 static void wakeTimeoutCallback(void *);
 
@@ -179,6 +240,9 @@ extern "C" void RIL_onUnsolicitedResponse(int unsolResponse, const void *data,
 static UserCallbackInfo * internalRequestTimedCallback
     (RIL_TimedCallback callback, void *param,
         const struct timeval *relativeTime);
+static UserCallbackInfo * internalRequestTimedCallbackOnLoop
+    (EventLoopInfo *loop, RIL_TimedCallback callback, void *param,
+        const struct timeval *relativeTime);
 
 /** Index == requestNumber */
 static CommandInfo s_commands[] = {
@@ -193,37 +257,142 @@ char * RIL_getServiceName() {
     return ril_service_name;
 }
 
+void getRequestInfoPoolStats(Ril_pool_stats *stats) {
+    s_requestInfoPool.getStats(stats);
+}
+
+void getUserCallbackInfoPoolStats(Ril_pool_stats *stats) {
+    s_userCallbackInfoPool.getStats(stats);
+}
+
+static PendingRequestShard *
+getPendingRequestShard(RIL_SOCKET_ID socket_id) {
+    if ((int) socket_id < 0 || (int) socket_id >= SIM_COUNT) {
+        return NULL;
+    }
+    return &s_pendingRequests[socket_id];
+}
+
+// The multiply wraps by design; keep the integer sanitizer from trapping on it
+__attribute__((no_sanitize("integer")))
+static size_t
+pendingRequestHash(uint32_t generation, size_t capacity) {
+    // Fibonacci hashing spreads the consecutive generations over the table
+    uint64_t h = (uint64_t) generation * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h >> 32) & (capacity - 1);
+}
+
+/** Returns the bucket holding generation, or -1. Must hold shard->mutex */
+static ssize_t
+findPendingRequest(PendingRequestShard *shard, uint32_t generation) {
+    if (shard->count == 0) {
+        return -1;
+    }
+    size_t mask = shard->capacity - 1;
+    for (size_t i = pendingRequestHash(generation, shard->capacity); ; i = (i + 1) & mask) {
+        if (shard->buckets[i] != NULL && shard->buckets[i]->generation == generation) {
+            return (ssize_t) i;
+        }
+        if (shard->buckets[i] == NULL) {
+            return -1;
+        }
+    }
+}
+
+/** Must hold shard->mutex, and the shard must have a free bucket */
+static void
+insertPendingRequest(PendingRequestShard *shard, RequestInfo *pRI) {
+    size_t mask = shard->capacity - 1;
+    size_t i = pendingRequestHash(pRI->generation, shard->capacity);
+    while (shard->buckets[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    shard->buckets[i] = pRI;
+    shard->count++;
+}
+
+/** Must hold shard->mutex */
+static void
+removePendingRequestAt(PendingRequestShard *shard, size_t hole) {
+    // Backward shift deletion keeps every probe chain intact without tombstones
+    size_t mask = shard->capacity - 1;
+    size_t i = hole;
+    for (;;) {
+        i = (i + 1) & mask;
+        RequestInfo *pRI = shard->buckets[i];
+        if (pRI == NULL) {
+            break;
+        }
+        size_t home = pendingRequestHash(pRI->generation, shard->capacity);
+        // Move it into the hole unless its home bucket lies cyclically in (hole, i]
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            shard->buckets[hole] = pRI;
+            hole = i;
+        }
+    }
+    shard->buckets[hole] = NULL;
+    shard->count--;
+}
+
+/** Must hold shard->mutex */
+static int
+growPendingRequests(PendingRequestShard *shard) {
+    size_t capacity = (shard->capacity > 0)
+            ? shard->capacity * 2 : PENDING_REQUESTS_MIN_CAPACITY;
+    RequestInfo **old = shard->buckets;
+    size_t oldCapacity = shard->capacity;
+
+    RequestInfo **buckets = (RequestInfo **) calloc(capacity, sizeof(RequestInfo *));
+    if (buckets == NULL) {
+        return -1;
+    }
+
+    shard->buckets = buckets;
+    shard->capacity = capacity;
+    shard->count = 0;
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (old[i] != NULL) {
+            insertPendingRequest(shard, old[i]);
+        }
+    }
+    free(old);
+    return 0;
+}
+
+/**
+ * Next generation for shard, skipping 0 and any still pending after the
+ * counter wrapped. Must hold shard->mutex
+ */
+static uint32_t
+nextRequestGeneration(PendingRequestShard *shard) {
+    uint32_t generation = shard->lastGeneration;
+    do {
+        generation = (generation + 1) & REQUEST_GENERATION_MASK;
+    } while (generation == 0 || findPendingRequest(shard, generation) >= 0);
+    shard->lastGeneration = generation;
+    return generation;
+}
+
+RIL_Token
+getRequestToken(const RequestInfo *pRI) {
+    return (RIL_Token) (((uintptr_t) pRI->generation << REQUEST_TOKEN_SLOT_BITS)
+            | ((uintptr_t) pRI->socket_id + 1));
+}
+
 RequestInfo *
 addRequestToList(int serial, int slotId, int request) {
     RequestInfo *pRI;
     int ret;
     RIL_SOCKET_ID socket_id = (RIL_SOCKET_ID) slotId;
-    /* Hook for current context */
-    /* pendingRequestsMutextHook refer to &s_pendingRequestsMutex */
-    pthread_mutex_t* pendingRequestsMutexHook = &s_pendingRequestsMutex;
-    /* pendingRequestsHook refer to &s_pendingRequests */
-    RequestInfo**    pendingRequestsHook = &s_pendingRequests;
+    PendingRequestShard *shard = getPendingRequestShard(socket_id);
 
-#if (SIM_COUNT >= 2)
-    if (socket_id == RIL_SOCKET_2) {
-        pendingRequestsMutexHook = &s_pendingRequestsMutex_socket2;
-        pendingRequestsHook = &s_pendingRequests_socket2;
-    }
-#if (SIM_COUNT >= 3)
-    else if (socket_id == RIL_SOCKET_3) {
-        pendingRequestsMutexHook = &s_pendingRequestsMutex_socket3;
-        pendingRequestsHook = &s_pendingRequests_socket3;
-    }
-#endif
-#if (SIM_COUNT >= 4)
-    else if (socket_id == RIL_SOCKET_4) {
-        pendingRequestsMutexHook = &s_pendingRequestsMutex_socket4;
-        pendingRequestsHook = &s_pendingRequests_socket4;
+    if (shard == NULL) {
+        RLOGE("addRequestToList: invalid slot %d for request %s", slotId,
+                requestToString(request));
+        return NULL;
     }
-#endif
-#endif
 
-    pRI = (RequestInfo *)calloc(1, sizeof(RequestInfo));
+    pRI = s_requestInfoPool.alloc();
     if (pRI == NULL) {
         RLOGE("Memory allocation failed for request %s", requestToString(request));
         return NULL;
@@ -232,50 +401,95 @@ addRequestToList(int serial, int slotId, int request) {
     pRI->token = serial;
     pRI->pCI = &(s_commands[request]);
     pRI->socket_id = socket_id;
+    pRI->dispatchTime = ril_nano_time();
 
-    ret = pthread_mutex_lock(pendingRequestsMutexHook);
+    ret = pthread_mutex_lock(&shard->mutex);
     assert (ret == 0);
 
-    pRI->p_next = *pendingRequestsHook;
-    *pendingRequestsHook = pRI;
+    if ((shard->count + 1) * 2 > shard->capacity && growPendingRequests(shard) < 0) {
+        ret = pthread_mutex_unlock(&shard->mutex);
+        assert (ret == 0);
 
-    ret = pthread_mutex_unlock(pendingRequestsMutexHook);
+        RLOGE("Memory allocation failed for pending request %s", requestToString(request));
+        s_requestInfoPool.release(pRI);
+        return NULL;
+    }
+    pRI->generation = nextRequestGeneration(shard);
+    insertPendingRequest(shard, pRI);
+
+    ret = pthread_mutex_unlock(&shard->mutex);
     assert (ret == 0);
 
     return pRI;
 }
 
-static void triggerEvLoop() {
+void setCallingSocketId(RIL_SOCKET_ID socket_id) {
+    s_callingSocketId = socket_id;
+}
+
+static EventLoopInfo *getEventLoop(RIL_SOCKET_ID socket_id) {
+    if ((int) socket_id < 0 || (int) socket_id >= s_eventLoopCount
+            || !s_eventLoops[socket_id].running) {
+        return &s_eventLoops[0];
+    }
+    return &s_eventLoops[socket_id];
+}
+
+void getEventLoopWakeupStats(RIL_SOCKET_ID socket_id, uint64_t *issued,
+        uint64_t *coalesced) {
+    EventLoopInfo *loop = getEventLoop(socket_id);
+    *issued = loop->wakeupsIssued.load(std::memory_order_relaxed);
+    *coalesced = loop->wakeupsCoalesced.load(std::memory_order_relaxed);
+}
+
+static void triggerEvLoop(EventLoopInfo *loop) {
     int ret;
-    if (!pthread_equal(pthread_self(), s_tid_dispatch)) {
+    if (!pthread_equal(pthread_self(), loop->tid)) {
         /* trigger event loop to wakeup. No reason to do this,
          * if we're in the event loop thread */
-         do {
-            ret = write (s_fdWakeupWrite, " ", 1);
-         } while (ret < 0 && errno == EINTR);
+        if (loop->wakeupPending.exchange(true)) {
+            /* The loop hasn't run processWakeupCallback() since the last
+             * write, so it will look at the timers again anyway */
+            loop->wakeupsCoalesced.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        loop->wakeupsIssued.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t one = 1;
+        do {
+            ret = write (loop->fdWakeup, &one, sizeof(one));
+        } while (ret < 0 && errno == EINTR);
     }
 }
 
-static void rilEventAddWakeup(struct ril_event *ev) {
-    ril_event_add(ev);
-    triggerEvLoop();
+static void rilEventAddWakeup(EventLoopInfo *loop, struct ril_event *ev) {
+    ril_event_base_add(loop->base, ev);
+    triggerEvLoop(loop);
 }
 
 /**
- * A write on the wakeup fd is done just to pop us out of select()
- * We empty the buffer here and then ril_event will reset the timers on the
+ * A write on the wakeup fd is done just to pop us out of epoll_wait()
+ * We reset the eventfd here and then ril_event will reset the timers on the
  * way back down
  */
 static void processWakeupCallback(int fd, short flags, void *param) {
-    char buff[16];
+    EventLoopInfo *loop = (EventLoopInfo *) param;
+    uint64_t count;
     int ret;
 
     RLOGV("processWakeupCallback");
 
-    /* empty our wakeup socket out */
+    /* reset our eventfd */
     do {
-        ret = read(s_fdWakeupRead, &buff, sizeof(buff));
-    } while (ret > 0 || (ret < 0 && errno == EINTR));
+        ret = read(fd, &count, sizeof(count));
+    } while (ret < 0 && errno == EINTR);
+
+    /* Clear the flag only once drained: cleared first, a trigger landing
+     * before the read() would have its write consumed here and leave the
+     * flag set with the eventfd empty, so no later trigger would write.
+     * A trigger landing now is coalesced, which is fine since the loop
+     * looks at its timers again before it sleeps */
+    loop->wakeupPending.store(false);
 }
 
 static void resendLastNITZTimeData(RIL_SOCKET_ID socket_id) {
@@ -283,23 +497,24 @@ static void resendLastNITZTimeData(RIL_SOCKET_ID socket_id) {
         int responseType = (s_callbacks.version >= 13)
                            ? RESPONSE_UNSOLICITED_ACK_EXP
                            : RESPONSE_UNSOLICITED;
-        // acquire read lock for the service before calling nitzTimeReceivedInd() since it reads
+        // hold s_nitzMutex before calling nitzTimeReceivedInd() since it reads
         // nitzTimeReceived in ril_service
-        pthread_rwlock_t *radioServiceRwlockPtr = radio::getRadioServiceRwlock(
-                (int) socket_id);
-        int rwlockRet = pthread_rwlock_rdlock(radioServiceRwlockPtr);
-        assert(rwlockRet == 0);
-
-        int ret = radio::nitzTimeReceivedInd(
-            (int)socket_id, responseType, 0,
-            RIL_E_SUCCESS, s_lastNITZTimeData, s_lastNITZTimeDataSize);
-        if (ret == 0) {
-            free(s_lastNITZTimeData);
-            s_lastNITZTimeData = NULL;
+        int mutexRet = pthread_mutex_lock(&s_nitzMutex);
+        assert(mutexRet == 0);
+
+        {
+            radio::CallbacksReader reader((int) socket_id);
+            int ret = radio::nitzTimeReceivedInd(
+                (int)socket_id, responseType, 0,
+                RIL_E_SUCCESS, s_lastNITZTimeData, s_lastNITZTimeDataSize);
+            if (ret == 0) {
+                free(s_lastNITZTimeData);
+                s_lastNITZTimeData = NULL;
+            }
         }
 
-        rwlockRet = pthread_rwlock_unlock(radioServiceRwlockPtr);
-        assert(rwlockRet == 0);
+        mutexRet = pthread_mutex_unlock(&s_nitzMutex);
+        assert(mutexRet == 0);
     }
 }
 
@@ -339,49 +554,92 @@ static void userTimerCallback (int fd, short flags, void *param) {
 
     p_info->p_callback(p_info->userParam);
 
-
-    // FIXME generalize this...there should be a cancel mechanism
+    // Forget about it before freeing, so a concurrent cancelWakeTimeout()
+    // can't touch it any more
+    int ret = pthread_mutex_lock(&s_wakeLockCountMutex);
+    assert(ret == 0);
     if (s_last_wake_timeout_info != NULL && s_last_wake_timeout_info == p_info) {
         s_last_wake_timeout_info = NULL;
     }
+    ret = pthread_mutex_unlock(&s_wakeLockCountMutex);
+    assert(ret == 0);
 
-    free(p_info);
+    s_userCallbackInfoPool.release(p_info);
 }
 
+/**
+ * Cancel a callback scheduled with internalRequestTimedCallback().
+ *
+ * Returns true if the callback had not fired yet; it is freed and will never
+ * run. Returns false if the event loop has already picked it up, in which case
+ * it will still run and free itself.
+ */
+static bool
+cancelTimedCallback(UserCallbackInfo *p_info) {
+    if (ril_timer_del(&(p_info->event))) {
+        s_userCallbackInfoPool.release(p_info);
+        return true;
+    }
+    return false;
+}
 
-static void *
-eventLoop(void *param) {
-    int ret;
-    int filedes[2];
+/**
+ * Cancel the outstanding wake lock timeout, if any.
+ * Must be called with s_wakeLockCountMutex held.
+ */
+static void
+cancelWakeTimeout() {
+    if (s_last_wake_timeout_info != NULL) {
+        if (!cancelTimedCallback(s_last_wake_timeout_info)) {
+            // Too late to cancel: "param != NULL" turns it into a no-op
+            s_last_wake_timeout_info->userParam = (void *)1;
+        }
+        s_last_wake_timeout_info = NULL;
+    }
+}
 
-    ril_event_init();
 
+static void
+signalEventLoopStarted() {
     pthread_mutex_lock(&s_startupMutex);
 
-    s_started = 1;
+    s_started++;
     pthread_cond_broadcast(&s_startupCond);
 
     pthread_mutex_unlock(&s_startupMutex);
+}
 
-    ret = pipe(filedes);
-
-    if (ret < 0) {
-        RLOGE("Error in pipe() errno:%d", errno);
+static void *
+eventLoop(void *param) {
+    EventLoopInfo *loop = (EventLoopInfo *) param;
+    loop->tid = pthread_self();
+    s_callingSocketId = loop->socket_id;
+
+    loop->base = ril_event_base_new();
+    if (loop->base == NULL) {
+        RLOGE("Error in ril_event_base_new() errno:%d", errno);
+        signalEventLoopStarted();
         return NULL;
     }
 
-    s_fdWakeupRead = filedes[0];
-    s_fdWakeupWrite = filedes[1];
+    loop->fdWakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (loop->fdWakeup < 0) {
+        RLOGE("Error in eventfd() errno:%d", errno);
+        signalEventLoopStarted();
+        return NULL;
+    }
 
-    fcntl(s_fdWakeupRead, F_SETFL, O_NONBLOCK);
+    ril_event_set (&loop->wakeupfd_event, loop->fdWakeup, true,
+                processWakeupCallback, loop);
 
-    ril_event_set (&s_wakeupfd_event, s_fdWakeupRead, true,
-                processWakeupCallback, NULL);
+    rilEventAddWakeup (loop, &loop->wakeupfd_event);
 
-    rilEventAddWakeup (&s_wakeupfd_event);
+    loop->running = true;
+    signalEventLoopStarted();
 
     // Only returns on error
-    ril_event_loop();
+    ril_event_base_loop(loop->base);
     RLOGE ("error in event_loop_base errno:%d", errno);
     // kill self to restart on error
     kill(0, SIGKILL);
@@ -391,7 +649,17 @@ eventLoop(void *param) {
 
 extern "C" void
 RIL_startEventLoop(void) {
-    /* spin up eventLoop thread and wait for it to get started */
+    int created = 0;
+
+    s_eventLoopCount = 1;
+#if (SIM_COUNT >= 2)
+    if (property_get_bool(PROPERTY_EVENT_LOOP_PER_SLOT, false)) {
+        s_eventLoopCount = SIM_COUNT;
+    }
+#endif
+    RLOGI("Starting %d event loop(s)", s_eventLoopCount);
+
+    /* spin up eventLoop threads and wait for them to get started */
     s_started = 0;
     pthread_mutex_lock(&s_startupMutex);
 
@@ -399,16 +667,37 @@ RIL_startEventLoop(void) {
     pthread_attr_init(&attr);
     pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
 
-    int result = pthread_create(&s_tid_dispatch, &attr, eventLoop, NULL);
-    if (result != 0) {
-        RLOGE("Failed to create dispatch thread: %s", strerror(result));
-        goto done;
+    for (int i = 0; i < s_eventLoopCount; i++) {
+        EventLoopInfo *loop = &s_eventLoops[i];
+        loop->socket_id = (RIL_SOCKET_ID) i;
+
+        int result = pthread_create(&loop->tid, &attr, eventLoop, loop);
+        if (result != 0) {
+            RLOGE("Failed to create dispatch thread for %s: %s",
+                    rilSocketIdToString(loop->socket_id), strerror(result));
+            if (i == 0) {
+                goto done;
+            }
+            // fall back to the loops we managed to start
+            s_eventLoopCount = i;
+            break;
+        }
+        created++;
     }
 
-    while (s_started == 0) {
+    while (s_started < created) {
         pthread_cond_wait(&s_startupCond, &s_startupMutex);
     }
 
+    // getEventLoop() sends the slots of loops that failed to come up to loop 0
+    for (int i = 1; i < s_eventLoopCount; i++) {
+        if (!s_eventLoops[i].running) {
+            RLOGE("Event loop for %s failed to start, falling back to %s",
+                    rilSocketIdToString(s_eventLoops[i].socket_id),
+                    rilSocketIdToString(s_eventLoops[0].socket_id));
+        }
+    }
+
 done:
     pthread_mutex_unlock(&s_startupMutex);
 }
@@ -456,6 +745,9 @@ RIL_register (const RIL_RadioFunctions *callbacks) {
                 == s_unsolResponses[i].requestNumber);
     }
 
+    statsInit((int)NUM_ELEMS(s_commands), (int)NUM_ELEMS(s_unsolResponses));
+    initUnsolCoalescing();
+
     radio::registerService(&s_callbacks, s_commands);
     RLOGI("RILHIDL called registerService");
 
@@ -494,62 +786,44 @@ RIL_register_socket (const RIL_RadioFunctions *(*Init)(const struct RIL_Env *, i
     }
 }
 
-// Check and remove RequestInfo if its a response and not just ack sent back
-static int
-checkAndDequeueRequestInfoIfAck(struct RequestInfo *pRI, bool isAck) {
-    int ret = 0;
-    /* Hook for current context
-       pendingRequestsMutextHook refer to &s_pendingRequestsMutex */
-    pthread_mutex_t* pendingRequestsMutexHook = &s_pendingRequestsMutex;
-    /* pendingRequestsHook refer to &s_pendingRequests */
-    RequestInfo ** pendingRequestsHook = &s_pendingRequests;
+// Check and remove RequestInfo if its a response and not just ack sent back.
+// Returns the RequestInfo t stands for, or NULL if t is not outstanding.
+static RequestInfo *
+checkAndDequeueRequestInfoIfAck(RIL_Token t, bool isAck) {
+    RequestInfo *pRI = NULL;
+    uintptr_t handle = (uintptr_t) t;
+    uintptr_t slotBits = handle & ((1U << REQUEST_TOKEN_SLOT_BITS) - 1);
+    PendingRequestShard *shard;
 
-    if (pRI == NULL) {
-        return 0;
+    if (slotBits == 0) {
+        return NULL;
     }
 
-#if (SIM_COUNT >= 2)
-    if (pRI->socket_id == RIL_SOCKET_2) {
-        pendingRequestsMutexHook = &s_pendingRequestsMutex_socket2;
-        pendingRequestsHook = &s_pendingRequests_socket2;
-    }
-#if (SIM_COUNT >= 3)
-        if (pRI->socket_id == RIL_SOCKET_3) {
-            pendingRequestsMutexHook = &s_pendingRequestsMutex_socket3;
-            pendingRequestsHook = &s_pendingRequests_socket3;
-        }
-#endif
-#if (SIM_COUNT >= 4)
-    if (pRI->socket_id == RIL_SOCKET_4) {
-        pendingRequestsMutexHook = &s_pendingRequestsMutex_socket4;
-        pendingRequestsHook = &s_pendingRequests_socket4;
+    shard = getPendingRequestShard((RIL_SOCKET_ID) (slotBits - 1));
+    if (shard == NULL) {
+        return NULL;
     }
-#endif
-#endif
-    pthread_mutex_lock(pendingRequestsMutexHook);
-
-    for(RequestInfo **ppCur = pendingRequestsHook
-        ; *ppCur != NULL
-        ; ppCur = &((*ppCur)->p_next)
-    ) {
-        if (pRI == *ppCur) {
-            ret = 1;
-            if (isAck) { // Async ack
-                if (pRI->wasAckSent == 1) {
-                    RLOGD("Ack was already sent for %s", requestToString(pRI->pCI->requestNumber));
-                } else {
-                    pRI->wasAckSent = 1;
-                }
+
+    pthread_mutex_lock(&shard->mutex);
+
+    ssize_t bucket = findPendingRequest(shard,
+            (uint32_t) (handle >> REQUEST_TOKEN_SLOT_BITS));
+    if (bucket >= 0) {
+        pRI = shard->buckets[bucket];
+        if (isAck) { // Async ack
+            if (pRI->wasAckSent == 1) {
+                RLOGD("Ack was already sent for %s", requestToString(pRI->pCI->requestNumber));
             } else {
-                *ppCur = (*ppCur)->p_next;
+                pRI->wasAckSent = 1;
             }
-            break;
+        } else {
+            removePendingRequestAt(shard, (size_t) bucket);
         }
     }
 
-    pthread_mutex_unlock(pendingRequestsMutexHook);
+    pthread_mutex_unlock(&shard->mutex);
 
-    return ret;
+    return pRI;
 }
 
 extern "C" void
@@ -558,14 +832,14 @@ RIL_onRequestAck(RIL_Token t) {
 
     RIL_SOCKET_ID socket_id = RIL_SOCKET_1;
 
-    pRI = (RequestInfo *)t;
-
-    if (!checkAndDequeueRequestInfoIfAck(pRI, true)) {
+    pRI = checkAndDequeueRequestInfoIfAck(t, true);
+    if (pRI == NULL) {
         RLOGE ("RIL_onRequestAck: invalid RIL_Token");
         return;
     }
 
     socket_id = pRI->socket_id;
+    statsRecordRequestAck(pRI->pCI->requestNumber, ril_nano_time() - pRI->dispatchTime);
 
 #if VDBG
     RLOGD("Request Ack, %s", rilSocketIdToString(socket_id));
@@ -574,15 +848,8 @@ RIL_onRequestAck(RIL_Token t) {
     appendPrintBuf("Ack [%04d]< %s", pRI->token, requestToString(pRI->pCI->requestNumber));
 
     if (pRI->cancelled == 0) {
-        pthread_rwlock_t *radioServiceRwlockPtr = radio::getRadioServiceRwlock(
-                (int) socket_id);
-        int rwlockRet = pthread_rwlock_rdlock(radioServiceRwlockPtr);
-        assert(rwlockRet == 0);
-
+        radio::CallbacksReader reader((int) socket_id);
         radio::acknowledgeRequest((int) socket_id, pRI->token);
-
-        rwlockRet = pthread_rwlock_unlock(radioServiceRwlockPtr);
-        assert(rwlockRet == 0);
     }
 }
 extern "C" void
@@ -590,10 +857,11 @@ RIL_onRequestComplete(RIL_Token t, RIL_Errno e, void *response, size_t responsel
     RequestInfo *pRI;
     int ret;
     RIL_SOCKET_ID socket_id = RIL_SOCKET_1;
+    uint64_t completeTime = ril_nano_time();
+    uint64_t responseTime = 0;
 
-    pRI = (RequestInfo *)t;
-
-    if (!checkAndDequeueRequestInfoIfAck(pRI, false)) {
+    pRI = checkAndDequeueRequestInfoIfAck(t, false);
+    if (pRI == NULL) {
         RLOGE ("RIL_onRequestComplete: invalid RIL_Token");
         return;
     }
@@ -608,7 +876,7 @@ RIL_onRequestComplete(RIL_Token t, RIL_Errno e, void *response, size_t responsel
         // response does not go back up the command socket
         RLOGD("C[locl]< %s", requestToString(pRI->pCI->requestNumber));
 
-        free(pRI);
+        s_requestInfoPool.release(pRI);
         return;
     }
 
@@ -631,17 +899,16 @@ RIL_onRequestComplete(RIL_Token t, RIL_Errno e, void *response, size_t responsel
         RLOGE ("Calling responseFunction() for token %d", pRI->token);
 #endif
 
-        pthread_rwlock_t *radioServiceRwlockPtr = radio::getRadioServiceRwlock((int) socket_id);
-        int rwlockRet = pthread_rwlock_rdlock(radioServiceRwlockPtr);
-        assert(rwlockRet == 0);
-
-        ret = pRI->pCI->responseFunction((int) socket_id,
-                responseType, pRI->token, e, response, responselen);
-
-        rwlockRet = pthread_rwlock_unlock(radioServiceRwlockPtr);
-        assert(rwlockRet == 0);
+        {
+            radio::CallbacksReader reader((int) socket_id);
+            ret = pRI->pCI->responseFunction((int) socket_id,
+                    responseType, pRI->token, e, response, responselen);
+        }
+        responseTime = ril_nano_time() - completeTime;
     }
-    free(pRI);
+    statsRecordRequestComplete(pRI->pCI->requestNumber, completeTime - pRI->dispatchTime,
+            responseTime);
+    s_requestInfoPool.release(pRI);
 }
 
 static void
@@ -658,9 +925,7 @@ grabPartialWakeLock() {
             release_wake_lock(ANDROID_WAKE_LOCK_NAME);
         } else {
             s_wakelock_count++;
-            if (s_last_wake_timeout_info != NULL) {
-                s_last_wake_timeout_info->userParam = (void *)1;
-            }
+            cancelWakeTimeout();
             s_last_wake_timeout_info = p_info;
         }
         ret = pthread_mutex_unlock(&s_wakeLockCountMutex);
@@ -682,9 +947,7 @@ releaseWakeLock() {
         } else {
             s_wakelock_count = 0;
             release_wake_lock(ANDROID_WAKE_LOCK_NAME);
-            if (s_last_wake_timeout_info != NULL) {
-                s_last_wake_timeout_info->userParam = (void *)1;
-            }
+            cancelWakeTimeout();
         }
 
         ret = pthread_mutex_unlock(&s_wakeLockCountMutex);
@@ -717,6 +980,301 @@ wakeTimeoutCallback (void *param) {
     }
 }
 
+/**
+ * Coalescing of state-style unsolicited responses, configured per indication
+ * through PROPERTY_UNSOL_COALESCE. The first indication after a quiet period
+ * is delivered right away and opens a window; indications arriving while the
+ * window is open only replace the held payload. When the window expires the
+ * held payload, if any, is delivered and a new window starts, otherwise the
+ * window closes. Only the latest state inside a window reaches the framework,
+ * and the final one always does. Held WAKE_PARTIAL indications keep
+ * UNSOL_COALESCE_WAKE_LOCK_NAME until they go out, so the device can't
+ * suspend with one still inside its window.
+ */
+typedef void *(*UnsolPayloadCopy)(const void *data, size_t datalen);
+
+typedef struct {
+    RIL_SOCKET_ID socket_id;
+    int unsolResponseIndex;
+    bool windowOpen;
+    bool delivering;    // a payload is being dispatched outside s_unsolCoalesceMutex
+    bool hasPending;
+    void *pending;      // latest held payload; a single malloc'ed block
+    size_t pendingLen;
+} UnsolCoalesceState;
+
+static void *copyFlatPayload(const void *data, size_t datalen);
+static void *copyDataCallList(const void *data, size_t datalen);
+
+// Indications that may be coalesced: each one carries the full current state,
+// so dropping all but the latest loses nothing
+static const struct {
+    int unsolResponse;
+    UnsolPayloadCopy copy;
+} s_coalescibleUnsolResponses[] = {
+    {RIL_UNSOL_RESPONSE_VOICE_NETWORK_STATE_CHANGED, copyFlatPayload},
+    {RIL_UNSOL_SIGNAL_STRENGTH, copyFlatPayload},
+    {RIL_UNSOL_DATA_CALL_LIST_CHANGED, copyDataCallList},
+    {RIL_UNSOL_CELL_INFO_LIST, copyFlatPayload},
+    {RIL_UNSOL_RESPONSE_IMS_NETWORK_STATE_CHANGED, copyFlatPayload},
+};
+
+static pthread_mutex_t s_unsolCoalesceMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Set up once by RIL_register; a zero window means no coalescing
+static int s_unsolCoalesceWindowMs[NUM_ELEMS(s_unsolResponses)];
+static UnsolPayloadCopy s_unsolCoalesceCopy[NUM_ELEMS(s_unsolResponses)];
+static UnsolCoalesceState s_unsolCoalesceState[SIM_COUNT][NUM_ELEMS(s_unsolResponses)];
+// Held WAKE_PARTIAL payloads; guarded by s_unsolCoalesceMutex
+static int s_unsolCoalesceWakeLockCount = 0;
+
+static void *
+copyFlatPayload(const void *data, size_t datalen) {
+    void *copy = malloc(datalen > 0 ? datalen : 1);
+    if (copy != NULL) {
+        memcpy(copy, data, datalen);
+    }
+    return copy;
+}
+
+static size_t
+packedStringSize(const char *s) {
+    return (s == NULL) ? 0 : strlen(s) + 1;
+}
+
+static char *
+packString(char **buf, const char *s) {
+    if (s == NULL) {
+        return NULL;
+    }
+    size_t len = strlen(s) + 1;
+    char *copy = *buf;
+    memcpy(copy, s, len);
+    *buf += len;
+    return copy;
+}
+
+/** Copies a RIL_Data_Call_Response_v11 array with its strings packed behind it */
+static void *
+copyDataCallList(const void *data, size_t datalen) {
+    if (datalen % sizeof(RIL_Data_Call_Response_v11) != 0) {
+        // dataCallListChangedInd() rejects it before looking at any string
+        return copyFlatPayload(data, datalen);
+    }
+
+    const RIL_Data_Call_Response_v11 *src = (const RIL_Data_Call_Response_v11 *) data;
+    size_t num = datalen / sizeof(RIL_Data_Call_Response_v11);
+    size_t size = datalen;
+    for (size_t i = 0; i < num; i++) {
+        size += packedStringSize(src[i].type) + packedStringSize(src[i].ifname)
+                + packedStringSize(src[i].addresses) + packedStringSize(src[i].dnses)
+                + packedStringSize(src[i].gateways) + packedStringSize(src[i].pcscf);
+    }
+
+    char *copy = (char *) malloc(size > 0 ? size : 1);
+    if (copy == NULL) {
+        return NULL;
+    }
+    memcpy(copy, data, datalen);
+
+    RIL_Data_Call_Response_v11 *dst = (RIL_Data_Call_Response_v11 *) copy;
+    char *strings = copy + datalen;
+    for (size_t i = 0; i < num; i++) {
+        dst[i].type = packString(&strings, src[i].type);
+        dst[i].ifname = packString(&strings, src[i].ifname);
+        dst[i].addresses = packString(&strings, src[i].addresses);
+        dst[i].dnses = packString(&strings, src[i].dnses);
+        dst[i].gateways = packString(&strings, src[i].gateways);
+        dst[i].pcscf = packString(&strings, src[i].pcscf);
+    }
+    return copy;
+}
+
+static void
+initUnsolCoalescing() {
+    char prop[PROPERTY_VALUE_MAX];
+    char *saveptr = NULL;
+
+    for (int slot = 0; slot < SIM_COUNT; slot++) {
+        for (int i = 0; i < (int) NUM_ELEMS(s_unsolResponses); i++) {
+            s_unsolCoalesceState[slot][i].socket_id = (RIL_SOCKET_ID) slot;
+            s_unsolCoalesceState[slot][i].unsolResponseIndex = i;
+        }
+    }
+
+    if (property_get(PROPERTY_UNSOL_COALESCE, prop, "") <= 0) {
+        return;
+    }
+
+    for (char *entry = strtok_r(prop, ",", &saveptr); entry != NULL;
+            entry = strtok_r(NULL, ",", &saveptr)) {
+        int unsolResponse, windowMs;
+        if (sscanf(entry, "%d:%d", &unsolResponse, &windowMs) != 2 || windowMs <= 0) {
+            RLOGE("initUnsolCoalescing: ignoring malformed entry '%s'", entry);
+            continue;
+        }
+
+        UnsolPayloadCopy copy = NULL;
+        for (size_t i = 0; i < NUM_ELEMS(s_coalescibleUnsolResponses); i++) {
+            if (s_coalescibleUnsolResponses[i].unsolResponse == unsolResponse) {
+                copy = s_coalescibleUnsolResponses[i].copy;
+            }
+        }
+        if (copy == NULL) {
+            RLOGE("initUnsolCoalescing: %s can't be coalesced", requestToString(unsolResponse));
+            continue;
+        }
+
+        int index = unsolResponse - RIL_UNSOL_RESPONSE_BASE;
+        s_unsolCoalesceWindowMs[index] = windowMs;
+        s_unsolCoalesceCopy[index] = copy;
+        RLOGI("Coalescing %s over %d ms", requestToString(unsolResponse), windowMs);
+    }
+}
+
+static void flushCoalescedUnsolResponse(void *param);
+
+/** Must hold s_unsolCoalesceMutex */
+static void
+holdCoalesceWakeLock(UnsolCoalesceState *state) {
+    if (s_unsolResponses[state->unsolResponseIndex].wakeType != WAKE_PARTIAL) {
+        return;
+    }
+    if (s_unsolCoalesceWakeLockCount++ == 0) {
+        acquire_wake_lock(PARTIAL_WAKE_LOCK, UNSOL_COALESCE_WAKE_LOCK_NAME);
+    }
+}
+
+/** Must hold s_unsolCoalesceMutex */
+static void
+dropCoalesceWakeLock(UnsolCoalesceState *state) {
+    if (s_unsolResponses[state->unsolResponseIndex].wakeType != WAKE_PARTIAL) {
+        return;
+    }
+    if (--s_unsolCoalesceWakeLockCount == 0) {
+        release_wake_lock(UNSOL_COALESCE_WAKE_LOCK_NAME);
+    }
+}
+
+/** Must hold s_unsolCoalesceMutex */
+static bool
+armCoalesceWindow(UnsolCoalesceState *state) {
+    int windowMs = s_unsolCoalesceWindowMs[state->unsolResponseIndex];
+    struct timeval window = {windowMs / 1000, (windowMs % 1000) * 1000};
+
+    state->windowOpen = internalRequestTimedCallbackOnLoop(getEventLoop(state->socket_id),
+            flushCoalescedUnsolResponse, state, &window) != NULL;
+    return state->windowOpen;
+}
+
+/** Delivers the held payload. Must hold s_unsolCoalesceMutex; drops it meanwhile */
+static void
+dispatchPendingUnsolResponse(UnsolCoalesceState *state) {
+    void *data = state->pending;
+    size_t datalen = state->pendingLen;
+
+    state->pending = NULL;
+    state->hasPending = false;
+    state->delivering = true;
+
+    int ret = pthread_mutex_unlock(&s_unsolCoalesceMutex);
+    assert(ret == 0);
+
+    dispatchUnsolResponse(state->unsolResponseIndex, data, datalen, state->socket_id);
+    free(data);
+
+    ret = pthread_mutex_lock(&s_unsolCoalesceMutex);
+    assert(ret == 0);
+    state->delivering = false;
+    // Only now: dispatchUnsolResponse() has taken its own wake lock
+    dropCoalesceWakeLock(state);
+}
+
+static void
+flushCoalescedUnsolResponse(void *param) {
+    UnsolCoalesceState *state = (UnsolCoalesceState *) param;
+    bool flushed = false;
+
+    int ret = pthread_mutex_lock(&s_unsolCoalesceMutex);
+    assert(ret == 0);
+
+    // While the payload that opened the window is still going out, wait for
+    // it so that deliveries stay in order
+    if (state->hasPending && !state->delivering) {
+        dispatchPendingUnsolResponse(state);
+        flushed = true;
+    }
+
+    if (!flushed && !state->hasPending && !state->delivering) {
+        // Quiet for a whole window
+        state->windowOpen = false;
+    } else if (!armCoalesceWindow(state) && state->hasPending) {
+        RLOGE("flushCoalescedUnsolResponse: can't re-arm window for %s",
+                requestToString(state->unsolResponseIndex + RIL_UNSOL_RESPONSE_BASE));
+        dispatchPendingUnsolResponse(state);
+    }
+
+    ret = pthread_mutex_unlock(&s_unsolCoalesceMutex);
+    assert(ret == 0);
+}
+
+/**
+ * Runs an unsolicited response through its coalescing window, if it has one.
+ * Returns false if the caller has to dispatch it.
+ */
+static bool
+coalesceUnsolResponse(int unsolResponseIndex, const void *data, size_t datalen,
+        RIL_SOCKET_ID soc_id) {
+    if (s_unsolCoalesceWindowMs[unsolResponseIndex] == 0
+            || (int) soc_id < 0 || (int) soc_id >= SIM_COUNT) {
+        return false;
+    }
+
+    UnsolCoalesceState *state = &s_unsolCoalesceState[soc_id][unsolResponseIndex];
+    bool consumed = true;
+
+    int ret = pthread_mutex_lock(&s_unsolCoalesceMutex);
+    assert(ret == 0);
+
+    if (state->windowOpen) {
+        void *copy = NULL;
+        if (data != NULL) {
+            copy = s_unsolCoalesceCopy[unsolResponseIndex](data, datalen);
+        }
+        if (data != NULL && copy == NULL) {
+            RLOGE("Memory allocation failed in coalesceUnsolResponse");
+            consumed = false;
+        } else {
+            if (state->hasPending) {
+                statsRecordUnsolCoalesced(unsolResponseIndex);
+            } else {
+                holdCoalesceWakeLock(state);
+            }
+            free(state->pending);
+            state->pending = copy;
+            state->pendingLen = datalen;
+            state->hasPending = true;
+        }
+    } else if (armCoalesceWindow(state)) {
+        // Leading edge: goes out now, straight from the caller's buffer
+        state->delivering = true;
+        ret = pthread_mutex_unlock(&s_unsolCoalesceMutex);
+        assert(ret == 0);
+
+        dispatchUnsolResponse(unsolResponseIndex, data, datalen, soc_id);
+
+        ret = pthread_mutex_lock(&s_unsolCoalesceMutex);
+        assert(ret == 0);
+        state->delivering = false;
+    } else {
+        consumed = false;
+    }
+
+    ret = pthread_mutex_unlock(&s_unsolCoalesceMutex);
+    assert(ret == 0);
+    return consumed;
+}
+
 #if defined(ANDROID_MULTI_SIM)
 extern "C"
 void RIL_onUnsolicitedResponse(int unsolResponse, const void *data,
@@ -728,8 +1286,6 @@ void RIL_onUnsolicitedResponse(int unsolResponse, const void *data,
 #endif
 {
     int unsolResponseIndex;
-    int ret;
-    bool shouldScheduleTimeout = false;
     RIL_SOCKET_ID soc_id = RIL_SOCKET_1;
 
 #if defined(ANDROID_MULTI_SIM)
@@ -751,6 +1307,21 @@ void RIL_onUnsolicitedResponse(int unsolResponse, const void *data,
         return;
     }
 
+    if (coalesceUnsolResponse(unsolResponseIndex, data, datalen, soc_id)) {
+        return;
+    }
+
+    dispatchUnsolResponse(unsolResponseIndex, data, datalen, soc_id);
+}
+
+/** Delivers one unsolicited response, after it has passed validation and coalescing */
+static void
+dispatchUnsolResponse(int unsolResponseIndex, const void *data, size_t datalen,
+        RIL_SOCKET_ID soc_id) {
+    int unsolResponse = unsolResponseIndex + RIL_UNSOL_RESPONSE_BASE;
+    int ret;
+    bool shouldScheduleTimeout = false;
+
     // Grab a wake lock if needed for this reponse,
     // as we exit we'll either release it immediately
     // or set a timer to release it later.
@@ -777,27 +1348,29 @@ void RIL_onUnsolicitedResponse(int unsolResponse, const void *data,
         responseType = RESPONSE_UNSOLICITED;
     }
 
-    pthread_rwlock_t *radioServiceRwlockPtr = radio::getRadioServiceRwlock((int) soc_id);
-    int rwlockRet;
-
+    int nitzRet;
     if (unsolResponse == RIL_UNSOL_NITZ_TIME_RECEIVED) {
-        // get a write lock in caes of NITZ since setNitzTimeReceived() is called
-        rwlockRet = pthread_rwlock_wrlock(radioServiceRwlockPtr);
-        assert(rwlockRet == 0);
+        // hold s_nitzMutex in case of NITZ since setNitzTimeReceived() is called
+        nitzRet = pthread_mutex_lock(&s_nitzMutex);
+        assert(nitzRet == 0);
         radio::setNitzTimeReceived((int) soc_id, android::elapsedRealtime());
-    } else {
-        rwlockRet = pthread_rwlock_rdlock(radioServiceRwlockPtr);
-        assert(rwlockRet == 0);
     }
 
+    uint64_t deliverTime = ril_nano_time();
     if (s_unsolResponses[unsolResponseIndex].responseFunction) {
+        radio::CallbacksReader reader((int) soc_id);
         ret = s_unsolResponses[unsolResponseIndex].responseFunction(
                 (int) soc_id, responseType, 0, RIL_E_SUCCESS, const_cast<void*>(data),
                 datalen);
     }
+    deliverTime = ril_nano_time() - deliverTime;
+
+    if (unsolResponse == RIL_UNSOL_NITZ_TIME_RECEIVED) {
+        nitzRet = pthread_mutex_unlock(&s_nitzMutex);
+        assert(nitzRet == 0);
+    }
 
-    rwlockRet = pthread_rwlock_unlock(radioServiceRwlockPtr);
-    assert(rwlockRet == 0);
+    statsRecordUnsolResponse(unsolResponseIndex, datalen, shouldScheduleTimeout, deliverTime);
 
     if (s_callbacks.version < 13) {
         if (shouldScheduleTimeout) {
@@ -808,10 +1381,12 @@ void RIL_onUnsolicitedResponse(int unsolResponse, const void *data,
                 goto error_exit;
             } else {
                 // Cancel the previous request
-                if (s_last_wake_timeout_info != NULL) {
-                    s_last_wake_timeout_info->userParam = (void *)1;
-                }
+                int mutexRet = pthread_mutex_lock(&s_wakeLockCountMutex);
+                assert(mutexRet == 0);
+                cancelWakeTimeout();
                 s_last_wake_timeout_info = p_info;
+                mutexRet = pthread_mutex_unlock(&s_wakeLockCountMutex);
+                assert(mutexRet == 0);
             }
         }
     }
@@ -834,7 +1409,7 @@ void RIL_onUnsolicitedResponse(int unsolResponse, const void *data,
 
         s_lastNITZTimeData = calloc(datalen, 1);
         if (s_lastNITZTimeData == NULL) {
-            RLOGE("Memory allocation failed in RIL_onUnsolicitedResponse");
+            RLOGE("Memory allocation failed in dispatchUnsolResponse");
             goto error_exit;
         }
         s_lastNITZTimeDataSize = datalen;
@@ -850,21 +1425,32 @@ error_exit:
     }
 }
 
-/** FIXME generalize this if you track UserCAllbackInfo, clear it
-    when the callback occurs
-*/
+/**
+ * Schedule callback after relativeTime, on the event loop of the slot the
+ * calling thread is working for.
+ * The returned UserCallbackInfo stays valid until the callback has run or
+ * cancelTimedCallback() has succeeded.
+ */
 static UserCallbackInfo *
 internalRequestTimedCallback (RIL_TimedCallback callback, void *param,
                                 const struct timeval *relativeTime)
+{
+    return internalRequestTimedCallbackOnLoop(getEventLoop(s_callingSocketId), callback, param,
+            relativeTime);
+}
+
+/** As internalRequestTimedCallback(), on the given event loop */
+static UserCallbackInfo *
+internalRequestTimedCallbackOnLoop (EventLoopInfo *loop, RIL_TimedCallback callback,
+        void *param, const struct timeval *relativeTime)
 {
     struct timeval myRelativeTime;
     UserCallbackInfo *p_info;
 
-    p_info = (UserCallbackInfo *) calloc(1, sizeof(UserCallbackInfo));
+    p_info = s_userCallbackInfoPool.alloc();
     if (p_info == NULL) {
         RLOGE("Memory allocation failed in internalRequestTimedCallback");
         return p_info;
-
     }
 
     p_info->p_callback = callback;
@@ -874,15 +1460,19 @@ internalRequestTimedCallback (RIL_TimedCallback callback, void *param,
         /* treat null parameter as a 0 relative time */
         memset (&myRelativeTime, 0, sizeof(myRelativeTime));
     } else {
-        /* FIXME I think event_add's tv param is really const anyway */
         memcpy (&myRelativeTime, relativeTime, sizeof(myRelativeTime));
     }
 
     ril_event_set(&(p_info->event), -1, false, userTimerCallback, p_info);
 
-    ril_timer_add(&(p_info->event), &myRelativeTime);
+    if (loop->base == NULL
+            || ril_timer_base_add(loop->base, &(p_info->event), &myRelativeTime) < 0) {
+        RLOGE("Failed to schedule timer in internalRequestTimedCallback");
+        s_userCallbackInfoPool.release(p_info);
+        return NULL;
+    }
 
-    triggerEvLoop();
+    triggerEvLoop(loop);
     return p_info;
 }
 
@@ -0,0 +1,197 @@
+/*
+* Copyright (C) 2026 The Android Open Source Project
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef RIL_OBJECT_POOL_H_INCLUDED
+#define RIL_OBJECT_POOL_H_INCLUDED
+
+#include <atomic>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+
+/**
+ * Occupancy counters of a Ril_pool.
+ */
+typedef struct {
+    uint32_t capacity;      // objects in the slab
+    uint32_t inUse;         // objects currently handed out, slab and heap
+    uint32_t highWater;     // max inUse seen so far; above capacity means undersized
+    uint64_t allocs;        // total allocations, slab and heap
+    uint64_t fallbacks;     // allocations that found the slab exhausted
+} Ril_pool_stats;
+
+/**
+ * Template fixed-size object pool.
+ * <p>
+ * This class performs the following functions :
+ * <ul>
+ *     <li>Hands out zeroed objects from a static slab of N slots.
+ *     <li>Recycles freed slots through a lock-free LIFO freelist.
+ *     <li>Falls back to calloc()/free() when the slab is exhausted.
+ *     <li>Tracks occupancy and high-water mark for sizing.
+ * </ul>
+ * Instances need no runtime initialization, so they can be file-scope statics
+ * used from any thread, including before the event loop is up. T must be a
+ * plain C struct.
+ */
+template <typename T, uint32_t N>
+class Ril_pool {
+
+    static_assert(std::is_trivial<T>::value, "Ril_pool only holds plain C structs");
+
+   /**
+     * Object storage.
+     */
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type slab[N];
+
+   /**
+     * Freelist links, indexed by slot. Holds (next slot + 1), 0 ends the list.
+     */
+    std::atomic<uint32_t> next[N];
+
+   /**
+     * Freelist head: ABA tag in the high 32 bits, (slot + 1) in the low 32.
+     */
+    std::atomic<uint64_t> freeHead;
+
+   /**
+     * Slots never handed out yet are taken in order from here.
+     */
+    std::atomic<uint32_t> nextUnused;
+
+    std::atomic<uint32_t> inUse;
+    std::atomic<uint32_t> highWater;
+    std::atomic<uint64_t> allocs;
+    std::atomic<uint64_t> fallbacks;
+
+    T *slot(uint32_t index) {
+        return reinterpret_cast<T *>(&slab[index]);
+    }
+
+    bool owns(const T *p) const {
+        const char *c = reinterpret_cast<const char *>(p);
+        return c >= reinterpret_cast<const char *>(&slab[0])
+                && c < reinterpret_cast<const char *>(&slab[N]);
+    }
+
+    bool popFree(uint32_t *index) {
+        uint64_t head = freeHead.load(std::memory_order_acquire);
+        while ((uint32_t) head != 0) {
+            uint32_t i = (uint32_t) head - 1;
+            uint64_t newHead = (((head >> 32) + 1) << 32) | next[i].load(std::memory_order_relaxed);
+            if (freeHead.compare_exchange_weak(head, newHead,
+                    std::memory_order_acquire, std::memory_order_acquire)) {
+                *index = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void pushFree(uint32_t index) {
+        uint64_t head = freeHead.load(std::memory_order_relaxed);
+        uint64_t newHead;
+        do {
+            next[index].store((uint32_t) head, std::memory_order_relaxed);
+            newHead = (((head >> 32) + 1) << 32) | (index + 1);
+        } while (!freeHead.compare_exchange_weak(head, newHead,
+                std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void noteInUse() {
+        uint32_t n = inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint32_t max = highWater.load(std::memory_order_relaxed);
+        while (n > max && !highWater.compare_exchange_weak(max, n,
+                std::memory_order_relaxed)) {
+        }
+    }
+
+    public:
+
+       /**
+         * Allocate a zeroed object.
+         *
+         * @return object, or NULL if the slab is exhausted and calloc() failed.
+         */
+        T* alloc(void);
+
+       /**
+         * Return an object obtained from alloc(). NULL is ignored.
+         *
+         * @param Object to be released.
+         */
+        void release(T* p);
+
+       /**
+         * Snapshot the occupancy counters.
+         *
+         * @param Counters to be filled in.
+         */
+        void getStats(Ril_pool_stats *stats);
+};
+
+template <typename T, uint32_t N>
+T* Ril_pool<T, N>::alloc(void) {
+    uint32_t index;
+
+    allocs.fetch_add(1, std::memory_order_relaxed);
+
+    if (!popFree(&index)) {
+        index = nextUnused.load(std::memory_order_relaxed);
+        do {
+            if (index >= N) {
+                fallbacks.fetch_add(1, std::memory_order_relaxed);
+                T *p = (T *) calloc(1, sizeof(T));
+                if (p != NULL) {
+                    noteInUse();
+                }
+                return p;
+            }
+        } while (!nextUnused.compare_exchange_weak(index, index + 1,
+                std::memory_order_relaxed));
+    }
+
+    noteInUse();
+    T *p = slot(index);
+    memset(p, 0, sizeof(T));
+    return p;
+}
+
+template <typename T, uint32_t N>
+void Ril_pool<T, N>::release(T* p) {
+    if (p == NULL) {
+        return;
+    }
+    inUse.fetch_sub(1, std::memory_order_relaxed);
+    if (!owns(p)) {
+        free(p);
+        return;
+    }
+    pushFree((uint32_t) (reinterpret_cast<char *>(p) - reinterpret_cast<char *>(&slab[0]))
+            / sizeof(slab[0]));
+}
+
+template <typename T, uint32_t N>
+void Ril_pool<T, N>::getStats(Ril_pool_stats *stats) {
+    stats->capacity = N;
+    stats->inUse = inUse.load(std::memory_order_relaxed);
+    stats->highWater = highWater.load(std::memory_order_relaxed);
+    stats->allocs = allocs.load(std::memory_order_relaxed);
+    stats->fallbacks = fallbacks.load(std::memory_order_relaxed);
+}
+
+#endif
@@ -21,56 +21,52 @@
 #include <unistd.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <utils/Log.h>
 #include <ril_event.h>
+#include <telephony/librilutils.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/time.h>
 #include <time.h>
 
 #include <pthread.h>
-static pthread_mutex_t listMutex;
-#define MUTEX_ACQUIRE() pthread_mutex_lock(&listMutex)
-#define MUTEX_RELEASE() pthread_mutex_unlock(&listMutex)
-#define MUTEX_INIT() pthread_mutex_init(&listMutex, NULL)
-#define MUTEX_DESTROY() pthread_mutex_destroy(&listMutex)
-
-#ifndef timeradd
-#define timeradd(tvp, uvp, vvp)						\
-	do {								\
-		(vvp)->tv_sec = (tvp)->tv_sec + (uvp)->tv_sec;		\
-		(vvp)->tv_usec = (tvp)->tv_usec + (uvp)->tv_usec;       \
-		if ((vvp)->tv_usec >= 1000000) {			\
-			(vvp)->tv_sec++;				\
-			(vvp)->tv_usec -= 1000000;			\
-		}							\
-	} while (0)
-#endif
+#define MUTEX_ACQUIRE() pthread_mutex_lock(&base->listMutex)
+#define MUTEX_RELEASE() pthread_mutex_unlock(&base->listMutex)
+#define MUTEX_INIT() pthread_mutex_init(&base->listMutex, NULL)
+#define MUTEX_DESTROY() pthread_mutex_destroy(&base->listMutex)
 
-#ifndef timercmp
-#define timercmp(a, b, op)               \
-        ((a)->tv_sec == (b)->tv_sec      \
-        ? (a)->tv_usec op (b)->tv_usec   \
-        : (a)->tv_sec op (b)->tv_sec)
-#endif
+// Max number of ready fd's collected by a single epoll_wait()
+#define MAX_EPOLL_EVENTS 16
 
-#ifndef timersub
-#define timersub(a, b, res)                           \
-    do {                                              \
-        (res)->tv_sec = (a)->tv_sec - (b)->tv_sec;    \
-        (res)->tv_usec = (a)->tv_usec - (b)->tv_usec; \
-        if ((res)->tv_usec < 0) {                     \
-            (res)->tv_usec += 1000000;                \
-            (res)->tv_sec -= 1;                       \
-        }                                             \
-    } while(0);
-#endif
+// Initial size of the watch table; it grows on demand to cover the largest fd
+#define INITIAL_WATCH_TABLE_SIZE 16
+
+// Initial capacity of the timer heap; it grows on demand
+#define INITIAL_TIMER_HEAP_SIZE 16
+
+#define NSEC_PER_MSEC 1000000LL
+#define NSEC_PER_USEC 1000LL
+#define NSEC_PER_SEC 1000000000LL
+
+// State of one event loop
+struct ril_event_base {
+    pthread_mutex_t listMutex;
+
+    int epollFd;
 
-static fd_set readFds;
-static int nfds = 0;
+    // Watched events, indexed by fd
+    struct ril_event ** watch_table;
+    int watch_table_size;
 
-static struct ril_event * watch_table[MAX_FD_EVENTS];
-static struct ril_event timer_list;
-static struct ril_event pending_list;
+    // Pending timers, as a binary min-heap ordered by (timeout, seq)
+    struct ril_event ** timer_heap;
+    int timer_heap_count;
+    int timer_heap_size;
+    uint64_t timer_seq;
+
+    struct ril_event pending_list;
+};
 
 #define DEBUG 0
 
@@ -83,7 +79,7 @@ static void dump_event(struct ril_event * ev)
     dlog("     prev    = %x", (unsigned int)ev->prev);
     dlog("     fd      = %d", ev->fd);
     dlog("     pers    = %d", ev->persist);
-    dlog("     timeout = %ds + %dus", (int)ev->timeout.tv_sec, (int)ev->timeout.tv_usec);
+    dlog("     timeout = %lluns", (unsigned long long)ev->timeout);
     dlog("     func    = %x", (unsigned int)ev->func);
     dlog("     param   = %x", (unsigned int)ev->param);
     dlog("~~~~~~~~~~~~~~~~~~");
@@ -93,14 +89,6 @@ static void dump_event(struct ril_event * ev)
 #define dump_event(x) do {} while(0)
 #endif
 
-static void getNow(struct timeval * tv)
-{
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    tv->tv_sec = ts.tv_sec;
-    tv->tv_usec = ts.tv_nsec/1000;
-}
-
 static void init_list(struct ril_event * list)
 {
     memset(list, 0, sizeof(struct ril_event));
@@ -131,67 +119,167 @@ static void removeFromList(struct ril_event * ev)
 }
 
 
-static void removeWatch(struct ril_event * ev, int index)
+static bool timerBefore(struct ril_event * a, struct ril_event * b)
 {
-    dlog("~~~~ +removeWatch ~~~~");
-    watch_table[index] = NULL;
-    ev->index = -1;
+    // Timers due at the same time fire in the order they were added
+    if (a->timeout != b->timeout) {
+        return a->timeout < b->timeout;
+    }
+    return a->seq < b->seq;
+}
+
+static void setHeapSlot(struct ril_event_base * base, struct ril_event * ev, int index)
+{
+    base->timer_heap[index] = ev;
+    ev->index = index;
+}
+
+static void siftUp(struct ril_event_base * base, int index)
+{
+    struct ril_event * ev = base->timer_heap[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!timerBefore(ev, base->timer_heap[parent])) {
+            break;
+        }
+        setHeapSlot(base, base->timer_heap[parent], index);
+        index = parent;
+    }
+    setHeapSlot(base, ev, index);
+}
+
+static void siftDown(struct ril_event_base * base, int index)
+{
+    struct ril_event * ev = base->timer_heap[index];
+    for (;;) {
+        int child = 2 * index + 1;
+        if (child >= base->timer_heap_count) {
+            break;
+        }
+        if (child + 1 < base->timer_heap_count
+                && timerBefore(base->timer_heap[child + 1], base->timer_heap[child])) {
+            child++;
+        }
+        if (!timerBefore(base->timer_heap[child], ev)) {
+            break;
+        }
+        setHeapSlot(base, base->timer_heap[child], index);
+        index = child;
+    }
+    setHeapSlot(base, ev, index);
+}
 
-    FD_CLR(ev->fd, &readFds);
+static int growTimerHeap(struct ril_event_base * base)
+{
+    int size = (base->timer_heap_size > 0) ? base->timer_heap_size * 2 : INITIAL_TIMER_HEAP_SIZE;
 
-    if (ev->fd+1 == nfds) {
-        int n = 0;
+    struct ril_event ** heap = (struct ril_event **) realloc(base->timer_heap,
+            size * sizeof(struct ril_event *));
+    if (heap == NULL) {
+        RLOGE("ril_event: failed to grow timer heap to %d entries", size);
+        return -1;
+    }
 
-        for (int i = 0; i < MAX_FD_EVENTS; i++) {
-            struct ril_event * rev = watch_table[i];
+    base->timer_heap = heap;
+    base->timer_heap_size = size;
+    dlog("~~~~ timer heap size = %d ~~~~", base->timer_heap_size);
+    return 0;
+}
 
-            if ((rev != NULL) && (rev->fd > n)) {
-                n = rev->fd;
-            }
+static void removeTimer(struct ril_event_base * base, struct ril_event * ev)
+{
+    int index = ev->index;
+    struct ril_event * last = base->timer_heap[--base->timer_heap_count];
+
+    ev->index = -1;
+    if (last != ev) {
+        setHeapSlot(base, last, index);
+        if (index > 0 && timerBefore(last, base->timer_heap[(index - 1) / 2])) {
+            siftUp(base, index);
+        } else {
+            siftDown(base, index);
         }
-        nfds = n + 1;
-        dlog("~~~~ nfds = %d ~~~~", nfds);
     }
+}
+
+static bool isPendingTimer(struct ril_event_base * base, struct ril_event * ev)
+{
+    return ev->fd < 0 && ev->index >= 0 && ev->index < base->timer_heap_count
+            && base->timer_heap[ev->index] == ev;
+}
+
+static int growWatchTable(struct ril_event_base * base, int fd)
+{
+    int size = (base->watch_table_size > 0) ? base->watch_table_size : INITIAL_WATCH_TABLE_SIZE;
+    while (size <= fd) {
+        size *= 2;
+    }
+
+    struct ril_event ** table = (struct ril_event **) realloc(base->watch_table,
+            size * sizeof(struct ril_event *));
+    if (table == NULL) {
+        RLOGE("ril_event: failed to grow watch table to %d entries", size);
+        return -1;
+    }
+    memset(table + base->watch_table_size, 0,
+            (size - base->watch_table_size) * sizeof(struct ril_event *));
+
+    base->watch_table = table;
+    base->watch_table_size = size;
+    dlog("~~~~ watch table size = %d ~~~~", base->watch_table_size);
+    return 0;
+}
+
+static void removeWatch(struct ril_event_base * base, struct ril_event * ev, int index)
+{
+    dlog("~~~~ +removeWatch ~~~~");
+    base->watch_table[index] = NULL;
+    ev->index = -1;
+
+    // The fd may already have been closed, which drops it from the epoll set
+    // on its own, so failures here are not interesting.
+    epoll_ctl(base->epollFd, EPOLL_CTL_DEL, ev->fd, NULL);
     dlog("~~~~ -removeWatch ~~~~");
 }
 
-static void processTimeouts()
+static void processTimeouts(struct ril_event_base * base)
 {
     dlog("~~~~ +processTimeouts ~~~~");
     MUTEX_ACQUIRE();
-    struct timeval now;
-    struct ril_event * tev = timer_list.next;
-    struct ril_event * next;
+    uint64_t now = ril_nano_time();
 
-    getNow(&now);
-    // walk list, see if now >= ev->timeout for any events
+    // pop timers off the heap while now >= ev->timeout
 
-    dlog("~~~~ Looking for timers <= %ds + %dus ~~~~", (int)now.tv_sec, (int)now.tv_usec);
-    while ((tev != &timer_list) && (timercmp(&now, &tev->timeout, >))) {
+    dlog("~~~~ Looking for timers <= %lluns ~~~~", (unsigned long long)now);
+    while (base->timer_heap_count > 0 && base->timer_heap[0]->timeout <= now) {
         // Timer expired
         dlog("~~~~ firing timer ~~~~");
-        next = tev->next;
-        removeFromList(tev);
-        addToList(tev, &pending_list);
-        tev = next;
+        struct ril_event * tev = base->timer_heap[0];
+        removeTimer(base, tev);
+        addToList(tev, &base->pending_list);
     }
     MUTEX_RELEASE();
     dlog("~~~~ -processTimeouts ~~~~");
 }
 
-static void processReadReadies(fd_set * rfds, int n)
+static void processReadReadies(struct ril_event_base * base, struct epoll_event * events, int n)
 {
     dlog("~~~~ +processReadReadies (%d) ~~~~", n);
     MUTEX_ACQUIRE();
 
-    for (int i = 0; (i < MAX_FD_EVENTS) && (n > 0); i++) {
-        struct ril_event * rev = watch_table[i];
-        if (rev != NULL && FD_ISSET(rev->fd, rfds)) {
-            addToList(rev, &pending_list);
+    for (int i = 0; i < n; i++) {
+        int fd = events[i].data.fd;
+        // The event may have been deleted by another thread since epoll_wait()
+        // returned, so only trust what is still in the watch table.
+        if (fd < 0 || fd >= base->watch_table_size) {
+            continue;
+        }
+        struct ril_event * rev = base->watch_table[fd];
+        if (rev != NULL) {
+            addToList(rev, &base->pending_list);
             if (rev->persist == false) {
-                removeWatch(rev, i);
+                removeWatch(base, rev, fd);
             }
-            n--;
         }
     }
 
@@ -199,11 +287,11 @@ static void processReadReadies(fd_set * rfds, int n)
     dlog("~~~~ -processReadReadies (%d) ~~~~", n);
 }
 
-static void firePending()
+static void firePending(struct ril_event_base * base)
 {
     dlog("~~~~ +firePending ~~~~");
-    struct ril_event * ev = pending_list.next;
-    while (ev != &pending_list) {
+    struct ril_event * ev = base->pending_list.next;
+    while (ev != &base->pending_list) {
         struct ril_event * next = ev->next;
         removeFromList(ev);
         ev->func(ev->fd, 0, ev->param);
@@ -212,40 +300,65 @@ static void firePending()
     dlog("~~~~ -firePending ~~~~");
 }
 
-static int calcNextTimeout(struct timeval * tv)
+// Returns the epoll_wait() timeout in ms for the earliest timer, or -1 if
+// there are no pending timers
+static int calcNextTimeout(struct ril_event_base * base)
 {
-    struct ril_event * tev = timer_list.next;
-    struct timeval now;
+    int timeoutMs;
 
-    getNow(&now);
-
-    // Sorted list, so calc based on first node
-    if (tev == &timer_list) {
+    MUTEX_ACQUIRE();
+    if (base->timer_heap_count == 0) {
         // no pending timers
-        return -1;
-    }
-
-    dlog("~~~~ now = %ds + %dus ~~~~", (int)now.tv_sec, (int)now.tv_usec);
-    dlog("~~~~ next = %ds + %dus ~~~~",
-            (int)tev->timeout.tv_sec, (int)tev->timeout.tv_usec);
-    if (timercmp(&tev->timeout, &now, >)) {
-        timersub(&tev->timeout, &now, tv);
+        timeoutMs = -1;
     } else {
-        // timer already expired.
-        tv->tv_sec = tv->tv_usec = 0;
+        uint64_t now = ril_nano_time();
+        uint64_t next = base->timer_heap[0]->timeout;
+
+        dlog("~~~~ now = %lluns ~~~~", (unsigned long long)now);
+        dlog("~~~~ next = %lluns ~~~~", (unsigned long long)next);
+        if (next > now) {
+            // round up so we don't wake just before the timer is due
+            uint64_t ms = (next - now + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC;
+            timeoutMs = (ms > INT_MAX) ? INT_MAX : (int) ms;
+        } else {
+            // timer already expired.
+            timeoutMs = 0;
+        }
     }
-    return 0;
+    MUTEX_RELEASE();
+    return timeoutMs;
 }
 
-// Initialize internal data structs
-void ril_event_init()
+// Initialize a base's internal data structs
+static int initBase(struct ril_event_base * base)
 {
+    memset(base, 0, sizeof(struct ril_event_base));
     MUTEX_INIT();
 
-    FD_ZERO(&readFds);
-    init_list(&timer_list);
-    init_list(&pending_list);
-    memset(watch_table, 0, sizeof(watch_table));
+    base->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (base->epollFd < 0) {
+        RLOGE("ril_event: epoll_create1 error (%d)", errno);
+        MUTEX_DESTROY();
+        return -1;
+    }
+    init_list(&base->pending_list);
+    return 0;
+}
+
+// Create a new event loop base
+struct ril_event_base * ril_event_base_new()
+{
+    struct ril_event_base * base =
+            (struct ril_event_base *) malloc(sizeof(struct ril_event_base));
+    if (base == NULL) {
+        RLOGE("ril_event: failed to allocate event base");
+        return NULL;
+    }
+    if (initBase(base) < 0) {
+        free(base);
+        return NULL;
+    }
+    return base;
 }
 
 // Initialize an event
@@ -261,124 +374,162 @@ void ril_event_set(struct ril_event * ev, int fd, bool persist, ril_event_cb fun
     fcntl(fd, F_SETFL, O_NONBLOCK);
 }
 
-// Add event to watch list
-void ril_event_add(struct ril_event * ev)
+// Add event to a base's watch list
+void ril_event_base_add(struct ril_event_base * base, struct ril_event * ev)
 {
-    dlog("~~~~ +ril_event_add ~~~~");
+    dlog("~~~~ +ril_event_base_add ~~~~");
     MUTEX_ACQUIRE();
-    for (int i = 0; i < MAX_FD_EVENTS; i++) {
-        if (watch_table[i] == NULL) {
-            watch_table[i] = ev;
-            ev->index = i;
-            dlog("~~~~ added at %d ~~~~", i);
+    if (ev->fd < 0) {
+        RLOGE("ril_event: can't watch invalid fd %d", ev->fd);
+    } else if (ev->fd >= base->watch_table_size && growWatchTable(base, ev->fd) < 0) {
+        // already logged
+    } else if (base->watch_table[ev->fd] != NULL) {
+        RLOGE("ril_event: fd %d is already being watched", ev->fd);
+    } else {
+        struct epoll_event epev;
+        memset(&epev, 0, sizeof(epev));
+        epev.events = EPOLLIN;
+        epev.data.fd = ev->fd;
+
+        if (epoll_ctl(base->epollFd, EPOLL_CTL_ADD, ev->fd, &epev) < 0) {
+            RLOGE("ril_event: epoll_ctl add error (%d) for fd %d", errno, ev->fd);
+        } else {
+            base->watch_table[ev->fd] = ev;
+            ev->index = ev->fd;
+            ev->base = base;
+            dlog("~~~~ added at %d ~~~~", ev->index);
             dump_event(ev);
-            FD_SET(ev->fd, &readFds);
-            if (ev->fd >= nfds) nfds = ev->fd+1;
-            dlog("~~~~ nfds = %d ~~~~", nfds);
-            break;
         }
     }
     MUTEX_RELEASE();
-    dlog("~~~~ -ril_event_add ~~~~");
+    dlog("~~~~ -ril_event_base_add ~~~~");
 }
 
-// Add timer event
-void ril_timer_add(struct ril_event * ev, struct timeval * tv)
+// Add timer event to a base
+int ril_timer_base_add(struct ril_event_base * base, struct ril_event * ev, struct timeval * tv)
 {
-    dlog("~~~~ +ril_timer_add ~~~~");
+    dlog("~~~~ +ril_timer_base_add ~~~~");
+    int ret = 0;
     MUTEX_ACQUIRE();
 
-    struct ril_event * list;
     if (tv != NULL) {
-        // add to timer list
-        list = timer_list.next;
-        ev->fd = -1; // make sure fd is invalid
-
-        struct timeval now;
-        getNow(&now);
-        timeradd(&now, tv, &ev->timeout);
-
-        // keep list sorted
-        while (timercmp(&list->timeout, &ev->timeout, < )
-                && (list != &timer_list)) {
-            list = list->next;
+        if (base->timer_heap_count == base->timer_heap_size && growTimerHeap(base) < 0) {
+            ret = -1;
+        } else {
+            ev->fd = -1; // make sure fd is invalid
+            ev->timeout = ril_nano_time() + tv->tv_sec * NSEC_PER_SEC
+                    + tv->tv_usec * NSEC_PER_USEC;
+            ev->seq = base->timer_seq++;
+            ev->base = base;
+
+            setHeapSlot(base, ev, base->timer_heap_count++);
+            siftUp(base, ev->index);
+            dump_event(ev);
         }
-        // list now points to the first event older than ev
-        addToList(ev, list);
     }
 
     MUTEX_RELEASE();
-    dlog("~~~~ -ril_timer_add ~~~~");
+    dlog("~~~~ -ril_timer_base_add ~~~~");
+    return ret;
+}
+
+// Remove timer event before it fires
+bool ril_timer_del(struct ril_event * ev)
+{
+    struct ril_event_base * base = ev->base;
+    bool removed = false;
+
+    if (base == NULL) {
+        return false;
+    }
+
+    dlog("~~~~ +ril_timer_del ~~~~");
+    MUTEX_ACQUIRE();
+
+    if (isPendingTimer(base, ev)) {
+        removeTimer(base, ev);
+        removed = true;
+    }
+
+    MUTEX_RELEASE();
+    dlog("~~~~ -ril_timer_del ~~~~");
+    return removed;
 }
 
 // Remove event from watch or timer list
 void ril_event_del(struct ril_event * ev)
 {
+    struct ril_event_base * base = ev->base;
+
+    if (base == NULL) {
+        return;
+    }
+
     dlog("~~~~ +ril_event_del ~~~~");
     MUTEX_ACQUIRE();
 
-    if (ev->index < 0 || ev->index >= MAX_FD_EVENTS) {
+    if (ev->fd < 0) {
+        if (isPendingTimer(base, ev)) {
+            removeTimer(base, ev);
+        }
         MUTEX_RELEASE();
         return;
     }
 
-    removeWatch(ev, ev->index);
+    if (ev->index < 0 || ev->index >= base->watch_table_size
+            || base->watch_table[ev->index] != ev) {
+        MUTEX_RELEASE();
+        return;
+    }
+
+    removeWatch(base, ev, ev->index);
 
     MUTEX_RELEASE();
     dlog("~~~~ -ril_event_del ~~~~");
 }
 
 #if DEBUG
-static void printReadies(fd_set * rfds)
+static void printReadies(struct epoll_event * events, int n)
 {
-    for (int i = 0; (i < MAX_FD_EVENTS); i++) {
-        struct ril_event * rev = watch_table[i];
-        if (rev != NULL && FD_ISSET(rev->fd, rfds)) {
-          dlog("DON: fd=%d is ready", rev->fd);
-        }
+    for (int i = 0; i < n; i++) {
+        dlog("DON: fd=%d is ready", events[i].data.fd);
     }
 }
 #else
-#define printReadies(rfds) do {} while(0)
+#define printReadies(events, n) do {} while(0)
 #endif
 
-void ril_event_loop()
+void ril_event_base_loop(struct ril_event_base * base)
 {
     int n;
-    fd_set rfds;
-    struct timeval tv;
-    struct timeval * ptv;
-
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    int timeoutMs;
 
     for (;;) {
 
-        // make local copy of read fd_set
-        memcpy(&rfds, &readFds, sizeof(fd_set));
-        if (-1 == calcNextTimeout(&tv)) {
+        timeoutMs = calcNextTimeout(base);
+        if (timeoutMs < 0) {
             // no pending timers; block indefinitely
             dlog("~~~~ no timers; blocking indefinitely ~~~~");
-            ptv = NULL;
         } else {
-            dlog("~~~~ blocking for %ds + %dus ~~~~", (int)tv.tv_sec, (int)tv.tv_usec);
-            ptv = &tv;
+            dlog("~~~~ blocking for %dms ~~~~", timeoutMs);
         }
-        printReadies(&rfds);
-        n = select(nfds, &rfds, NULL, NULL, ptv);
-        printReadies(&rfds);
+        n = epoll_wait(base->epollFd, events, MAX_EPOLL_EVENTS, timeoutMs);
+        printReadies(events, n);
         dlog("~~~~ %d events fired ~~~~", n);
         if (n < 0) {
             if (errno == EINTR) continue;
 
-            RLOGE("ril_event: select error (%d)", errno);
+            RLOGE("ril_event: epoll_wait error (%d)", errno);
             // bail?
             return;
         }
 
         // Check for timeouts
-        processTimeouts();
+        processTimeouts(base);
         // Check for read-ready
-        processReadReadies(&rfds, n);
+        processReadReadies(base, events, n);
         // Fire away
-        firePending();
+        firePending(base);
     }
 }
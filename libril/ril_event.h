@@ -15,38 +15,47 @@
 ** limitations under the License.
 */
 
-// Max number of fd's we watch at any one time.  Increase if necessary.
-#define MAX_FD_EVENTS 8
+#include <stdint.h>
+#include <sys/time.h>
 
 typedef void (*ril_event_cb)(int fd, short events, void *userdata);
 
+// State of one event loop, created by ril_event_base_new()
+struct ril_event_base;
+
 struct ril_event {
     struct ril_event *next;
     struct ril_event *prev;
 
     int fd;
-    int index;
+    int index;      // slot in the watch table or timer heap, -1 if in neither
     bool persist;
-    struct timeval timeout;
+    uint64_t timeout;   // CLOCK_MONOTONIC deadline in ns, for timers
+    uint64_t seq;       // orders timers that share a deadline
     ril_event_cb func;
     void *param;
+    struct ril_event_base *base;    // loop the event was added to
 };
 
-// Initialize internal data structs
-void ril_event_init();
+// Create an event loop base. Returns NULL on failure.
+struct ril_event_base * ril_event_base_new();
 
 // Initialize an event
 void ril_event_set(struct ril_event * ev, int fd, bool persist, ril_event_cb func, void * param);
 
 // Add event to watch list
-void ril_event_add(struct ril_event * ev);
+void ril_event_base_add(struct ril_event_base * base, struct ril_event * ev);
+
+// Add timer event. Returns 0 on success, -1 if it could not be queued.
+int ril_timer_base_add(struct ril_event_base * base, struct ril_event * ev, struct timeval * tv);
 
-// Add timer event
-void ril_timer_add(struct ril_event * ev, struct timeval * tv);
+// Remove timer event. Returns true if the timer had not fired yet and
+// will now never fire; false if it is already being dispatched.
+bool ril_timer_del(struct ril_event * ev);
 
 // Remove event from watch list
 void ril_event_del(struct ril_event * ev);
 
 // Event loop
-void ril_event_loop();
+void ril_event_base_loop(struct ril_event_base * base);
 
@@ -17,6 +17,8 @@
 #ifndef ANDROID_RIL_INTERNAL_H
 #define ANDROID_RIL_INTERNAL_H
 
+#include <rilObjectPool.h>
+
 namespace android {
 
 #define RIL_SERVICE_NAME_BASE "slot"
@@ -77,6 +79,8 @@ typedef struct RequestInfo {
     char local;         // responses to local commands do not go back to command process
     RIL_SOCKET_ID socket_id;
     int wasAckSent;    // Indicates whether an ack was sent earlier
+    uint64_t dispatchTime;  // ril_nano_time() when the request was queued
+    uint32_t generation;    // tells this request's RIL_Token from a stale one
 } RequestInfo;
 
 typedef struct CommandInfo {
@@ -87,12 +91,25 @@ typedef struct CommandInfo {
 
 RequestInfo * addRequestToList(int serial, int slotId, int request);
 
+// The RIL_Token handed to the vendor RIL for pRI
+RIL_Token getRequestToken(const RequestInfo *pRI);
+
 char * RIL_getServiceName();
 
+// Occupancy of the RequestInfo / UserCallbackInfo allocation pools
+void getRequestInfoPoolStats(Ril_pool_stats *stats);
+void getUserCallbackInfoPoolStats(Ril_pool_stats *stats);
+
 void releaseWakeLock();
 
 void onNewCommandConnect(RIL_SOCKET_ID socket_id);
 
+// Route timed callbacks requested from this thread to socket_id's event loop
+void setCallingSocketId(RIL_SOCKET_ID socket_id);
+
+// Event loop wakeups written to its eventfd vs. absorbed by one already pending
+void getEventLoopWakeupStats(RIL_SOCKET_ID socket_id, uint64_t *issued, uint64_t *coalesced);
+
 }   // namespace android
 
 #endif //ANDROID_RIL_INTERNAL_H
@@ -24,12 +24,19 @@
 #include <hwbinder/IPCThreadState.h>
 #include <hwbinder/ProcessState.h>
 #include <telephony/ril.h>
+#include <telephony/librilutils.h>
 #include <telephony/ril_mnc.h>
 #include <telephony/ril_mcc.h>
 #include <ril_service.h>
+#include <ril_stats.h>
 #include <hidl/HidlTransportSupport.h>
 #include <utils/SystemClock.h>
+#include <cutils/properties.h>
 #include <inttypes.h>
+#include <unistd.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 #define INVALID_HEX_CHAR 16
 
@@ -41,6 +48,7 @@ using ::android::hardware::Return;
 using ::android::hardware::hidl_string;
 using ::android::hardware::hidl_vec;
 using ::android::hardware::hidl_array;
+using ::android::hardware::hidl_handle;
 using ::android::hardware::Void;
 using android::CommandInfo;
 using android::RequestInfo;
@@ -51,18 +59,67 @@ using android::sp;
 #define ATOI_NULL_HANDLED(x) (x ? atoi(x) : -1)
 #define ATOI_NULL_HANDLED_DEF(x, defaultVal) (x ? atoi(x) : defaultVal)
 
+// Size of the hwbinder thread pool serving IRadio and ISap. With more than one
+// thread, requests for different slots reach the vendor RIL in parallel.
+#define PROPERTY_BINDER_THREADS "ro.vendor.ril.binder_threads"
+#define MAX_BINDER_THREADS 16
+
+#define CALL_ONREQUEST(a, b, c, d, e) callOnRequest((a), (b), (c), (d), (e))
 #if defined(ANDROID_MULTI_SIM)
-#define CALL_ONREQUEST(a, b, c, d, e) \
-        s_vendorFunctions->onRequest((a), (b), (c), (d), ((RIL_SOCKET_ID)(e)))
 #define CALL_ONSTATEREQUEST(a) s_vendorFunctions->onStateRequest((RIL_SOCKET_ID)(a))
 #else
-#define CALL_ONREQUEST(a, b, c, d, e) s_vendorFunctions->onRequest((a), (b), (c), (d))
 #define CALL_ONSTATEREQUEST(a) s_vendorFunctions->onStateRequest()
 #endif
 
 RIL_RadioFunctions *s_vendorFunctions = NULL;
 static CommandInfo *s_commands;
 
+/**
+ * Requests for one slot waiting for the vendor's onRequest(), served in the
+ * order they took a ticket. The binder driver already hands out oneway
+ * calls to one IRadio instance one at a time; the queue keeps each slot to
+ * a single onRequest() whichever binder threads the calls land on, while
+ * different slots proceed in parallel.
+ */
+typedef struct {
+    std::mutex mutex;
+    std::condition_variable turn;
+    uint64_t nextTicket;
+    uint64_t nowServing;
+} SlotQueue;
+
+static SlotQueue slotQueues[SIM_COUNT];
+
+static void callOnRequest(int request, void *data, size_t datalen, RequestInfo *pRI,
+        int slotId) {
+    SlotQueue *queue = &slotQueues[slotId];
+    uint64_t queuedTime = ril_nano_time();
+
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    uint64_t ticket = queue->nextTicket++;
+    while (queue->nowServing != ticket) {
+        queue->turn.wait(lock);
+    }
+    lock.unlock();
+
+    uint64_t startTime = ril_nano_time();
+#if defined(ANDROID_MULTI_SIM)
+    android::setCallingSocketId((RIL_SOCKET_ID) slotId);
+    s_vendorFunctions->onRequest(request, data, datalen, android::getRequestToken(pRI),
+            (RIL_SOCKET_ID) slotId);
+#else
+    s_vendorFunctions->onRequest(request, data, datalen, android::getRequestToken(pRI));
+#endif
+    uint64_t endTime = ril_nano_time();
+
+    lock.lock();
+    queue->nowServing++;
+    lock.unlock();
+    queue->turn.notify_all();
+
+    android::statsRecordDispatch(slotId, startTime - queuedTime, endTime - startTime);
+}
+
 struct RadioImpl;
 
 #if (SIM_COUNT >= 2)
@@ -89,6 +146,145 @@ static pthread_rwlock_t radioServiceRwlock4 = PTHREAD_RWLOCK_INITIALIZER;
 #endif
 #endif
 
+/**
+ * The response and indication callbacks registered for a slot. A set is
+ * never modified once published: setResponseFunctions() and
+ * checkReturnStatus() publish a new one instead.
+ */
+struct radio::RadioCallbacks {
+    sp<IRadioResponse> response;
+    sp<IRadioIndication> indication;
+    sp<V1_1::IRadioResponse> responseV1_1;
+    sp<V1_1::IRadioIndication> indicationV1_1;
+    int32_t counter;                    // mCounterRadio when published
+    radio::RadioCallbacks *next;        // on CallbacksSlot::retired
+};
+
+/**
+ * A slot's published RadioCallbacks, guarded in the style of sleepable RCU.
+ * A reader counts itself in the current phase, loads "current" and drops
+ * its count when done, so it never waits. A replaced set goes on "retired"
+ * and is freed after a grace period: the phase is flipped twice, each time
+ * waiting for the readers counted in the phase just left.
+ */
+typedef struct {
+    std::atomic<radio::RadioCallbacks *> current;
+    std::atomic<uint32_t> phase;
+    alignas(64) std::atomic<uint32_t> readers[2];
+    alignas(64) std::mutex publishMutex;    // mCounterRadio and "retired"
+    std::mutex graceMutex;                  // one grace period at a time
+    radio::RadioCallbacks *retired;
+} CallbacksSlot;
+
+static CallbacksSlot callbacksSlots[SIM_COUNT];
+
+// What the response functions see while no client is registered
+static radio::RadioCallbacks noCallbacks;
+
+// Per slot, the set seen by this thread's innermost CallbacksReader
+static thread_local const radio::RadioCallbacks *t_callbacks[SIM_COUNT];
+
+radio::CallbacksReader::CallbacksReader(int slotId) : mSlotId(slotId) {
+    CallbacksSlot *slot = &callbacksSlots[slotId];
+    mPhase = slot->phase.load() & 1;
+    slot->readers[mPhase].fetch_add(1);
+
+    mOuter = t_callbacks[slotId];
+    const RadioCallbacks *callbacks = slot->current.load();
+    t_callbacks[slotId] = (callbacks != NULL) ? callbacks : &noCallbacks;
+}
+
+radio::CallbacksReader::~CallbacksReader() {
+    t_callbacks[mSlotId] = mOuter;
+    callbacksSlots[mSlotId].readers[mPhase].fetch_sub(1, std::memory_order_release);
+}
+
+/* slotId's callbacks, as seen by the enclosing CallbacksReader */
+static const radio::RadioCallbacks *radioCallbacks(int slotId) {
+    const radio::RadioCallbacks *callbacks = t_callbacks[slotId];
+    return (callbacks != NULL) ? callbacks : &noCallbacks;
+}
+
+/**
+ * Replaces slotId's callbacks with "callbacks", or with none if NULL, and
+ * bumps mCounterRadio. The old set is retired, not freed: readers may still
+ * be using it. Caller holds the slot's publishMutex.
+ */
+static void publishCallbacksLocked(int slotId, radio::RadioCallbacks *callbacks) {
+    CallbacksSlot *slot = &callbacksSlots[slotId];
+
+    mCounterRadio[slotId]++;
+    if (callbacks != NULL) {
+        callbacks->counter = mCounterRadio[slotId];
+    }
+
+    radio::RadioCallbacks *old = slot->current.exchange(callbacks);
+    if (old != NULL) {
+        old->next = slot->retired;
+        slot->retired = old;
+    }
+}
+
+/* Frees slotId's retired callbacks once no reader can still see them */
+static void reclaimCallbacks(int slotId) {
+    CallbacksSlot *slot = &callbacksSlots[slotId];
+
+    if (t_callbacks[slotId] != NULL) {
+        // this thread is a reader itself; leave them to the next writer
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(slot->publishMutex);
+    radio::RadioCallbacks *retired = slot->retired;
+    slot->retired = NULL;
+    lock.unlock();
+
+    if (retired == NULL) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> graceLock(slot->graceMutex);
+        for (int i = 0; i < 2; i++) {
+            uint32_t oldPhase = slot->phase.fetch_add(1) & 1;
+            while (slot->readers[oldPhase].load() != 0) {
+                usleep(100);
+            }
+        }
+    }
+
+    while (retired != NULL) {
+        radio::RadioCallbacks *next = retired->next;
+        delete retired;
+        retired = next;
+    }
+}
+
+/**
+ * A conversion target kept between calls, so the converters can reuse its
+ * vectors and strings instead of building them again. Responses and
+ * indications for a slot can come from any thread: hold "mutex" for as
+ * long as "vec" is in use.
+ */
+template <typename T>
+struct ScratchVec {
+    std::mutex mutex;
+    hidl_vec<T> vec;
+};
+
+// Per slot; the periodic indications have their own so they never wait on a response
+struct ConversionScratch {
+    ScratchVec<Call> currentCalls;
+    ScratchVec<SetupDataCallResult> dataCallList;
+    ScratchVec<SetupDataCallResult> dataCallListInd;
+    ScratchVec<CellInfo> cellInfoList;
+    ScratchVec<CellInfo> cellInfoListInd;
+    ScratchVec<HardwareConfig> hardwareConfig;
+    ScratchVec<HardwareConfig> hardwareConfigInd;
+};
+
+static ConversionScratch conversionScratch[SIM_COUNT];
+
 void convertRilHardwareConfigListToHal(void *response, size_t responseLen,
         hidl_vec<HardwareConfig>& records);
 
@@ -109,10 +305,6 @@ void convertRilCellInfoListToHal(void *response, size_t responseLen, hidl_vec<Ce
 
 struct RadioImpl : public V1_1::IRadio {
     int32_t mSlotId;
-    sp<IRadioResponse> mRadioResponse;
-    sp<IRadioIndication> mRadioIndication;
-    sp<V1_1::IRadioResponse> mRadioResponseV1_1;
-    sp<V1_1::IRadioIndication> mRadioIndicationV1_1;
 
     Return<void> setResponseFunctions(
             const ::android::sp<IRadioResponse>& radioResponse,
@@ -448,6 +640,8 @@ struct RadioImpl : public V1_1::IRadio {
     Return<void> setCarrierInfoForImsiEncryption(int32_t serial,
             const V1_1::ImsiEncryptionInfo& message);
 
+    Return<void> debug(const hidl_handle& fd, const hidl_vec<hidl_string>& options);
+
     void checkReturnStatus(Return<void>& ret);
 };
 
@@ -468,6 +662,7 @@ void memsetAndFreeStrings(int numPointers, ...) {
 }
 
 void sendErrorResponse(RequestInfo *pRI, RIL_Errno err) {
+    radio::CallbacksReader reader((int) pRI->socket_id);
     pRI->pCI->responseFunction((int) pRI->socket_id,
             (int) RadioResponseType::SOLICITED, pRI->token, err, NULL, 0);
 }
@@ -518,6 +713,117 @@ hidl_string convertCharPtrToHidlString(const char *ptr) {
     return ret;
 }
 
+/**
+ * hidl_vec::resize() allocates a new buffer even for the same size, so
+ * reused vectors are only resized when the size really changes
+ */
+template <typename T>
+static void resizeHidlVec(hidl_vec<T>& vec, size_t size) {
+    if (vec.size() != size) {
+        vec.resize(size);
+    }
+}
+
+/* Sets str to ptr like convertCharPtrToHidlString(), copying only if the text changed */
+static void setHidlString(hidl_string& str, const char *ptr) {
+    if (ptr == NULL) {
+        ptr = "";
+    }
+    if (strcmp(str.c_str(), ptr) != 0) {
+        str = ptr;
+    }
+}
+
+#define REQUEST_ARENA_STACK_SIZE 256
+
+/**
+ * Scratch memory for the arguments of one request: a buffer on the stack,
+ * or one heap block when the request needs more. Everything handed out is
+ * wiped when the arena goes out of scope, so PINs and passwords do not
+ * outlive the onRequest() call.
+ */
+class RequestArena {
+  public:
+    RequestArena() : mBuffer(mStack), mSize(sizeof(mStack)), mUsed(0) {}
+
+    ~RequestArena() {
+        memset(mBuffer, 0, mUsed);
+        // the buffer is dead after this; keep the compiler from dropping the memset
+        __asm__ __volatile__("" : : "r"(mBuffer) : "memory");
+        if (mBuffer != mStack) {
+            free(mBuffer);
+        }
+    }
+
+    /* Makes room for size bytes; call once, before the first alloc() */
+    bool reserve(size_t size) {
+        if (size <= mSize) {
+            return true;
+        }
+        char *buffer = (char *) malloc(size);
+        if (buffer == NULL) {
+            return false;
+        }
+        mBuffer = buffer;
+        mSize = size;
+        return true;
+    }
+
+    /* Returns size bytes out of the reserved space */
+    void *alloc(size_t size) {
+        void *ptr = mBuffer + mUsed;
+        mUsed += align(size);
+        return ptr;
+    }
+
+    /* The space alloc() takes for size bytes */
+    static size_t align(size_t size) {
+        return (size + alignof(char *) - 1) & ~(alignof(char *) - 1);
+    }
+
+  private:
+    alignas(char *) char mStack[REQUEST_ARENA_STACK_SIZE];
+    char *mBuffer;
+    size_t mSize;
+    size_t mUsed;
+};
+
+static bool reserveArena(RequestArena& arena, size_t size, RequestInfo *pRI) {
+    if (!arena.reserve(size)) {
+        RLOGE("Memory allocation failed for request %s", requestToString(pRI->pCI->requestNumber));
+        sendErrorResponse(pRI, RIL_E_NO_MEMORY);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Copies the len bytes at src into arena, with the same rules and errors as
+ * copyHidlStringToRil(). The arena must have room for
+ * RequestArena::align(len + 1) bytes.
+ *
+ * Returns true on success, and false on failure.
+ */
+static bool copyStringToArena(char **dest, const char *src, size_t len, RequestArena& arena,
+        RequestInfo *pRI, bool allowEmpty) {
+    if (len == 0 && !allowEmpty) {
+        *dest = NULL;
+        return true;
+    }
+    size_t textLen = strnlen(src, len + 1);
+    if (textLen > len) {
+        RLOGE("Copy of the HIDL string has been truncated, as "
+              "the string length reported by size() does not "
+              "match the length of string returned by c_str().");
+        sendErrorResponse(pRI, RIL_E_INTERNAL_ERR);
+        return false;
+    }
+    *dest = (char *) arena.alloc(len + 1);
+    memcpy(*dest, src, textLen);
+    (*dest)[textLen] = '\0';
+    return true;
+}
+
 bool dispatchVoid(int serial, int slotId, int request) {
     RequestInfo *pRI = android::addRequestToList(serial, slotId, request);
     if (pRI == NULL) {
@@ -533,57 +839,53 @@ bool dispatchString(int serial, int slotId, int request, const char * str) {
         return false;
     }
 
+    size_t len = strlen(str);
+    RequestArena arena;
     char *pString;
-    if (!copyHidlStringToRil(&pString, str, pRI)) {
+    if (!reserveArena(arena, RequestArena::align(len + 1), pRI)
+            || !copyStringToArena(&pString, str, len, arena, pRI, false)) {
         return false;
     }
 
     CALL_ONREQUEST(request, pString, sizeof(char *), pRI, slotId);
-
-    memsetAndFreeStrings(1, pString);
     return true;
 }
 
-bool dispatchStrings(int serial, int slotId, int request, bool allowEmpty, int countStrings, ...) {
+/**
+ * Sends request with the given C strings as a char *[]. The array and the
+ * string copies live on the stack for the length of the onRequest() call.
+ */
+template <typename... Strings>
+bool dispatchStrings(int serial, int slotId, int request, bool allowEmpty,
+        const Strings&... strings) {
+    constexpr size_t countStrings = sizeof...(strings);
+    static_assert(countStrings > 0, "dispatchStrings() needs at least one string");
+
     RequestInfo *pRI = android::addRequestToList(serial, slotId, request);
     if (pRI == NULL) {
         return false;
     }
 
-    char **pStrings;
-    pStrings = (char **)calloc(countStrings, sizeof(char *));
-    if (pStrings == NULL) {
-        RLOGE("Memory allocation failed for request %s", requestToString(request));
-        sendErrorResponse(pRI, RIL_E_NO_MEMORY);
+    const char *src[countStrings] = { strings... };
+    size_t len[countStrings];
+    size_t size = 0;
+    for (size_t i = 0; i < countStrings; i++) {
+        len[i] = strlen(src[i]);
+        size += RequestArena::align(len[i] + 1);
+    }
+
+    RequestArena arena;
+    if (!reserveArena(arena, size, pRI)) {
         return false;
     }
-    va_list ap;
-    va_start(ap, countStrings);
-    for (int i = 0; i < countStrings; i++) {
-        const char* str = va_arg(ap, const char *);
-        if (!copyHidlStringToRil(&pStrings[i], hidl_string(str), pRI, allowEmpty)) {
-            va_end(ap);
-            for (int j = 0; j < i; j++) {
-                memsetAndFreeStrings(1, pStrings[j]);
-            }
-            free(pStrings);
+    char *pStrings[countStrings];
+    for (size_t i = 0; i < countStrings; i++) {
+        if (!copyStringToArena(&pStrings[i], src[i], len[i], arena, pRI, allowEmpty)) {
             return false;
         }
     }
-    va_end(ap);
-
-    CALL_ONREQUEST(request, pStrings, countStrings * sizeof(char *), pRI, slotId);
 
-    if (pStrings != NULL) {
-        for (int i = 0 ; i < countStrings ; i++) {
-            memsetAndFreeStrings(1, pStrings[i]);
-        }
-
-#ifdef MEMSET_FREED
-        memset(pStrings, 0, countStrings * sizeof(char *));
-#endif
-        free(pStrings);
-    }
+    CALL_ONREQUEST(request, pStrings, sizeof(pStrings), pRI, slotId);
     return true;
 }
 
@@ -593,68 +895,41 @@ bool dispatchStrings(int serial, int slotId, int request, const hidl_vec<hidl_st
         return false;
     }
 
-    int countStrings = data.size();
-    char **pStrings;
-    pStrings = (char **)calloc(countStrings, sizeof(char *));
-    if (pStrings == NULL) {
-        RLOGE("Memory allocation failed for request %s", requestToString(request));
-        sendErrorResponse(pRI, RIL_E_NO_MEMORY);
-        return false;
+    size_t countStrings = data.size();
+    size_t size = RequestArena::align(countStrings * sizeof(char *));
+    for (size_t i = 0; i < countStrings; i++) {
+        size += RequestArena::align(data[i].size() + 1);
     }
 
-    for (int i = 0; i < countStrings; i++) {
-        if (!copyHidlStringToRil(&pStrings[i], data[i], pRI)) {
-            for (int j = 0; j < i; j++) {
-                memsetAndFreeStrings(1, pStrings[j]);
-            }
-            free(pStrings);
+    RequestArena arena;
+    if (!reserveArena(arena, size, pRI)) {
+        return false;
+    }
+    char **pStrings = (char **) arena.alloc(countStrings * sizeof(char *));
+    for (size_t i = 0; i < countStrings; i++) {
+        if (!copyStringToArena(&pStrings[i], data[i].c_str(), data[i].size(), arena, pRI,
+                false)) {
             return false;
         }
     }
 
     CALL_ONREQUEST(request, pStrings, countStrings * sizeof(char *), pRI, slotId);
-
-    if (pStrings != NULL) {
-        for (int i = 0 ; i < countStrings ; i++) {
-            memsetAndFreeStrings(1, pStrings[i]);
-        }
-
-#ifdef MEMSET_FREED
-        memset(pStrings, 0, countStrings * sizeof(char *));
-#endif
-        free(pStrings);
-    }
     return true;
 }
 
-bool dispatchInts(int serial, int slotId, int request, int countInts, ...) {
+/* Sends request with the given values as an int[] on the stack */
+template <typename... Ints>
+bool dispatchInts(int serial, int slotId, int request, Ints... ints) {
+    static_assert(sizeof...(ints) > 0, "dispatchInts() needs at least one int");
+
     RequestInfo *pRI = android::addRequestToList(serial, slotId, request);
     if (pRI == NULL) {
         return false;
     }
 
-    int *pInts = (int *)calloc(countInts, sizeof(int));
+    int pInts[] = { static_cast<int>(ints)... };
 
-    if (pInts == NULL) {
-        RLOGE("Memory allocation failed for request %s", requestToString(request));
-        sendErrorResponse(pRI, RIL_E_NO_MEMORY);
-        return false;
-    }
-    va_list ap;
-    va_start(ap, countInts);
-    for (int i = 0; i < countInts; i++) {
-        pInts[i] = va_arg(ap, int);
-    }
-    va_end(ap);
-
-    CALL_ONREQUEST(request, pInts, countInts * sizeof(int), pRI, slotId);
-
-    if (pInts != NULL) {
-#ifdef MEMSET_FREED
-        memset(pInts, 0, countInts * sizeof(int));
-#endif
-        free(pInts);
-    }
+    CALL_ONREQUEST(request, pInts, sizeof(pInts), pRI, slotId);
     return true;
 }
 
@@ -672,14 +947,16 @@ bool dispatchCallForwardStatus(int serial, int slotId, int request,
     cf.toa = callInfo.toa;
     cf.timeSeconds = callInfo.timeSeconds;
 
-    if (!copyHidlStringToRil(&cf.number, callInfo.number, pRI)) {
+    size_t len = callInfo.number.size();
+    RequestArena arena;
+    if (!reserveArena(arena, RequestArena::align(len + 1), pRI)
+            || !copyStringToArena(&cf.number, callInfo.number.c_str(), len, arena, pRI,
+                    false)) {
         return false;
     }
 
     CALL_ONREQUEST(request, &cf, sizeof(cf), pRI, slotId);
 
-    memsetAndFreeStrings(1, cf.number);
-
     return true;
 }
 
@@ -711,14 +988,15 @@ bool dispatchIccApdu(int serial, int slotId, int request, const SimApdu& message
     apdu.p2 = message.p2;
     apdu.p3 = message.p3;
 
-    if (!copyHidlStringToRil(&apdu.data, message.data, pRI)) {
+    size_t len = message.data.size();
+    RequestArena arena;
+    if (!reserveArena(arena, RequestArena::align(len + 1), pRI)
+            || !copyStringToArena(&apdu.data, message.data.c_str(), len, arena, pRI, false)) {
         return false;
     }
 
     CALL_ONREQUEST(request, &apdu, sizeof(apdu), pRI, slotId);
 
-    memsetAndFreeStrings(1, apdu.data);
-
     return true;
 }
 
@@ -729,37 +1007,16 @@ void checkReturnStatus(int32_t slotId, Return<void>& ret, bool isRadioService) {
         // there's no other recovery to be done here. When the client process is back up, it will
         // call setResponseFunctions()
 
-        // Caller should already hold rdlock, release that first
-        // note the current counter to avoid overwriting updates made by another thread before
-        // write lock is acquired.
-        int counter = mCounterRadio[slotId];
-        pthread_rwlock_t *radioServiceRwlockPtr = radio::getRadioServiceRwlock(slotId);
-        int ret = pthread_rwlock_unlock(radioServiceRwlockPtr);
-        assert(ret == 0);
-
-        // acquire wrlock
-        ret = pthread_rwlock_wrlock(radioServiceRwlockPtr);
-        assert(ret == 0);
-
-        // make sure the counter value has not changed
-        if (counter == mCounterRadio[slotId]) {
-            radioService[slotId]->mRadioResponse = NULL;
-            radioService[slotId]->mRadioIndication = NULL;
-            radioService[slotId]->mRadioResponseV1_1 = NULL;
-            radioService[slotId]->mRadioIndicationV1_1 = NULL;
-            mCounterRadio[slotId]++;
+        // Caller is inside a CallbacksReader. Only reset the callbacks it was using: if the
+        // counter has moved, another thread updated them since.
+        CallbacksSlot *slot = &callbacksSlots[slotId];
+        std::lock_guard<std::mutex> lock(slot->publishMutex);
+        if (radioCallbacks(slotId)->counter == mCounterRadio[slotId]) {
+            publishCallbacksLocked(slotId, NULL);
         } else {
             RLOGE("checkReturnStatus: not resetting responseFunctions as they likely "
                     "got updated on another thread");
         }
-
-        // release wrlock
-        ret = pthread_rwlock_unlock(radioServiceRwlockPtr);
-        assert(ret == 0);
-
-        // Reacquire rdlock
-        ret = pthread_rwlock_rdlock(radioServiceRwlockPtr);
-        assert(ret == 0);
     }
 }
 
@@ -772,23 +1029,23 @@ Return<void> RadioImpl::setResponseFunctions(
         const ::android::sp<IRadioIndication>& radioIndicationParam) {
     RLOGD("setResponseFunctions");
 
-    pthread_rwlock_t *radioServiceRwlockPtr = radio::getRadioServiceRwlock(mSlotId);
-    int ret = pthread_rwlock_wrlock(radioServiceRwlockPtr);
-    assert(ret == 0);
-
-    mRadioResponse = radioResponseParam;
-    mRadioIndication = radioIndicationParam;
-    mRadioResponseV1_1 = V1_1::IRadioResponse::castFrom(mRadioResponse).withDefault(nullptr);
-    mRadioIndicationV1_1 = V1_1::IRadioIndication::castFrom(mRadioIndication).withDefault(nullptr);
-    if (mRadioResponseV1_1 == nullptr || mRadioIndicationV1_1 == nullptr) {
-        mRadioResponseV1_1 = nullptr;
-        mRadioIndicationV1_1 = nullptr;
+    radio::RadioCallbacks *callbacks = new radio::RadioCallbacks();
+    callbacks->response = radioResponseParam;
+    callbacks->indication = radioIndicationParam;
+    callbacks->responseV1_1 =
+            V1_1::IRadioResponse::castFrom(radioResponseParam).withDefault(nullptr);
+    callbacks->indicationV1_1 =
+            V1_1::IRadioIndication::castFrom(radioIndicationParam).withDefault(nullptr);
+    if (callbacks->responseV1_1 == nullptr || callbacks->indicationV1_1 == nullptr) {
+        callbacks->responseV1_1 = nullptr;
+        callbacks->indicationV1_1 = nullptr;
     }
 
-    mCounterRadio[mSlotId]++;
-
-    ret = pthread_rwlock_unlock(radioServiceRwlockPtr);
-    assert(ret == 0);
+    {
+        std::lock_guard<std::mutex> lock(callbacksSlots[mSlotId].publishMutex);
+        publishCallbacksLocked(mSlotId, callbacks);
+    }
+    reclaimCallbacks(mSlotId);
 
     // client is connected. Send initial indications.
     android::onNewCommandConnect((RIL_SOCKET_ID) mSlotId);
@@ -810,7 +1067,7 @@ Return<void> RadioImpl::supplyIccPinForApp(int32_t serial, const hidl_string& pi
     RLOGD("supplyIccPinForApp: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_ENTER_SIM_PIN, true,
-            2, pin.c_str(), aid.c_str());
+            pin.c_str(), aid.c_str());
     return Void();
 }
 
@@ -820,7 +1077,7 @@ Return<void> RadioImpl::supplyIccPukForApp(int32_t serial, const hidl_string& pu
     RLOGD("supplyIccPukForApp: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_ENTER_SIM_PUK, true,
-            3, puk.c_str(), pin.c_str(), aid.c_str());
+            puk.c_str(), pin.c_str(), aid.c_str());
     return Void();
 }
 
@@ -830,7 +1087,7 @@ Return<void> RadioImpl::supplyIccPin2ForApp(int32_t serial, const hidl_string& p
     RLOGD("supplyIccPin2ForApp: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_ENTER_SIM_PIN2, true,
-            2, pin2.c_str(), aid.c_str());
+            pin2.c_str(), aid.c_str());
     return Void();
 }
 
@@ -840,7 +1097,7 @@ Return<void> RadioImpl::supplyIccPuk2ForApp(int32_t serial, const hidl_string& p
     RLOGD("supplyIccPuk2ForApp: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_ENTER_SIM_PUK2, true,
-            3, puk2.c_str(), pin2.c_str(), aid.c_str());
+            puk2.c_str(), pin2.c_str(), aid.c_str());
     return Void();
 }
 
@@ -850,7 +1107,7 @@ Return<void> RadioImpl::changeIccPinForApp(int32_t serial, const hidl_string& ol
     RLOGD("changeIccPinForApp: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_CHANGE_SIM_PIN, true,
-            3, oldPin.c_str(), newPin.c_str(), aid.c_str());
+            oldPin.c_str(), newPin.c_str(), aid.c_str());
     return Void();
 }
 
@@ -860,7 +1117,7 @@ Return<void> RadioImpl::changeIccPin2ForApp(int32_t serial, const hidl_string& o
     RLOGD("changeIccPin2ForApp: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_CHANGE_SIM_PIN2, true,
-            3, oldPin2.c_str(), newPin2.c_str(), aid.c_str());
+            oldPin2.c_str(), newPin2.c_str(), aid.c_str());
     return Void();
 }
 
@@ -870,7 +1127,7 @@ Return<void> RadioImpl::supplyNetworkDepersonalization(int32_t serial,
     RLOGD("supplyNetworkDepersonalization: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_ENTER_NETWORK_DEPERSONALIZATION, true,
-            1, netPin.c_str());
+            netPin.c_str());
     return Void();
 }
 
@@ -929,7 +1186,7 @@ Return<void> RadioImpl::getImsiForApp(int32_t serial, const hidl_string& aid) {
     RLOGD("getImsiForApp: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_GET_IMSI, false,
-            1, aid.c_str());
+            aid.c_str());
     return Void();
 }
 
@@ -937,7 +1194,7 @@ Return<void> RadioImpl::hangup(int32_t serial, int32_t gsmIndex) {
 #if VDBG
     RLOGD("hangup: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_HANGUP, 1, gsmIndex);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_HANGUP, gsmIndex);
     return Void();
 }
 
@@ -1023,7 +1280,7 @@ Return<void> RadioImpl::getOperator(int32_t serial) {
 
 Return<void> RadioImpl::setRadioPower(int32_t serial, bool on) {
     RLOGD("setRadioPower: serial %d on %d", serial, on);
-    dispatchInts(serial, mSlotId, RIL_REQUEST_RADIO_POWER, 1, BOOL_TO_INT(on));
+    dispatchInts(serial, mSlotId, RIL_REQUEST_RADIO_POWER, BOOL_TO_INT(on));
     return Void();
 }
 
@@ -1040,7 +1297,7 @@ Return<void> RadioImpl::sendSms(int32_t serial, const GsmSmsMessage& message) {
     RLOGD("sendSms: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_SEND_SMS, false,
-            2, message.smscPdu.c_str(), message.pdu.c_str());
+            message.smscPdu.c_str(), message.pdu.c_str());
     return Void();
 }
 
@@ -1049,7 +1306,7 @@ Return<void> RadioImpl::sendSMSExpectMore(int32_t serial, const GsmSmsMessage& m
     RLOGD("sendSMSExpectMore: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_SEND_SMS_EXPECT_MORE, false,
-            2, message.smscPdu.c_str(), message.pdu.c_str());
+            message.smscPdu.c_str(), message.pdu.c_str());
     return Void();
 }
 
@@ -1082,7 +1339,7 @@ Return<void> RadioImpl::setupDataCall(int32_t serial, RadioTechnology radioTechn
     if (s_vendorFunctions->version >= 4 && s_vendorFunctions->version <= 14) {
         const hidl_string &protocol =
                 (isRoaming ? dataProfileInfo.roamingProtocol : dataProfileInfo.protocol);
-        dispatchStrings(serial, mSlotId, RIL_REQUEST_SETUP_DATA_CALL, true, 7,
+        dispatchStrings(serial, mSlotId, RIL_REQUEST_SETUP_DATA_CALL, true,
             std::to_string((int) radioTechnology + 2).c_str(),
             std::to_string((int) dataProfileInfo.profileId).c_str(),
             dataProfileInfo.apn.c_str(),
@@ -1100,7 +1357,7 @@ Return<void> RadioImpl::setupDataCall(int32_t serial, RadioTechnology radioTechn
             }
             return Void();
         }
-        dispatchStrings(serial, mSlotId, RIL_REQUEST_SETUP_DATA_CALL, true, 15,
+        dispatchStrings(serial, mSlotId, RIL_REQUEST_SETUP_DATA_CALL, true,
             std::to_string((int) radioTechnology + 2).c_str(),
             std::to_string((int) dataProfileInfo.profileId).c_str(),
             dataProfileInfo.apn.c_str(),
@@ -1197,7 +1454,7 @@ Return<void> RadioImpl::setClir(int32_t serial, int32_t status) {
 #if VDBG
     RLOGD("setClir: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_CLIR, 1, status);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_CLIR, status);
     return Void();
 }
 
@@ -1223,7 +1480,7 @@ Return<void> RadioImpl::getCallWaiting(int32_t serial, int32_t serviceClass) {
 #if VDBG
     RLOGD("getCallWaiting: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_QUERY_CALL_WAITING, 1, serviceClass);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_QUERY_CALL_WAITING, serviceClass);
     return Void();
 }
 
@@ -1231,7 +1488,7 @@ Return<void> RadioImpl::setCallWaiting(int32_t serial, bool enable, int32_t serv
 #if VDBG
     RLOGD("setCallWaiting: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_CALL_WAITING, 2, BOOL_TO_INT(enable),
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_CALL_WAITING, BOOL_TO_INT(enable),
             serviceClass);
     return Void();
 }
@@ -1241,7 +1498,7 @@ Return<void> RadioImpl::acknowledgeLastIncomingGsmSms(int32_t serial,
 #if VDBG
     RLOGD("acknowledgeLastIncomingGsmSms: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SMS_ACKNOWLEDGE, 2, BOOL_TO_INT(success),
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SMS_ACKNOWLEDGE, BOOL_TO_INT(success),
             cause);
     return Void();
 }
@@ -1260,7 +1517,7 @@ Return<void> RadioImpl::deactivateDataCall(int32_t serial,
     RLOGD("deactivateDataCall: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_DEACTIVATE_DATA_CALL, false,
-            2, (std::to_string(cid)).c_str(), reasonRadioShutDown ? "1" : "0");
+            (std::to_string(cid)).c_str(), reasonRadioShutDown ? "1" : "0");
     return Void();
 }
 
@@ -1271,7 +1528,7 @@ Return<void> RadioImpl::getFacilityLockForApp(int32_t serial, const hidl_string&
     RLOGD("getFacilityLockForApp: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_QUERY_FACILITY_LOCK, true,
-            4, facility.c_str(), password.c_str(),
+            facility.c_str(), password.c_str(),
             (std::to_string(serviceClass)).c_str(), appId.c_str());
     return Void();
 }
@@ -1283,7 +1540,7 @@ Return<void> RadioImpl::setFacilityLockForApp(int32_t serial, const hidl_string&
     RLOGD("setFacilityLockForApp: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_SET_FACILITY_LOCK, true,
-            5, facility.c_str(), lockState ? "1" : "0", password.c_str(),
+            facility.c_str(), lockState ? "1" : "0", password.c_str(),
             (std::to_string(serviceClass)).c_str(), appId.c_str() );
     return Void();
 }
@@ -1295,7 +1552,7 @@ Return<void> RadioImpl::setBarringPassword(int32_t serial, const hidl_string& fa
     RLOGD("setBarringPassword: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_CHANGE_BARRING_PASSWORD, true,
-            3, facility.c_str(), oldPassword.c_str(), newPassword.c_str());
+            facility.c_str(), oldPassword.c_str(), newPassword.c_str());
     return Void();
 }
 
@@ -1436,7 +1693,7 @@ Return<void> RadioImpl::separateConnection(int32_t serial, int32_t gsmIndex) {
 #if VDBG
     RLOGD("separateConnection: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SEPARATE_CONNECTION, 1, gsmIndex);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SEPARATE_CONNECTION, gsmIndex);
     return Void();
 }
 
@@ -1444,7 +1701,7 @@ Return<void> RadioImpl::setMute(int32_t serial, bool enable) {
 #if VDBG
     RLOGD("setMute: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_MUTE, 1, BOOL_TO_INT(enable));
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_MUTE, BOOL_TO_INT(enable));
     return Void();
 }
 
@@ -1476,8 +1733,7 @@ Return<void> RadioImpl::setSuppServiceNotifications(int32_t serial, bool enable)
 #if VDBG
     RLOGD("setSuppServiceNotifications: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_SUPP_SVC_NOTIFICATION, 1,
-            BOOL_TO_INT(enable));
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_SUPP_SVC_NOTIFICATION, BOOL_TO_INT(enable));
     return Void();
 }
 
@@ -1513,7 +1769,7 @@ Return<void> RadioImpl::deleteSmsOnSim(int32_t serial, int32_t index) {
 #if VDBG
     RLOGD("deleteSmsOnSim: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_DELETE_SMS_ON_SIM, 1, index);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_DELETE_SMS_ON_SIM, index);
     return Void();
 }
 
@@ -1521,7 +1777,7 @@ Return<void> RadioImpl::setBandMode(int32_t serial, RadioBandMode mode) {
 #if VDBG
     RLOGD("setBandMode: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_BAND_MODE, 1, mode);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_BAND_MODE, mode);
     return Void();
 }
 
@@ -1557,7 +1813,7 @@ Return<void> RadioImpl::handleStkCallSetupRequestFromSim(int32_t serial, bool ac
     RLOGD("handleStkCallSetupRequestFromSim: serial %d", serial);
 #endif
     dispatchInts(serial, mSlotId, RIL_REQUEST_STK_HANDLE_CALL_SETUP_REQUESTED_FROM_SIM,
-            1, BOOL_TO_INT(accept));
+            BOOL_TO_INT(accept));
     return Void();
 }
 
@@ -1573,7 +1829,7 @@ Return<void> RadioImpl::setPreferredNetworkType(int32_t serial, PreferredNetwork
 #if VDBG
     RLOGD("setPreferredNetworkType: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_PREFERRED_NETWORK_TYPE, 1, nwType);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_PREFERRED_NETWORK_TYPE, nwType);
     return Void();
 }
 
@@ -1597,7 +1853,7 @@ Return<void> RadioImpl::setLocationUpdates(int32_t serial, bool enable) {
 #if VDBG
     RLOGD("setLocationUpdates: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_LOCATION_UPDATES, 1, BOOL_TO_INT(enable));
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_LOCATION_UPDATES, BOOL_TO_INT(enable));
     return Void();
 }
 
@@ -1605,7 +1861,7 @@ Return<void> RadioImpl::setCdmaSubscriptionSource(int32_t serial, CdmaSubscripti
 #if VDBG
     RLOGD("setCdmaSubscriptionSource: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_CDMA_SET_SUBSCRIPTION_SOURCE, 1, cdmaSub);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_CDMA_SET_SUBSCRIPTION_SOURCE, cdmaSub);
     return Void();
 }
 
@@ -1613,7 +1869,7 @@ Return<void> RadioImpl::setCdmaRoamingPreference(int32_t serial, CdmaRoamingType
 #if VDBG
     RLOGD("setCdmaRoamingPreference: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_CDMA_SET_ROAMING_PREFERENCE, 1, type);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_CDMA_SET_ROAMING_PREFERENCE, type);
     return Void();
 }
 
@@ -1629,7 +1885,7 @@ Return<void> RadioImpl::setTTYMode(int32_t serial, TtyMode mode) {
 #if VDBG
     RLOGD("setTTYMode: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_TTY_MODE, 1, mode);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_TTY_MODE, mode);
     return Void();
 }
 
@@ -1646,7 +1902,7 @@ Return<void> RadioImpl::setPreferredVoicePrivacy(int32_t serial, bool enable) {
     RLOGD("setPreferredVoicePrivacy: serial %d", serial);
 #endif
     dispatchInts(serial, mSlotId, RIL_REQUEST_CDMA_SET_PREFERRED_VOICE_PRIVACY_MODE,
-            1, BOOL_TO_INT(enable));
+            BOOL_TO_INT(enable));
     return Void();
 }
 
@@ -1673,7 +1929,7 @@ Return<void> RadioImpl::sendBurstDtmf(int32_t serial, const hidl_string& dtmf, i
     RLOGD("sendBurstDtmf: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_CDMA_BURST_DTMF, false,
-            3, dtmf.c_str(), (std::to_string(on)).c_str(),
+            dtmf.c_str(), (std::to_string(on)).c_str(),
             (std::to_string(off)).c_str());
     return Void();
 }
@@ -1798,7 +2054,7 @@ Return<void> RadioImpl::setGsmBroadcastActivation(int32_t serial, bool activate)
     RLOGD("setGsmBroadcastActivation: serial %d", serial);
 #endif
     dispatchInts(serial, mSlotId, RIL_REQUEST_GSM_SMS_BROADCAST_ACTIVATION,
-            1, BOOL_TO_INT(!activate));
+            BOOL_TO_INT(!activate));
     return Void();
 }
 
@@ -1854,7 +2110,7 @@ Return<void> RadioImpl::setCdmaBroadcastActivation(int32_t serial, bool activate
     RLOGD("setCdmaBroadcastActivation: serial %d", serial);
 #endif
     dispatchInts(serial, mSlotId, RIL_REQUEST_CDMA_SMS_BROADCAST_ACTIVATION,
-            1, BOOL_TO_INT(!activate));
+            BOOL_TO_INT(!activate));
     return Void();
 }
 
@@ -1888,7 +2144,7 @@ Return<void> RadioImpl::deleteSmsOnRuim(int32_t serial, int32_t index) {
 #if VDBG
     RLOGD("deleteSmsOnRuim: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_CDMA_DELETE_SMS_ON_RUIM, 1, index);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_CDMA_DELETE_SMS_ON_RUIM, index);
     return Void();
 }
 
@@ -1929,8 +2185,7 @@ Return<void> RadioImpl::reportSmsMemoryStatus(int32_t serial, bool available) {
 #if VDBG
     RLOGD("reportSmsMemoryStatus: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_REPORT_SMS_MEMORY_STATUS, 1,
-            BOOL_TO_INT(available));
+    dispatchInts(serial, mSlotId, RIL_REQUEST_REPORT_SMS_MEMORY_STATUS, BOOL_TO_INT(available));
     return Void();
 }
 
@@ -1965,7 +2220,7 @@ Return<void> RadioImpl::acknowledgeIncomingGsmSmsWithPdu(int32_t serial, bool su
     RLOGD("acknowledgeIncomingGsmSmsWithPdu: serial %d", serial);
 #endif
     dispatchStrings(serial, mSlotId, RIL_REQUEST_ACKNOWLEDGE_INCOMING_GSM_SMS_WITH_PDU, false,
-            2, success ? "1" : "0", ackPdu.c_str());
+            success ? "1" : "0", ackPdu.c_str());
     return Void();
 }
 
@@ -1998,7 +2253,7 @@ Return<void> RadioImpl::setCellInfoListRate(int32_t serial, int32_t rate) {
 #if VDBG
     RLOGD("setCellInfoListRate: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_UNSOL_CELL_INFO_LIST_RATE, 1, rate);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_UNSOL_CELL_INFO_LIST_RATE, rate);
     return Void();
 }
 
@@ -2248,7 +2503,7 @@ Return<void> RadioImpl::iccCloseLogicalChannel(int32_t serial, int32_t channelId
 #if VDBG
     RLOGD("iccCloseLogicalChannel: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SIM_CLOSE_CHANNEL, 1, channelId);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SIM_CLOSE_CHANNEL, channelId);
     return Void();
 }
 
@@ -2329,7 +2584,7 @@ Return<void> RadioImpl::nvResetConfig(int32_t serial, ResetNvType resetType) {
         rilResetType = 3;
         break;
     }
-    dispatchInts(serial, mSlotId, RIL_REQUEST_NV_RESET_CONFIG, 1, rilResetType);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_NV_RESET_CONFIG, rilResetType);
     return Void();
 }
 
@@ -2358,7 +2613,7 @@ Return<void> RadioImpl::setDataAllowed(int32_t serial, bool allow) {
 #if VDBG
     RLOGD("setDataAllowed: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_ALLOW_DATA, 1, BOOL_TO_INT(allow));
+    dispatchInts(serial, mSlotId, RIL_REQUEST_ALLOW_DATA, BOOL_TO_INT(allow));
     return Void();
 }
 
@@ -2638,7 +2893,7 @@ Return<void> RadioImpl::startLceService(int32_t serial, int32_t reportInterval,
 #if VDBG
     RLOGD("startLceService: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_START_LCE, 2, reportInterval,
+    dispatchInts(serial, mSlotId, RIL_REQUEST_START_LCE, reportInterval,
             BOOL_TO_INT(pullMode));
     return Void();
 }
@@ -2748,7 +3003,7 @@ Return<void> RadioImpl::sendDeviceState(int32_t serial, DeviceStateType deviceSt
     if (s_vendorFunctions->version < 15) {
         if (deviceStateType ==  DeviceStateType::LOW_DATA_EXPECTED) {
             RLOGD("sendDeviceState: calling screen state %d", BOOL_TO_INT(!state));
-            dispatchInts(serial, mSlotId, RIL_REQUEST_SCREEN_STATE, 1, BOOL_TO_INT(!state));
+            dispatchInts(serial, mSlotId, RIL_REQUEST_SCREEN_STATE, BOOL_TO_INT(!state));
         } else {
             RequestInfo *pRI = android::addRequestToList(serial, mSlotId,
                     RIL_REQUEST_SEND_DEVICE_STATE);
@@ -2756,7 +3011,7 @@ Return<void> RadioImpl::sendDeviceState(int32_t serial, DeviceStateType deviceSt
         }
         return Void();
     }
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SEND_DEVICE_STATE, 2, (int) deviceStateType,
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SEND_DEVICE_STATE, (int) deviceStateType,
             BOOL_TO_INT(state));
     return Void();
 }
@@ -2771,7 +3026,7 @@ Return<void> RadioImpl::setIndicationFilter(int32_t serial, int32_t indicationFi
         sendErrorResponse(pRI, RIL_E_REQUEST_NOT_SUPPORTED);
         return Void();
     }
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_UNSOLICITED_RESPONSE_FILTER, 1, indicationFilter);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_UNSOLICITED_RESPONSE_FILTER, indicationFilter);
     return Void();
 }
 
@@ -2779,7 +3034,7 @@ Return<void> RadioImpl::setSimCardPower(int32_t serial, bool powerUp) {
 #if VDBG
     RLOGD("setSimCardPower: serial %d", serial);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_SIM_CARD_POWER, 1, BOOL_TO_INT(powerUp));
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_SIM_CARD_POWER, BOOL_TO_INT(powerUp));
     return Void();
 }
 
@@ -2787,7 +3042,7 @@ Return<void> RadioImpl::setSimCardPower_1_1(int32_t serial, const V1_1::CardPowe
 #if VDBG
     RLOGD("setSimCardPower_1_1: serial %d state %d", serial, state);
 #endif
-    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_SIM_CARD_POWER, 1, state);
+    dispatchInts(serial, mSlotId, RIL_REQUEST_SET_SIM_CARD_POWER, state);
     return Void();
 }
 
@@ -2892,6 +3147,16 @@ Return<void> RadioImpl::responseAcknowledgement() {
     return Void();
 }
 
+// Backs "lshal debug android.hardware.radio@1.1::IRadio/slotN"
+Return<void> RadioImpl::debug(const hidl_handle& fd, const hidl_vec<hidl_string>& /*options*/) {
+    if (fd.getNativeHandle() == NULL || fd->numFds < 1) {
+        RLOGE("debug: invalid file descriptor");
+        return Void();
+    }
+    android::statsDump(fd->data[0]);
+    return Void();
+}
+
 /***************************************************************************************************
  * RESPONSE FUNCTIONS
  * Functions above are used for requests going from framework to vendor code. The ones below are
@@ -2899,8 +3164,8 @@ Return<void> RadioImpl::responseAcknowledgement() {
  **************************************************************************************************/
 
 void radio::acknowledgeRequest(int slotId, int serial) {
-    if (radioService[slotId]->mRadioResponse != NULL) {
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->acknowledgeRequest(serial);
+    if (radioCallbacks(slotId)->response != NULL) {
+        Return<void> retStatus = radioCallbacks(slotId)->response->acknowledgeRequest(serial);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("acknowledgeRequest: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -2958,7 +3223,7 @@ int responseInt(RadioResponseInfo& responseInfo, int serial, int responseType, R
 int radio::getIccCardStatusResponse(int slotId,
                                    int responseType, int serial, RIL_Errno e,
                                    void *response, size_t responseLen) {
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         CardStatus cardStatus = {CardState::ABSENT, PinState::UNKNOWN, -1, -1, -1, {}};
@@ -2995,7 +3260,7 @@ int radio::getIccCardStatusResponse(int slotId,
             }
         }
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->
+        Return<void> retStatus = radioCallbacks(slotId)->response->
                 getIccCardStatusResponse(responseInfo, cardStatus);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3012,10 +3277,10 @@ int radio::supplyIccPinForAppResponse(int slotId,
     RLOGD("supplyIccPinForAppResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseIntOrEmpty(responseInfo, serial, responseType, e, response, responseLen);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->
+        Return<void> retStatus = radioCallbacks(slotId)->response->
                 supplyIccPinForAppResponse(responseInfo, ret);
         RLOGE("supplyIccPinForAppResponse: amit ret %d", ret);
         radioService[slotId]->checkReturnStatus(retStatus);
@@ -3034,10 +3299,10 @@ int radio::supplyIccPukForAppResponse(int slotId,
     RLOGD("supplyIccPukForAppResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseIntOrEmpty(responseInfo, serial, responseType, e, response, responseLen);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->supplyIccPukForAppResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->supplyIccPukForAppResponse(
                 responseInfo, ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3055,10 +3320,10 @@ int radio::supplyIccPin2ForAppResponse(int slotId,
     RLOGD("supplyIccPin2ForAppResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseIntOrEmpty(responseInfo, serial, responseType, e, response, responseLen);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->
+        Return<void> retStatus = radioCallbacks(slotId)->response->
                 supplyIccPin2ForAppResponse(responseInfo, ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3076,10 +3341,10 @@ int radio::supplyIccPuk2ForAppResponse(int slotId,
     RLOGD("supplyIccPuk2ForAppResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseIntOrEmpty(responseInfo, serial, responseType, e, response, responseLen);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->
+        Return<void> retStatus = radioCallbacks(slotId)->response->
                 supplyIccPuk2ForAppResponse(responseInfo, ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3097,10 +3362,10 @@ int radio::changeIccPinForAppResponse(int slotId,
     RLOGD("changeIccPinForAppResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseIntOrEmpty(responseInfo, serial, responseType, e, response, responseLen);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->
+        Return<void> retStatus = radioCallbacks(slotId)->response->
                 changeIccPinForAppResponse(responseInfo, ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3118,10 +3383,10 @@ int radio::changeIccPin2ForAppResponse(int slotId,
     RLOGD("changeIccPin2ForAppResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseIntOrEmpty(responseInfo, serial, responseType, e, response, responseLen);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->
+        Return<void> retStatus = radioCallbacks(slotId)->response->
                 changeIccPin2ForAppResponse(responseInfo, ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3139,10 +3404,10 @@ int radio::supplyNetworkDepersonalizationResponse(int slotId,
     RLOGD("supplyNetworkDepersonalizationResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseIntOrEmpty(responseInfo, serial, responseType, e, response, responseLen);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->
+        Return<void> retStatus = radioCallbacks(slotId)->response->
                 supplyNetworkDepersonalizationResponse(responseInfo, ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3160,18 +3425,21 @@ int radio::getCurrentCallsResponse(int slotId,
     RLOGD("getCurrentCallsResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
 
-        hidl_vec<Call> calls;
+        ScratchVec<Call>& scratch = conversionScratch[slotId].currentCalls;
+        std::lock_guard<std::mutex> lock(scratch.mutex);
+        hidl_vec<Call>& calls = scratch.vec;
         if ((response == NULL && responseLen != 0)
                 || (responseLen % sizeof(RIL_Call *)) != 0) {
             RLOGE("getCurrentCallsResponse: Invalid response");
             if (e == RIL_E_SUCCESS) responseInfo.error = RadioError::INVALID_RESPONSE;
+            resizeHidlVec(calls, 0);
         } else {
             int num = responseLen / sizeof(RIL_Call *);
-            calls.resize(num);
+            resizeHidlVec(calls, num);
 
             for (int i = 0 ; i < num ; i++) {
                 RIL_Call *p_cur = ((RIL_Call **) response)[i];
@@ -3184,24 +3452,26 @@ int radio::getCurrentCallsResponse(int slotId,
                 calls[i].als = p_cur->als;
                 calls[i].isVoice = p_cur->isVoice;
                 calls[i].isVoicePrivacy = p_cur->isVoicePrivacy;
-                calls[i].number = convertCharPtrToHidlString(p_cur->number);
+                setHidlString(calls[i].number, p_cur->number);
                 calls[i].numberPresentation = (CallPresentation) p_cur->numberPresentation;
-                calls[i].name = convertCharPtrToHidlString(p_cur->name);
+                setHidlString(calls[i].name, p_cur->name);
                 calls[i].namePresentation = (CallPresentation) p_cur->namePresentation;
                 if (p_cur->uusInfo != NULL && p_cur->uusInfo->uusData != NULL) {
                     RIL_UUS_Info *uusInfo = p_cur->uusInfo;
-                    calls[i].uusInfo.resize(1);
+                    resizeHidlVec(calls[i].uusInfo, 1);
                     calls[i].uusInfo[0].uusType = (UusType) uusInfo->uusType;
                     calls[i].uusInfo[0].uusDcs = (UusDcs) uusInfo->uusDcs;
                     // convert uusInfo->uusData to a null-terminated string
                     char *nullTermStr = strndup(uusInfo->uusData, uusInfo->uusLength);
                     calls[i].uusInfo[0].uusData = nullTermStr;
                     free(nullTermStr);
+                } else {
+                    resizeHidlVec(calls[i].uusInfo, 0);
                 }
             }
         }
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->
+        Return<void> retStatus = radioCallbacks(slotId)->response->
                 getCurrentCallsResponse(responseInfo, calls);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3218,10 +3488,10 @@ int radio::dialResponse(int slotId,
     RLOGD("dialResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->dialResponse(responseInfo);
+        Return<void> retStatus = radioCallbacks(slotId)->response->dialResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("dialResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -3237,10 +3507,10 @@ int radio::getIMSIForAppResponse(int slotId,
     RLOGD("getIMSIForAppResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getIMSIForAppResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->getIMSIForAppResponse(
                 responseInfo, convertCharPtrToHidlString((char *) response));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3258,10 +3528,10 @@ int radio::hangupConnectionResponse(int slotId,
     RLOGD("hangupConnectionResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->hangupConnectionResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->hangupConnectionResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3279,11 +3549,11 @@ int radio::hangupWaitingOrBackgroundResponse(int slotId,
     RLOGD("hangupWaitingOrBackgroundResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus =
-                radioService[slotId]->mRadioResponse->hangupWaitingOrBackgroundResponse(
+                radioCallbacks(slotId)->response->hangupWaitingOrBackgroundResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3301,11 +3571,11 @@ int radio::hangupForegroundResumeBackgroundResponse(int slotId, int responseType
     RLOGD("hangupWaitingOrBackgroundResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus =
-                radioService[slotId]->mRadioResponse->hangupWaitingOrBackgroundResponse(
+                radioCallbacks(slotId)->response->hangupWaitingOrBackgroundResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3323,11 +3593,11 @@ int radio::switchWaitingOrHoldingAndActiveResponse(int slotId, int responseType,
     RLOGD("switchWaitingOrHoldingAndActiveResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus =
-                radioService[slotId]->mRadioResponse->switchWaitingOrHoldingAndActiveResponse(
+                radioCallbacks(slotId)->response->switchWaitingOrHoldingAndActiveResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3344,10 +3614,10 @@ int radio::conferenceResponse(int slotId, int responseType,
     RLOGD("conferenceResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->conferenceResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->conferenceResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3364,10 +3634,10 @@ int radio::rejectCallResponse(int slotId, int responseType,
     RLOGD("rejectCallResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->rejectCallResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->rejectCallResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3385,7 +3655,7 @@ int radio::getLastCallFailCauseResponse(int slotId,
     RLOGD("getLastCallFailCauseResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
 
@@ -3406,7 +3676,7 @@ int radio::getLastCallFailCauseResponse(int slotId,
             if (e == RIL_E_SUCCESS) responseInfo.error = RadioError::INVALID_RESPONSE;
         }
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getLastCallFailCauseResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->getLastCallFailCauseResponse(
                 responseInfo, info);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3424,7 +3694,7 @@ int radio::getSignalStrengthResponse(int slotId,
     RLOGD("getSignalStrengthResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         SignalStrength signalStrength = {};
@@ -3435,7 +3705,7 @@ int radio::getSignalStrengthResponse(int slotId,
             convertRilSignalStrengthToHal(response, responseLen, signalStrength);
         }
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getSignalStrengthResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->getSignalStrengthResponse(
                 responseInfo, signalStrength);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3510,9 +3780,9 @@ void fillCellIdentityResponse(CellIdentity &cellIdentity, RIL_CellIdentity_v16 &
         case RIL_CELL_INFO_TYPE_GSM: {
             cellIdentity.cellIdentityGsm.resize(1);
             cellIdentity.cellIdentityGsm[0].mcc =
-                    ril::util::mcc::decode(rilCellIdentity.cellIdentityGsm.mcc);
+                    ril::util::mcc::decodeStr(rilCellIdentity.cellIdentityGsm.mcc);
             cellIdentity.cellIdentityGsm[0].mnc =
-                    ril::util::mnc::decode(rilCellIdentity.cellIdentityGsm.mnc);
+                    ril::util::mnc::decodeStr(rilCellIdentity.cellIdentityGsm.mnc);
 
             if (cellIdentity.cellIdentityGsm[0].mcc == "-1") {
                 cellIdentity.cellIdentityGsm[0].mcc = "";
@@ -3528,9 +3798,9 @@ void fillCellIdentityResponse(CellIdentity &cellIdentity, RIL_CellIdentity_v16 &
         case RIL_CELL_INFO_TYPE_WCDMA: {
             cellIdentity.cellIdentityWcdma.resize(1);
             cellIdentity.cellIdentityWcdma[0].mcc =
-                    ril::util::mcc::decode(rilCellIdentity.cellIdentityWcdma.mcc);
+                    ril::util::mcc::decodeStr(rilCellIdentity.cellIdentityWcdma.mcc);
             cellIdentity.cellIdentityWcdma[0].mnc =
-                    ril::util::mnc::decode(rilCellIdentity.cellIdentityWcdma.mnc);
+                    ril::util::mnc::decodeStr(rilCellIdentity.cellIdentityWcdma.mnc);
 
             if (cellIdentity.cellIdentityWcdma[0].mcc == "-1") {
                 cellIdentity.cellIdentityWcdma[0].mcc = "";
@@ -3557,9 +3827,9 @@ void fillCellIdentityResponse(CellIdentity &cellIdentity, RIL_CellIdentity_v16 &
         case RIL_CELL_INFO_TYPE_LTE: {
             cellIdentity.cellIdentityLte.resize(1);
             cellIdentity.cellIdentityLte[0].mcc =
-                    ril::util::mcc::decode(rilCellIdentity.cellIdentityLte.mcc);
+                    ril::util::mcc::decodeStr(rilCellIdentity.cellIdentityLte.mcc);
             cellIdentity.cellIdentityLte[0].mnc =
-                    ril::util::mnc::decode(rilCellIdentity.cellIdentityLte.mnc);
+                    ril::util::mnc::decodeStr(rilCellIdentity.cellIdentityLte.mnc);
 
             if (cellIdentity.cellIdentityLte[0].mcc == "-1") {
                 cellIdentity.cellIdentityLte[0].mcc = "";
@@ -3575,9 +3845,9 @@ void fillCellIdentityResponse(CellIdentity &cellIdentity, RIL_CellIdentity_v16 &
         case RIL_CELL_INFO_TYPE_TD_SCDMA: {
             cellIdentity.cellIdentityTdscdma.resize(1);
             cellIdentity.cellIdentityTdscdma[0].mcc =
-                    ril::util::mcc::decode(rilCellIdentity.cellIdentityTdscdma.mcc);
+                    ril::util::mcc::decodeStr(rilCellIdentity.cellIdentityTdscdma.mcc);
             cellIdentity.cellIdentityTdscdma[0].mnc =
-                    ril::util::mnc::decode(rilCellIdentity.cellIdentityTdscdma.mnc);
+                    ril::util::mnc::decodeStr(rilCellIdentity.cellIdentityTdscdma.mnc);
 
             if (cellIdentity.cellIdentityTdscdma[0].mcc == "-1") {
                 cellIdentity.cellIdentityTdscdma[0].mcc = "";
@@ -3794,7 +4064,7 @@ int radio::getVoiceRegistrationStateResponse(int slotId,
     RLOGD("getVoiceRegistrationStateResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
 
@@ -3840,7 +4110,7 @@ int radio::getVoiceRegistrationStateResponse(int slotId,
         }
 
         Return<void> retStatus =
-                radioService[slotId]->mRadioResponse->getVoiceRegistrationStateResponse(
+                radioCallbacks(slotId)->response->getVoiceRegistrationStateResponse(
                 responseInfo, voiceRegResponse);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3858,7 +4128,7 @@ int radio::getDataRegistrationStateResponse(int slotId,
     RLOGD("getDataRegistrationStateResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         DataRegStateResult dataRegResponse = {};
@@ -3896,7 +4166,7 @@ int radio::getDataRegistrationStateResponse(int slotId,
         }
 
         Return<void> retStatus =
-                radioService[slotId]->mRadioResponse->getDataRegistrationStateResponse(responseInfo,
+                radioCallbacks(slotId)->response->getDataRegistrationStateResponse(responseInfo,
                 dataRegResponse);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3914,7 +4184,7 @@ int radio::getOperatorResponse(int slotId,
     RLOGD("getOperatorResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         hidl_string longName;
@@ -3931,7 +4201,7 @@ int radio::getOperatorResponse(int slotId,
             shortName = convertCharPtrToHidlString(resp[1]);
             numeric = convertCharPtrToHidlString(resp[2]);
         }
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getOperatorResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->getOperatorResponse(
                 responseInfo, longName, shortName, numeric);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3947,10 +4217,10 @@ int radio::setRadioPowerResponse(int slotId,
                                 size_t responseLen) {
     RLOGD("setRadioPowerResponse: serial %d", serial);
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->setRadioPowerResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->setRadioPowerResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -3968,10 +4238,10 @@ int radio::sendDtmfResponse(int slotId,
     RLOGD("sendDtmfResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->sendDtmfResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->sendDtmfResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4007,12 +4277,12 @@ int radio::sendSmsResponse(int slotId,
     RLOGD("sendSmsResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         SendSmsResult result = makeSendSmsResult(responseInfo, serial, responseType, e, response,
                 responseLen);
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->sendSmsResponse(responseInfo,
+        Return<void> retStatus = radioCallbacks(slotId)->response->sendSmsResponse(responseInfo,
                 result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4029,12 +4299,12 @@ int radio::sendSMSExpectMoreResponse(int slotId,
     RLOGD("sendSMSExpectMoreResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         SendSmsResult result = makeSendSmsResult(responseInfo, serial, responseType, e, response,
                 responseLen);
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->sendSMSExpectMoreResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->sendSMSExpectMoreResponse(
                 responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4051,7 +4321,7 @@ int radio::setupDataCallResponse(int slotId,
     RLOGD("setupDataCallResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
 
@@ -4072,7 +4342,7 @@ int radio::setupDataCallResponse(int slotId,
             convertRilDataCallToHal((RIL_Data_Call_Response_v11 *) response, result);
         }
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->setupDataCallResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->setupDataCallResponse(
                 responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4107,12 +4377,12 @@ int radio::iccIOForAppResponse(int slotId,
     RLOGD("iccIOForAppResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         IccIoResult result = responseIccIo(responseInfo, serial, responseType, e, response,
                 responseLen);
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->iccIOForAppResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->iccIOForAppResponse(
                 responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4129,10 +4399,10 @@ int radio::sendUssdResponse(int slotId,
     RLOGD("sendUssdResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->sendUssdResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->sendUssdResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4150,10 +4420,10 @@ int radio::cancelPendingUssdResponse(int slotId,
     RLOGD("cancelPendingUssdResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->cancelPendingUssdResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->cancelPendingUssdResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4171,7 +4441,7 @@ int radio::getClirResponse(int slotId,
     RLOGD("getClirResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         int n = -1, m = -1;
@@ -4184,7 +4454,7 @@ int radio::getClirResponse(int slotId,
             n = pInt[0];
             m = pInt[1];
         }
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getClirResponse(responseInfo,
+        Return<void> retStatus = radioCallbacks(slotId)->response->getClirResponse(responseInfo,
                 n, m);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4201,10 +4471,10 @@ int radio::setClirResponse(int slotId,
     RLOGD("setClirResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->setClirResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->setClirResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4221,7 +4491,7 @@ int radio::getCallForwardStatusResponse(int slotId,
     RLOGD("getCallForwardStatusResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         hidl_vec<CallForwardInfo> callForwardInfos;
@@ -4244,7 +4514,7 @@ int radio::getCallForwardStatusResponse(int slotId,
             }
         }
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getCallForwardStatusResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->getCallForwardStatusResponse(
                 responseInfo, callForwardInfos);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4262,10 +4532,10 @@ int radio::setCallForwardResponse(int slotId,
     RLOGD("setCallForwardResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->setCallForwardResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->setCallForwardResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4282,7 +4552,7 @@ int radio::getCallWaitingResponse(int slotId,
     RLOGD("getCallWaitingResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         bool enable = false;
@@ -4296,7 +4566,7 @@ int radio::getCallWaitingResponse(int slotId,
             enable = pInt[0] == 1 ? true : false;
             serviceClass = pInt[1];
         }
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getCallWaitingResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->getCallWaitingResponse(
                 responseInfo, enable, serviceClass);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4313,10 +4583,10 @@ int radio::setCallWaitingResponse(int slotId,
     RLOGD("setCallWaitingResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->setCallWaitingResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->setCallWaitingResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4333,11 +4603,11 @@ int radio::acknowledgeLastIncomingGsmSmsResponse(int slotId,
     RLOGD("acknowledgeLastIncomingGsmSmsResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus =
-                radioService[slotId]->mRadioResponse->acknowledgeLastIncomingGsmSmsResponse(
+                radioCallbacks(slotId)->response->acknowledgeLastIncomingGsmSmsResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4355,10 +4625,10 @@ int radio::acceptCallResponse(int slotId,
     RLOGD("acceptCallResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->acceptCallResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->acceptCallResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4376,10 +4646,10 @@ int radio::deactivateDataCallResponse(int slotId,
     RLOGD("deactivateDataCallResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->deactivateDataCallResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->deactivateDataCallResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4397,10 +4667,10 @@ int radio::getFacilityLockForAppResponse(int slotId,
     RLOGD("getFacilityLockForAppResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseInt(responseInfo, serial, responseType, e, response, responseLen);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->
+        Return<void> retStatus = radioCallbacks(slotId)->response->
                 getFacilityLockForAppResponse(responseInfo, ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4418,11 +4688,11 @@ int radio::setFacilityLockForAppResponse(int slotId,
     RLOGD("setFacilityLockForAppResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseIntOrEmpty(responseInfo, serial, responseType, e, response, responseLen);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setFacilityLockForAppResponse(responseInfo,
+                = radioCallbacks(slotId)->response->setFacilityLockForAppResponse(responseInfo,
                 ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4440,11 +4710,11 @@ int radio::setBarringPasswordResponse(int slotId,
     RLOGD("acceptCallResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setBarringPasswordResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setBarringPasswordResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setBarringPasswordResponse: radioService[%d]->mRadioResponse == NULL",
@@ -4461,7 +4731,7 @@ int radio::getNetworkSelectionModeResponse(int slotId,
     RLOGD("getNetworkSelectionModeResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         bool manual = false;
@@ -4473,7 +4743,7 @@ int radio::getNetworkSelectionModeResponse(int slotId,
             manual = pInt[0] == 1 ? true : false;
         }
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getNetworkSelectionModeResponse(
+                = radioCallbacks(slotId)->response->getNetworkSelectionModeResponse(
                 responseInfo,
                 manual);
         radioService[slotId]->checkReturnStatus(retStatus);
@@ -4492,11 +4762,11 @@ int radio::setNetworkSelectionModeAutomaticResponse(int slotId, int responseType
     RLOGD("setNetworkSelectionModeAutomaticResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setNetworkSelectionModeAutomaticResponse(
+                = radioCallbacks(slotId)->response->setNetworkSelectionModeAutomaticResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4514,11 +4784,11 @@ int radio::setNetworkSelectionModeManualResponse(int slotId,
     RLOGD("setNetworkSelectionModeManualResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setNetworkSelectionModeManualResponse(
+                = radioCallbacks(slotId)->response->setNetworkSelectionModeManualResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4550,7 +4820,7 @@ int radio::getAvailableNetworksResponse(int slotId,
     RLOGD("getAvailableNetworksResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         hidl_vec<OperatorInfo> networks;
@@ -4575,7 +4845,7 @@ int radio::getAvailableNetworksResponse(int slotId,
             }
         }
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getAvailableNetworksResponse(responseInfo,
+                = radioCallbacks(slotId)->response->getAvailableNetworksResponse(responseInfo,
                 networks);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4593,11 +4863,11 @@ int radio::startDtmfResponse(int slotId,
     RLOGD("startDtmfResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->startDtmfResponse(responseInfo);
+                = radioCallbacks(slotId)->response->startDtmfResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("startDtmfResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -4613,11 +4883,11 @@ int radio::stopDtmfResponse(int slotId,
     RLOGD("stopDtmfResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->stopDtmfResponse(responseInfo);
+                = radioCallbacks(slotId)->response->stopDtmfResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("stopDtmfResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -4633,11 +4903,11 @@ int radio::getBasebandVersionResponse(int slotId,
     RLOGD("getBasebandVersionResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getBasebandVersionResponse(responseInfo,
+                = radioCallbacks(slotId)->response->getBasebandVersionResponse(responseInfo,
                 convertCharPtrToHidlString((char *) response));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4654,11 +4924,11 @@ int radio::separateConnectionResponse(int slotId,
     RLOGD("separateConnectionResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->separateConnectionResponse(responseInfo);
+                = radioCallbacks(slotId)->response->separateConnectionResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("separateConnectionResponse: radioService[%d]->mRadioResponse == NULL",
@@ -4675,11 +4945,11 @@ int radio::setMuteResponse(int slotId,
     RLOGD("setMuteResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setMuteResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setMuteResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setMuteResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -4695,7 +4965,7 @@ int radio::getMuteResponse(int slotId,
     RLOGD("getMuteResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         bool enable = false;
@@ -4706,7 +4976,7 @@ int radio::getMuteResponse(int slotId,
             int *pInt = (int *) response;
             enable = pInt[0] == 1 ? true : false;
         }
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getMuteResponse(responseInfo,
+        Return<void> retStatus = radioCallbacks(slotId)->response->getMuteResponse(responseInfo,
                 enable);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4723,10 +4993,10 @@ int radio::getClipResponse(int slotId,
     RLOGD("getClipResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseInt(responseInfo, serial, responseType, e, response, responseLen);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getClipResponse(responseInfo,
+        Return<void> retStatus = radioCallbacks(slotId)->response->getClipResponse(responseInfo,
                 (ClipStatus) ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4743,20 +5013,23 @@ int radio::getDataCallListResponse(int slotId,
     RLOGD("getDataCallListResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
 
-        hidl_vec<SetupDataCallResult> ret;
+        ScratchVec<SetupDataCallResult>& scratch = conversionScratch[slotId].dataCallList;
+        std::lock_guard<std::mutex> lock(scratch.mutex);
+        hidl_vec<SetupDataCallResult>& ret = scratch.vec;
         if ((response == NULL && responseLen != 0)
                 || responseLen % sizeof(RIL_Data_Call_Response_v11) != 0) {
             RLOGE("getDataCallListResponse: invalid response");
             if (e == RIL_E_SUCCESS) responseInfo.error = RadioError::INVALID_RESPONSE;
+            resizeHidlVec(ret, 0);
         } else {
             convertRilDataCallListToHal(response, responseLen, ret);
         }
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getDataCallListResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->getDataCallListResponse(
                 responseInfo, ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4773,11 +5046,11 @@ int radio::setSuppServiceNotificationsResponse(int slotId,
     RLOGD("setSuppServiceNotificationsResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setSuppServiceNotificationsResponse(
+                = radioCallbacks(slotId)->response->setSuppServiceNotificationsResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4795,11 +5068,11 @@ int radio::deleteSmsOnSimResponse(int slotId,
     RLOGD("deleteSmsOnSimResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->deleteSmsOnSimResponse(responseInfo);
+                = radioCallbacks(slotId)->response->deleteSmsOnSimResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("deleteSmsOnSimResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -4815,11 +5088,11 @@ int radio::setBandModeResponse(int slotId,
     RLOGD("setBandModeResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setBandModeResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setBandModeResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setBandModeResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -4835,11 +5108,11 @@ int radio::writeSmsToSimResponse(int slotId,
     RLOGD("writeSmsToSimResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseInt(responseInfo, serial, responseType, e, response, responseLen);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->writeSmsToSimResponse(responseInfo, ret);
+                = radioCallbacks(slotId)->response->writeSmsToSimResponse(responseInfo, ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("writeSmsToSimResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -4855,7 +5128,7 @@ int radio::getAvailableBandModesResponse(int slotId,
     RLOGD("getAvailableBandModesResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         hidl_vec<RadioBandMode> modes;
@@ -4871,7 +5144,7 @@ int radio::getAvailableBandModesResponse(int slotId,
             }
         }
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getAvailableBandModesResponse(responseInfo,
+                = radioCallbacks(slotId)->response->getAvailableBandModesResponse(responseInfo,
                 modes);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4889,11 +5162,11 @@ int radio::sendEnvelopeResponse(int slotId,
     RLOGD("sendEnvelopeResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->sendEnvelopeResponse(responseInfo,
+                = radioCallbacks(slotId)->response->sendEnvelopeResponse(responseInfo,
                 convertCharPtrToHidlString((char *) response));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4910,11 +5183,11 @@ int radio::sendTerminalResponseToSimResponse(int slotId,
     RLOGD("sendTerminalResponseToSimResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->sendTerminalResponseToSimResponse(
+                = radioCallbacks(slotId)->response->sendTerminalResponseToSimResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4933,11 +5206,11 @@ int radio::handleStkCallSetupRequestFromSimResponse(int slotId,
     RLOGD("handleStkCallSetupRequestFromSimResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->handleStkCallSetupRequestFromSimResponse(
+                = radioCallbacks(slotId)->response->handleStkCallSetupRequestFromSimResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4955,11 +5228,11 @@ int radio::explicitCallTransferResponse(int slotId,
     RLOGD("explicitCallTransferResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->explicitCallTransferResponse(responseInfo);
+                = radioCallbacks(slotId)->response->explicitCallTransferResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("explicitCallTransferResponse: radioService[%d]->mRadioResponse == NULL",
@@ -4976,11 +5249,11 @@ int radio::setPreferredNetworkTypeResponse(int slotId,
     RLOGD("setPreferredNetworkTypeResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setPreferredNetworkTypeResponse(
+                = radioCallbacks(slotId)->response->setPreferredNetworkTypeResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -4999,11 +5272,11 @@ int radio::getPreferredNetworkTypeResponse(int slotId,
     RLOGD("getPreferredNetworkTypeResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseInt(responseInfo, serial, responseType, e, response, responseLen);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getPreferredNetworkTypeResponse(
+                = radioCallbacks(slotId)->response->getPreferredNetworkTypeResponse(
                 responseInfo, (PreferredNetworkType) ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5021,7 +5294,7 @@ int radio::getNeighboringCidsResponse(int slotId,
     RLOGD("getNeighboringCidsResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         hidl_vec<NeighboringCell> cells;
@@ -5041,7 +5314,7 @@ int radio::getNeighboringCidsResponse(int slotId,
         }
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getNeighboringCidsResponse(responseInfo,
+                = radioCallbacks(slotId)->response->getNeighboringCidsResponse(responseInfo,
                 cells);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5059,11 +5332,11 @@ int radio::setLocationUpdatesResponse(int slotId,
     RLOGD("setLocationUpdatesResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setLocationUpdatesResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setLocationUpdatesResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setLocationUpdatesResponse: radioService[%d]->mRadioResponse == NULL",
@@ -5080,11 +5353,11 @@ int radio::setCdmaSubscriptionSourceResponse(int slotId,
     RLOGD("setCdmaSubscriptionSourceResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setCdmaSubscriptionSourceResponse(
+                = radioCallbacks(slotId)->response->setCdmaSubscriptionSourceResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5102,11 +5375,11 @@ int radio::setCdmaRoamingPreferenceResponse(int slotId,
     RLOGD("setCdmaRoamingPreferenceResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setCdmaRoamingPreferenceResponse(
+                = radioCallbacks(slotId)->response->setCdmaRoamingPreferenceResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5124,11 +5397,11 @@ int radio::getCdmaRoamingPreferenceResponse(int slotId,
     RLOGD("getCdmaRoamingPreferenceResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseInt(responseInfo, serial, responseType, e, response, responseLen);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getCdmaRoamingPreferenceResponse(
+                = radioCallbacks(slotId)->response->getCdmaRoamingPreferenceResponse(
                 responseInfo, (CdmaRoamingType) ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5146,11 +5419,11 @@ int radio::setTTYModeResponse(int slotId,
     RLOGD("setTTYModeResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setTTYModeResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setTTYModeResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setTTYModeResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -5166,11 +5439,11 @@ int radio::getTTYModeResponse(int slotId,
     RLOGD("getTTYModeResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseInt(responseInfo, serial, responseType, e, response, responseLen);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getTTYModeResponse(responseInfo,
+                = radioCallbacks(slotId)->response->getTTYModeResponse(responseInfo,
                 (TtyMode) ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5187,11 +5460,11 @@ int radio::setPreferredVoicePrivacyResponse(int slotId,
     RLOGD("setPreferredVoicePrivacyResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setPreferredVoicePrivacyResponse(
+                = radioCallbacks(slotId)->response->setPreferredVoicePrivacyResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5209,7 +5482,7 @@ int radio::getPreferredVoicePrivacyResponse(int slotId,
     RLOGD("getPreferredVoicePrivacyResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         bool enable = false;
@@ -5222,7 +5495,7 @@ int radio::getPreferredVoicePrivacyResponse(int slotId,
             enable = pInt[0] == 1 ? true : false;
         }
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getPreferredVoicePrivacyResponse(
+                = radioCallbacks(slotId)->response->getPreferredVoicePrivacyResponse(
                 responseInfo, enable);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5240,11 +5513,11 @@ int radio::sendCDMAFeatureCodeResponse(int slotId,
     RLOGD("sendCDMAFeatureCodeResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->sendCDMAFeatureCodeResponse(responseInfo);
+                = radioCallbacks(slotId)->response->sendCDMAFeatureCodeResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("sendCDMAFeatureCodeResponse: radioService[%d]->mRadioResponse == NULL",
@@ -5261,11 +5534,11 @@ int radio::sendBurstDtmfResponse(int slotId,
     RLOGD("sendBurstDtmfResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->sendBurstDtmfResponse(responseInfo);
+                = radioCallbacks(slotId)->response->sendBurstDtmfResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("sendBurstDtmfResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -5281,13 +5554,13 @@ int radio::sendCdmaSmsResponse(int slotId,
     RLOGD("sendCdmaSmsResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         SendSmsResult result = makeSendSmsResult(responseInfo, serial, responseType, e, response,
                 responseLen);
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->sendCdmaSmsResponse(responseInfo, result);
+                = radioCallbacks(slotId)->response->sendCdmaSmsResponse(responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("sendCdmaSmsResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -5303,11 +5576,11 @@ int radio::acknowledgeLastIncomingCdmaSmsResponse(int slotId,
     RLOGD("acknowledgeLastIncomingCdmaSmsResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->acknowledgeLastIncomingCdmaSmsResponse(
+                = radioCallbacks(slotId)->response->acknowledgeLastIncomingCdmaSmsResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5325,7 +5598,7 @@ int radio::getGsmBroadcastConfigResponse(int slotId,
     RLOGD("getGsmBroadcastConfigResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         hidl_vec<GsmBroadcastSmsConfigInfo> configs;
@@ -5349,7 +5622,7 @@ int radio::getGsmBroadcastConfigResponse(int slotId,
         }
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getGsmBroadcastConfigResponse(responseInfo,
+                = radioCallbacks(slotId)->response->getGsmBroadcastConfigResponse(responseInfo,
                 configs);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5367,11 +5640,11 @@ int radio::setGsmBroadcastConfigResponse(int slotId,
     RLOGD("setGsmBroadcastConfigResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setGsmBroadcastConfigResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setGsmBroadcastConfigResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setGsmBroadcastConfigResponse: radioService[%d]->mRadioResponse == NULL",
@@ -5388,11 +5661,11 @@ int radio::setGsmBroadcastActivationResponse(int slotId,
     RLOGD("setGsmBroadcastActivationResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setGsmBroadcastActivationResponse(
+                = radioCallbacks(slotId)->response->setGsmBroadcastActivationResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5410,7 +5683,7 @@ int radio::getCdmaBroadcastConfigResponse(int slotId,
     RLOGD("getCdmaBroadcastConfigResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         hidl_vec<CdmaBroadcastSmsConfigInfo> configs;
@@ -5432,7 +5705,7 @@ int radio::getCdmaBroadcastConfigResponse(int slotId,
         }
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getCdmaBroadcastConfigResponse(responseInfo,
+                = radioCallbacks(slotId)->response->getCdmaBroadcastConfigResponse(responseInfo,
                 configs);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5450,11 +5723,11 @@ int radio::setCdmaBroadcastConfigResponse(int slotId,
     RLOGD("setCdmaBroadcastConfigResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setCdmaBroadcastConfigResponse(
+                = radioCallbacks(slotId)->response->setCdmaBroadcastConfigResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5472,11 +5745,11 @@ int radio::setCdmaBroadcastActivationResponse(int slotId,
     RLOGD("setCdmaBroadcastActivationResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setCdmaBroadcastActivationResponse(
+                = radioCallbacks(slotId)->response->setCdmaBroadcastActivationResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5494,7 +5767,7 @@ int radio::getCDMASubscriptionResponse(int slotId,
     RLOGD("getCDMASubscriptionResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
 
@@ -5504,13 +5777,13 @@ int radio::getCDMASubscriptionResponse(int slotId,
             RLOGE("getOperatorResponse Invalid response: NULL");
             if (e == RIL_E_SUCCESS) responseInfo.error = RadioError::INVALID_RESPONSE;
             Return<void> retStatus
-                    = radioService[slotId]->mRadioResponse->getCDMASubscriptionResponse(
+                    = radioCallbacks(slotId)->response->getCDMASubscriptionResponse(
                     responseInfo, emptyString, emptyString, emptyString, emptyString, emptyString);
             radioService[slotId]->checkReturnStatus(retStatus);
         } else {
             char **resp = (char **) response;
             Return<void> retStatus
-                    = radioService[slotId]->mRadioResponse->getCDMASubscriptionResponse(
+                    = radioCallbacks(slotId)->response->getCDMASubscriptionResponse(
                     responseInfo,
                     convertCharPtrToHidlString(resp[0]),
                     convertCharPtrToHidlString(resp[1]),
@@ -5534,11 +5807,11 @@ int radio::writeSmsToRuimResponse(int slotId,
     RLOGD("writeSmsToRuimResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseInt(responseInfo, serial, responseType, e, response, responseLen);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->writeSmsToRuimResponse(responseInfo, ret);
+                = radioCallbacks(slotId)->response->writeSmsToRuimResponse(responseInfo, ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("writeSmsToRuimResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -5554,11 +5827,11 @@ int radio::deleteSmsOnRuimResponse(int slotId,
     RLOGD("deleteSmsOnRuimResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->deleteSmsOnRuimResponse(responseInfo);
+                = radioCallbacks(slotId)->response->deleteSmsOnRuimResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("deleteSmsOnRuimResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -5574,7 +5847,7 @@ int radio::getDeviceIdentityResponse(int slotId,
     RLOGD("getDeviceIdentityResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
 
@@ -5584,13 +5857,13 @@ int radio::getDeviceIdentityResponse(int slotId,
             RLOGE("getDeviceIdentityResponse Invalid response: NULL");
             if (e == RIL_E_SUCCESS) responseInfo.error = RadioError::INVALID_RESPONSE;
             Return<void> retStatus
-                    = radioService[slotId]->mRadioResponse->getDeviceIdentityResponse(responseInfo,
+                    = radioCallbacks(slotId)->response->getDeviceIdentityResponse(responseInfo,
                     emptyString, emptyString, emptyString, emptyString);
             radioService[slotId]->checkReturnStatus(retStatus);
         } else {
             char **resp = (char **) response;
             Return<void> retStatus
-                    = radioService[slotId]->mRadioResponse->getDeviceIdentityResponse(responseInfo,
+                    = radioCallbacks(slotId)->response->getDeviceIdentityResponse(responseInfo,
                     convertCharPtrToHidlString(resp[0]),
                     convertCharPtrToHidlString(resp[1]),
                     convertCharPtrToHidlString(resp[2]),
@@ -5612,11 +5885,11 @@ int radio::exitEmergencyCallbackModeResponse(int slotId,
     RLOGD("exitEmergencyCallbackModeResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->exitEmergencyCallbackModeResponse(
+                = radioCallbacks(slotId)->response->exitEmergencyCallbackModeResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5634,11 +5907,11 @@ int radio::getSmscAddressResponse(int slotId,
     RLOGD("getSmscAddressResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getSmscAddressResponse(responseInfo,
+                = radioCallbacks(slotId)->response->getSmscAddressResponse(responseInfo,
                 convertCharPtrToHidlString((char *) response));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5655,11 +5928,11 @@ int radio::setSmscAddressResponse(int slotId,
     RLOGD("setSmscAddressResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setSmscAddressResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setSmscAddressResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setSmscAddressResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -5675,11 +5948,11 @@ int radio::reportSmsMemoryStatusResponse(int slotId,
     RLOGD("reportSmsMemoryStatusResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->reportSmsMemoryStatusResponse(responseInfo);
+                = radioCallbacks(slotId)->response->reportSmsMemoryStatusResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("reportSmsMemoryStatusResponse: radioService[%d]->mRadioResponse == NULL",
@@ -5696,10 +5969,10 @@ int radio::reportStkServiceIsRunningResponse(int slotId,
     RLOGD("reportStkServiceIsRunningResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->
+        Return<void> retStatus = radioCallbacks(slotId)->response->
                 reportStkServiceIsRunningResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5717,11 +5990,11 @@ int radio::getCdmaSubscriptionSourceResponse(int slotId,
     RLOGD("getCdmaSubscriptionSourceResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseInt(responseInfo, serial, responseType, e, response, responseLen);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getCdmaSubscriptionSourceResponse(
+                = radioCallbacks(slotId)->response->getCdmaSubscriptionSourceResponse(
                 responseInfo, (CdmaSubscriptionSource) ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5739,11 +6012,11 @@ int radio::requestIsimAuthenticationResponse(int slotId,
     RLOGD("requestIsimAuthenticationResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->requestIsimAuthenticationResponse(
+                = radioCallbacks(slotId)->response->requestIsimAuthenticationResponse(
                 responseInfo,
                 convertCharPtrToHidlString((char *) response));
         radioService[slotId]->checkReturnStatus(retStatus);
@@ -5763,11 +6036,11 @@ int radio::acknowledgeIncomingGsmSmsWithPduResponse(int slotId,
     RLOGD("acknowledgeIncomingGsmSmsWithPduResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->acknowledgeIncomingGsmSmsWithPduResponse(
+                = radioCallbacks(slotId)->response->acknowledgeIncomingGsmSmsWithPduResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5785,13 +6058,13 @@ int radio::sendEnvelopeWithStatusResponse(int slotId,
     RLOGD("sendEnvelopeWithStatusResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         IccIoResult result = responseIccIo(responseInfo, serial, responseType, e,
                 response, responseLen);
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->sendEnvelopeWithStatusResponse(responseInfo,
+                = radioCallbacks(slotId)->response->sendEnvelopeWithStatusResponse(responseInfo,
                 result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5809,11 +6082,11 @@ int radio::getVoiceRadioTechnologyResponse(int slotId,
     RLOGD("getVoiceRadioTechnologyResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseInt(responseInfo, serial, responseType, e, response, responseLen);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getVoiceRadioTechnologyResponse(
+                = radioCallbacks(slotId)->response->getVoiceRadioTechnologyResponse(
                 responseInfo, (RadioTechnology) ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5832,20 +6105,23 @@ int radio::getCellInfoListResponse(int slotId,
     RLOGD("getCellInfoListResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
 
-        hidl_vec<CellInfo> ret;
+        ScratchVec<CellInfo>& scratch = conversionScratch[slotId].cellInfoList;
+        std::lock_guard<std::mutex> lock(scratch.mutex);
+        hidl_vec<CellInfo>& ret = scratch.vec;
         if ((response == NULL && responseLen != 0)
                 || responseLen % sizeof(RIL_CellInfo_v12) != 0) {
             RLOGE("getCellInfoListResponse: Invalid response");
             if (e == RIL_E_SUCCESS) responseInfo.error = RadioError::INVALID_RESPONSE;
+            resizeHidlVec(ret, 0);
         } else {
             convertRilCellInfoListToHal(response, responseLen, ret);
         }
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getCellInfoListResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->getCellInfoListResponse(
                 responseInfo, ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5863,11 +6139,11 @@ int radio::setCellInfoListRateResponse(int slotId,
     RLOGD("setCellInfoListRateResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setCellInfoListRateResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setCellInfoListRateResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setCellInfoListRateResponse: radioService[%d]->mRadioResponse == NULL",
@@ -5884,11 +6160,11 @@ int radio::setInitialAttachApnResponse(int slotId,
     RLOGD("setInitialAttachApnResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setInitialAttachApnResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setInitialAttachApnResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setInitialAttachApnResponse: radioService[%d]->mRadioResponse == NULL",
@@ -5905,7 +6181,7 @@ int radio::getImsRegistrationStateResponse(int slotId,
     RLOGD("getImsRegistrationStateResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         bool isRegistered = false;
@@ -5925,7 +6201,7 @@ int radio::getImsRegistrationStateResponse(int slotId,
             }
         }
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getImsRegistrationStateResponse(
+                = radioCallbacks(slotId)->response->getImsRegistrationStateResponse(
                 responseInfo, isRegistered, ratFamily);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5943,13 +6219,13 @@ int radio::sendImsSmsResponse(int slotId,
     RLOGD("sendImsSmsResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         SendSmsResult result = makeSendSmsResult(responseInfo, serial, responseType, e, response,
                 responseLen);
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->sendImsSmsResponse(responseInfo, result);
+                = radioCallbacks(slotId)->response->sendImsSmsResponse(responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("sendSmsResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -5965,13 +6241,13 @@ int radio::iccTransmitApduBasicChannelResponse(int slotId,
     RLOGD("iccTransmitApduBasicChannelResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         IccIoResult result = responseIccIo(responseInfo, serial, responseType, e, response,
                 responseLen);
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->iccTransmitApduBasicChannelResponse(
+                = radioCallbacks(slotId)->response->iccTransmitApduBasicChannelResponse(
                 responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -5989,7 +6265,7 @@ int radio::iccOpenLogicalChannelResponse(int slotId,
     RLOGD("iccOpenLogicalChannelResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         int channelId = -1;
@@ -6009,7 +6285,7 @@ int radio::iccOpenLogicalChannelResponse(int slotId,
             }
         }
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->iccOpenLogicalChannelResponse(responseInfo,
+                = radioCallbacks(slotId)->response->iccOpenLogicalChannelResponse(responseInfo,
                 channelId, selectResponse);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6027,11 +6303,11 @@ int radio::iccCloseLogicalChannelResponse(int slotId,
     RLOGD("iccCloseLogicalChannelResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->iccCloseLogicalChannelResponse(
+                = radioCallbacks(slotId)->response->iccCloseLogicalChannelResponse(
                 responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6049,13 +6325,13 @@ int radio::iccTransmitApduLogicalChannelResponse(int slotId,
     RLOGD("iccTransmitApduLogicalChannelResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         IccIoResult result = responseIccIo(responseInfo, serial, responseType, e, response,
                 responseLen);
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->iccTransmitApduLogicalChannelResponse(
+                = radioCallbacks(slotId)->response->iccTransmitApduLogicalChannelResponse(
                 responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6073,10 +6349,10 @@ int radio::nvReadItemResponse(int slotId,
     RLOGD("nvReadItemResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->nvReadItemResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->nvReadItemResponse(
                 responseInfo,
                 convertCharPtrToHidlString((char *) response));
         radioService[slotId]->checkReturnStatus(retStatus);
@@ -6094,11 +6370,11 @@ int radio::nvWriteItemResponse(int slotId,
     RLOGD("nvWriteItemResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->nvWriteItemResponse(responseInfo);
+                = radioCallbacks(slotId)->response->nvWriteItemResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("nvWriteItemResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -6114,11 +6390,11 @@ int radio::nvWriteCdmaPrlResponse(int slotId,
     RLOGD("nvWriteCdmaPrlResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->nvWriteCdmaPrlResponse(responseInfo);
+                = radioCallbacks(slotId)->response->nvWriteCdmaPrlResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("nvWriteCdmaPrlResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -6134,11 +6410,11 @@ int radio::nvResetConfigResponse(int slotId,
     RLOGD("nvResetConfigResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->nvResetConfigResponse(responseInfo);
+                = radioCallbacks(slotId)->response->nvResetConfigResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("nvResetConfigResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -6154,11 +6430,11 @@ int radio::setUiccSubscriptionResponse(int slotId,
     RLOGD("setUiccSubscriptionResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setUiccSubscriptionResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setUiccSubscriptionResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setUiccSubscriptionResponse: radioService[%d]->mRadioResponse == NULL",
@@ -6175,11 +6451,11 @@ int radio::setDataAllowedResponse(int slotId,
     RLOGD("setDataAllowedResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setDataAllowedResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setDataAllowedResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setDataAllowedResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -6195,20 +6471,23 @@ int radio::getHardwareConfigResponse(int slotId,
     RLOGD("getHardwareConfigResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
 
-        hidl_vec<HardwareConfig> result;
+        ScratchVec<HardwareConfig>& scratch = conversionScratch[slotId].hardwareConfig;
+        std::lock_guard<std::mutex> lock(scratch.mutex);
+        hidl_vec<HardwareConfig>& result = scratch.vec;
         if ((response == NULL && responseLen != 0)
                 || responseLen % sizeof(RIL_HardwareConfig) != 0) {
             RLOGE("hardwareConfigChangedInd: invalid response");
             if (e == RIL_E_SUCCESS) responseInfo.error = RadioError::INVALID_RESPONSE;
+            resizeHidlVec(result, 0);
         } else {
             convertRilHardwareConfigListToHal(response, responseLen, result);
         }
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getHardwareConfigResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->getHardwareConfigResponse(
                 responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6225,13 +6504,13 @@ int radio::requestIccSimAuthenticationResponse(int slotId,
     RLOGD("requestIccSimAuthenticationResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         IccIoResult result = responseIccIo(responseInfo, serial, responseType, e, response,
                 responseLen);
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->requestIccSimAuthenticationResponse(
+                = radioCallbacks(slotId)->response->requestIccSimAuthenticationResponse(
                 responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6249,11 +6528,11 @@ int radio::setDataProfileResponse(int slotId,
     RLOGD("setDataProfileResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setDataProfileResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setDataProfileResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setDataProfileResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -6269,11 +6548,11 @@ int radio::requestShutdownResponse(int slotId,
     RLOGD("requestShutdownResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->requestShutdownResponse(responseInfo);
+                = radioCallbacks(slotId)->response->requestShutdownResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("requestShutdownResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -6302,12 +6581,12 @@ int radio::getRadioCapabilityResponse(int slotId,
     RLOGD("getRadioCapabilityResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         RadioCapability result = {};
         responseRadioCapability(responseInfo, serial, responseType, e, response, responseLen,
                 result);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->getRadioCapabilityResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->getRadioCapabilityResponse(
                 responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6324,12 +6603,12 @@ int radio::setRadioCapabilityResponse(int slotId,
     RLOGD("setRadioCapabilityResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         RadioCapability result = {};
         responseRadioCapability(responseInfo, serial, responseType, e, response, responseLen,
                 result);
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->setRadioCapabilityResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->setRadioCapabilityResponse(
                 responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6362,13 +6641,13 @@ int radio::startLceServiceResponse(int slotId,
     RLOGD("startLceServiceResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         LceStatusInfo result = responseLceStatusInfo(responseInfo, serial, responseType, e,
                 response, responseLen);
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->startLceServiceResponse(responseInfo,
+                = radioCallbacks(slotId)->response->startLceServiceResponse(responseInfo,
                 result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6385,13 +6664,13 @@ int radio::stopLceServiceResponse(int slotId,
     RLOGD("stopLceServiceResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         LceStatusInfo result = responseLceStatusInfo(responseInfo, serial, responseType, e,
                 response, responseLen);
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->stopLceServiceResponse(responseInfo,
+                = radioCallbacks(slotId)->response->stopLceServiceResponse(responseInfo,
                 result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6408,7 +6687,7 @@ int radio::pullLceDataResponse(int slotId,
     RLOGD("pullLceDataResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
 
@@ -6420,7 +6699,7 @@ int radio::pullLceDataResponse(int slotId,
             convertRilLceDataInfoToHal(response, responseLen, result);
         }
 
-        Return<void> retStatus = radioService[slotId]->mRadioResponse->pullLceDataResponse(
+        Return<void> retStatus = radioCallbacks(slotId)->response->pullLceDataResponse(
                 responseInfo, result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6437,7 +6716,7 @@ int radio::getModemActivityInfoResponse(int slotId,
     RLOGD("getModemActivityInfoResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         ActivityStatsInfo info;
@@ -6455,7 +6734,7 @@ int radio::getModemActivityInfoResponse(int slotId,
         }
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getModemActivityInfoResponse(responseInfo,
+                = radioCallbacks(slotId)->response->getModemActivityInfoResponse(responseInfo,
                 info);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6473,11 +6752,11 @@ int radio::setAllowedCarriersResponse(int slotId,
     RLOGD("setAllowedCarriersResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         int ret = responseInt(responseInfo, serial, responseType, e, response, responseLen);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setAllowedCarriersResponse(responseInfo,
+                = radioCallbacks(slotId)->response->setAllowedCarriersResponse(responseInfo,
                 ret);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6495,7 +6774,7 @@ int radio::getAllowedCarriersResponse(int slotId,
     RLOGD("getAllowedCarriersResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         CarrierRestrictions carrierInfo = {};
@@ -6537,7 +6816,7 @@ int radio::getAllowedCarriersResponse(int slotId,
         }
 
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->getAllowedCarriersResponse(responseInfo,
+                = radioCallbacks(slotId)->response->getAllowedCarriersResponse(responseInfo,
                 allAllowed, carrierInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6555,11 +6834,11 @@ int radio::sendDeviceStateResponse(int slotId,
     RLOGD("sendDeviceStateResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->sendDeviceStateResponse(responseInfo);
+                = radioCallbacks(slotId)->response->sendDeviceStateResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("sendDeviceStateResponse: radioService[%d]->mRadioResponse == NULL", slotId);
@@ -6572,10 +6851,10 @@ int radio::setCarrierInfoForImsiEncryptionResponse(int slotId,
                                int responseType, int serial, RIL_Errno e,
                                void *response, size_t responseLen) {
     RLOGD("setCarrierInfoForImsiEncryptionResponse: serial %d", serial);
-    if (radioService[slotId]->mRadioResponseV1_1 != NULL) {
+    if (radioCallbacks(slotId)->responseV1_1 != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        Return<void> retStatus = radioService[slotId]->mRadioResponseV1_1->
+        Return<void> retStatus = radioCallbacks(slotId)->responseV1_1->
                 setCarrierInfoForImsiEncryptionResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6592,11 +6871,11 @@ int radio::setIndicationFilterResponse(int slotId,
     RLOGD("setIndicationFilterResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL) {
+    if (radioCallbacks(slotId)->response != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponse->setIndicationFilterResponse(responseInfo);
+                = radioCallbacks(slotId)->response->setIndicationFilterResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("setIndicationFilterResponse: radioService[%d]->mRadioResponse == NULL",
@@ -6613,19 +6892,19 @@ int radio::setSimCardPowerResponse(int slotId,
     RLOGD("setSimCardPowerResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponse != NULL
-            || radioService[slotId]->mRadioResponseV1_1 != NULL) {
+    if (radioCallbacks(slotId)->response != NULL
+            || radioCallbacks(slotId)->responseV1_1 != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
-        if (radioService[slotId]->mRadioResponseV1_1 != NULL) {
-            Return<void> retStatus = radioService[slotId]->mRadioResponseV1_1->
+        if (radioCallbacks(slotId)->responseV1_1 != NULL) {
+            Return<void> retStatus = radioCallbacks(slotId)->responseV1_1->
                     setSimCardPowerResponse_1_1(responseInfo);
             radioService[slotId]->checkReturnStatus(retStatus);
         } else {
             RLOGD("setSimCardPowerResponse: radioService[%d]->mRadioResponseV1_1 == NULL",
                     slotId);
             Return<void> retStatus
-                    = radioService[slotId]->mRadioResponse->setSimCardPowerResponse(responseInfo);
+                    = radioCallbacks(slotId)->response->setSimCardPowerResponse(responseInfo);
             radioService[slotId]->checkReturnStatus(retStatus);
         }
     } else {
@@ -6641,11 +6920,11 @@ int radio::startNetworkScanResponse(int slotId, int responseType, int serial, RI
     RLOGD("startNetworkScanResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponseV1_1 != NULL) {
+    if (radioCallbacks(slotId)->responseV1_1 != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponseV1_1->startNetworkScanResponse(responseInfo);
+                = radioCallbacks(slotId)->responseV1_1->startNetworkScanResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("startNetworkScanResponse: radioService[%d]->mRadioResponseV1_1 == NULL", slotId);
@@ -6660,11 +6939,11 @@ int radio::stopNetworkScanResponse(int slotId, int responseType, int serial, RIL
     RLOGD("stopNetworkScanResponse: serial %d", serial);
 #endif
 
-    if (radioService[slotId]->mRadioResponseV1_1 != NULL) {
+    if (radioCallbacks(slotId)->responseV1_1 != NULL) {
         RadioResponseInfo responseInfo = {};
         populateResponseInfo(responseInfo, serial, responseType, e);
         Return<void> retStatus
-                = radioService[slotId]->mRadioResponseV1_1->stopNetworkScanResponse(responseInfo);
+                = radioCallbacks(slotId)->responseV1_1->stopNetworkScanResponse(responseInfo);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
         RLOGE("stopNetworkScanResponse: radioService[%d]->mRadioResponseV1_1 == NULL", slotId);
@@ -6688,7 +6967,7 @@ int radio::startKeepaliveResponse(int slotId, int responseType, int serial, RIL_
     populateResponseInfo(responseInfo, serial, responseType, e);
 
     // If we don't have a radio service, there's nothing we can do
-    if (radioService[slotId]->mRadioResponseV1_1 == NULL) {
+    if (radioCallbacks(slotId)->responseV1_1 == NULL) {
         RLOGE("%s: radioService[%d]->mRadioResponseV1_1 == NULL", __FUNCTION__, slotId);
         return 0;
     }
@@ -6702,7 +6981,7 @@ int radio::startKeepaliveResponse(int slotId, int responseType, int serial, RIL_
     }
 
     Return<void> retStatus =
-            radioService[slotId]->mRadioResponseV1_1->startKeepaliveResponse(responseInfo, ks);
+            radioCallbacks(slotId)->responseV1_1->startKeepaliveResponse(responseInfo, ks);
     radioService[slotId]->checkReturnStatus(retStatus);
     return 0;
 }
@@ -6716,13 +6995,13 @@ int radio::stopKeepaliveResponse(int slotId, int responseType, int serial, RIL_E
     populateResponseInfo(responseInfo, serial, responseType, e);
 
     // If we don't have a radio service, there's nothing we can do
-    if (radioService[slotId]->mRadioResponseV1_1 == NULL) {
+    if (radioCallbacks(slotId)->responseV1_1 == NULL) {
         RLOGE("%s: radioService[%d]->mRadioResponseV1_1 == NULL", __FUNCTION__, slotId);
         return 0;
     }
 
     Return<void> retStatus =
-            radioService[slotId]->mRadioResponseV1_1->stopKeepaliveResponse(responseInfo);
+            radioCallbacks(slotId)->responseV1_1->stopKeepaliveResponse(responseInfo);
     radioService[slotId]->checkReturnStatus(retStatus);
     return 0;
 }
@@ -6741,11 +7020,11 @@ RadioIndicationType convertIntToRadioIndicationType(int indicationType) {
 int radio::radioStateChangedInd(int slotId,
                                  int indicationType, int token, RIL_Errno e, void *response,
                                  size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         RadioState radioState =
                 (RadioState) CALL_ONSTATEREQUEST(slotId);
         RLOGD("radioStateChangedInd: radioState %d", radioState);
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->radioStateChanged(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->radioStateChanged(
                 convertIntToRadioIndicationType(indicationType), radioState);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6758,11 +7037,11 @@ int radio::radioStateChangedInd(int slotId,
 int radio::callStateChangedInd(int slotId,
                                int indicationType, int token, RIL_Errno e, void *response,
                                size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
 #if VDBG
         RLOGD("callStateChangedInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->callStateChanged(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->callStateChanged(
                 convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6775,11 +7054,11 @@ int radio::callStateChangedInd(int slotId,
 int radio::networkStateChangedInd(int slotId,
                                   int indicationType, int token, RIL_Errno e, void *response,
                                   size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
 #if VDBG
         RLOGD("networkStateChangedInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->networkStateChanged(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->networkStateChanged(
                 convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6828,7 +7107,7 @@ uint8_t * convertHexStringToBytes(void *response, size_t responseLen) {
 
 int radio::newSmsInd(int slotId, int indicationType,
                      int token, RIL_Errno e, void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen == 0) {
             RLOGE("newSmsInd: invalid response");
             return 0;
@@ -6845,7 +7124,7 @@ int radio::newSmsInd(int slotId, int indicationType,
 #if VDBG
         RLOGD("newSmsInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->newSms(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->newSms(
                 convertIntToRadioIndicationType(indicationType), pdu);
         radioService[slotId]->checkReturnStatus(retStatus);
         free(bytes);
@@ -6859,7 +7138,7 @@ int radio::newSmsInd(int slotId, int indicationType,
 int radio::newSmsStatusReportInd(int slotId,
                                  int indicationType, int token, RIL_Errno e, void *response,
                                  size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen == 0) {
             RLOGE("newSmsStatusReportInd: invalid response");
             return 0;
@@ -6876,7 +7155,7 @@ int radio::newSmsStatusReportInd(int slotId,
 #if VDBG
         RLOGD("newSmsStatusReportInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->newSmsStatusReport(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->newSmsStatusReport(
                 convertIntToRadioIndicationType(indicationType), pdu);
         radioService[slotId]->checkReturnStatus(retStatus);
         free(bytes);
@@ -6889,7 +7168,7 @@ int radio::newSmsStatusReportInd(int slotId,
 
 int radio::newSmsOnSimInd(int slotId, int indicationType,
                           int token, RIL_Errno e, void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(int)) {
             RLOGE("newSmsOnSimInd: invalid response");
             return 0;
@@ -6898,7 +7177,7 @@ int radio::newSmsOnSimInd(int slotId, int indicationType,
 #if VDBG
         RLOGD("newSmsOnSimInd: slotIndex %d", recordNumber);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->newSmsOnSim(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->newSmsOnSim(
                 convertIntToRadioIndicationType(indicationType), recordNumber);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6910,7 +7189,7 @@ int radio::newSmsOnSimInd(int slotId, int indicationType,
 
 int radio::onUssdInd(int slotId, int indicationType,
                      int token, RIL_Errno e, void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != 2 * sizeof(char *)) {
             RLOGE("onUssdInd: invalid response");
             return 0;
@@ -6922,7 +7201,7 @@ int radio::onUssdInd(int slotId, int indicationType,
 #if VDBG
         RLOGD("onUssdInd: mode %s", mode);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->onUssd(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->onUssd(
                 convertIntToRadioIndicationType(indicationType), modeType, msg);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -6935,7 +7214,7 @@ int radio::onUssdInd(int slotId, int indicationType,
 int radio::nitzTimeReceivedInd(int slotId,
                                int indicationType, int token, RIL_Errno e, void *response,
                                size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen == 0) {
             RLOGE("nitzTimeReceivedInd: invalid response");
             return 0;
@@ -6945,7 +7224,7 @@ int radio::nitzTimeReceivedInd(int slotId,
         RLOGD("nitzTimeReceivedInd: nitzTime %s receivedTime %" PRId64, nitzTime.c_str(),
                 nitzTimeReceived[slotId]);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->nitzTimeReceived(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->nitzTimeReceived(
                 convertIntToRadioIndicationType(indicationType), nitzTime,
                 nitzTimeReceived[slotId]);
         radioService[slotId]->checkReturnStatus(retStatus);
@@ -7007,7 +7286,7 @@ void convertRilSignalStrengthToHal(void *response, size_t responseLen,
 int radio::currentSignalStrengthInd(int slotId,
                                     int indicationType, int token, RIL_Errno e,
                                     void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(RIL_SignalStrength_v10)) {
             RLOGE("currentSignalStrengthInd: invalid response");
             return 0;
@@ -7019,7 +7298,7 @@ int radio::currentSignalStrengthInd(int slotId,
 #if VDBG
         RLOGD("currentSignalStrengthInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->currentSignalStrength(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->currentSignalStrength(
                 convertIntToRadioIndicationType(indicationType), signalStrength);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7036,12 +7315,12 @@ void convertRilDataCallToHal(RIL_Data_Call_Response_v11 *dcResponse,
     dcResult.suggestedRetryTime = dcResponse->suggestedRetryTime;
     dcResult.cid = dcResponse->cid;
     dcResult.active = dcResponse->active;
-    dcResult.type = convertCharPtrToHidlString(dcResponse->type);
-    dcResult.ifname = convertCharPtrToHidlString(dcResponse->ifname);
-    dcResult.addresses = convertCharPtrToHidlString(dcResponse->addresses);
-    dcResult.dnses = convertCharPtrToHidlString(dcResponse->dnses);
-    dcResult.gateways = convertCharPtrToHidlString(dcResponse->gateways);
-    dcResult.pcscf = convertCharPtrToHidlString(dcResponse->pcscf);
+    setHidlString(dcResult.type, dcResponse->type);
+    setHidlString(dcResult.ifname, dcResponse->ifname);
+    setHidlString(dcResult.addresses, dcResponse->addresses);
+    setHidlString(dcResult.dnses, dcResponse->dnses);
+    setHidlString(dcResult.gateways, dcResponse->gateways);
+    setHidlString(dcResult.pcscf, dcResponse->pcscf);
     dcResult.mtu = dcResponse->mtu;
 }
 
@@ -7050,7 +7329,7 @@ void convertRilDataCallListToHal(void *response, size_t responseLen,
     int num = responseLen / sizeof(RIL_Data_Call_Response_v11);
 
     RIL_Data_Call_Response_v11 *dcResponse = (RIL_Data_Call_Response_v11 *) response;
-    dcResultList.resize(num);
+    resizeHidlVec(dcResultList, num);
     for (int i = 0; i < num; i++) {
         convertRilDataCallToHal(&dcResponse[i], dcResultList[i]);
     }
@@ -7059,18 +7338,20 @@ void convertRilDataCallListToHal(void *response, size_t responseLen,
 int radio::dataCallListChangedInd(int slotId,
                                   int indicationType, int token, RIL_Errno e, void *response,
                                   size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if ((response == NULL && responseLen != 0)
                 || responseLen % sizeof(RIL_Data_Call_Response_v11) != 0) {
             RLOGE("dataCallListChangedInd: invalid response");
             return 0;
         }
-        hidl_vec<SetupDataCallResult> dcList;
+        ScratchVec<SetupDataCallResult>& scratch = conversionScratch[slotId].dataCallListInd;
+        std::lock_guard<std::mutex> lock(scratch.mutex);
+        hidl_vec<SetupDataCallResult>& dcList = scratch.vec;
         convertRilDataCallListToHal(response, responseLen, dcList);
 #if VDBG
         RLOGD("dataCallListChangedInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->dataCallListChanged(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->dataCallListChanged(
                 convertIntToRadioIndicationType(indicationType), dcList);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7082,7 +7363,7 @@ int radio::dataCallListChangedInd(int slotId,
 
 int radio::suppSvcNotifyInd(int slotId, int indicationType,
                             int token, RIL_Errno e, void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(RIL_SuppSvcNotification)) {
             RLOGE("suppSvcNotifyInd: invalid response");
             return 0;
@@ -7100,7 +7381,7 @@ int radio::suppSvcNotifyInd(int slotId, int indicationType,
         RLOGD("suppSvcNotifyInd: isMT %d code %d index %d type %d",
                 suppSvc.isMT, suppSvc.code, suppSvc.index, suppSvc.type);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->suppSvcNotify(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->suppSvcNotify(
                 convertIntToRadioIndicationType(indicationType), suppSvc);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7112,11 +7393,11 @@ int radio::suppSvcNotifyInd(int slotId, int indicationType,
 
 int radio::stkSessionEndInd(int slotId, int indicationType,
                             int token, RIL_Errno e, void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
 #if VDBG
         RLOGD("stkSessionEndInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->stkSessionEnd(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->stkSessionEnd(
                 convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7129,7 +7410,7 @@ int radio::stkSessionEndInd(int slotId, int indicationType,
 int radio::stkProactiveCommandInd(int slotId,
                                   int indicationType, int token, RIL_Errno e, void *response,
                                   size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen == 0) {
             RLOGE("stkProactiveCommandInd: invalid response");
             return 0;
@@ -7137,7 +7418,7 @@ int radio::stkProactiveCommandInd(int slotId,
 #if VDBG
         RLOGD("stkProactiveCommandInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->stkProactiveCommand(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->stkProactiveCommand(
                 convertIntToRadioIndicationType(indicationType),
                 convertCharPtrToHidlString((char *) response));
         radioService[slotId]->checkReturnStatus(retStatus);
@@ -7150,7 +7431,7 @@ int radio::stkProactiveCommandInd(int slotId,
 
 int radio::stkEventNotifyInd(int slotId, int indicationType,
                              int token, RIL_Errno e, void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen == 0) {
             RLOGE("stkEventNotifyInd: invalid response");
             return 0;
@@ -7158,7 +7439,7 @@ int radio::stkEventNotifyInd(int slotId, int indicationType,
 #if VDBG
         RLOGD("stkEventNotifyInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->stkEventNotify(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->stkEventNotify(
                 convertIntToRadioIndicationType(indicationType),
                 convertCharPtrToHidlString((char *) response));
         radioService[slotId]->checkReturnStatus(retStatus);
@@ -7171,7 +7452,7 @@ int radio::stkEventNotifyInd(int slotId, int indicationType,
 
 int radio::stkCallSetupInd(int slotId, int indicationType,
                            int token, RIL_Errno e, void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(int)) {
             RLOGE("stkCallSetupInd: invalid response");
             return 0;
@@ -7180,7 +7461,7 @@ int radio::stkCallSetupInd(int slotId, int indicationType,
 #if VDBG
         RLOGD("stkCallSetupInd: timeout %d", timeout);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->stkCallSetup(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->stkCallSetup(
                 convertIntToRadioIndicationType(indicationType), timeout);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7193,11 +7474,11 @@ int radio::stkCallSetupInd(int slotId, int indicationType,
 int radio::simSmsStorageFullInd(int slotId,
                                 int indicationType, int token, RIL_Errno e, void *response,
                                 size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
 #if VDBG
         RLOGD("simSmsStorageFullInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->simSmsStorageFull(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->simSmsStorageFull(
                 convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7209,7 +7490,7 @@ int radio::simSmsStorageFullInd(int slotId,
 
 int radio::simRefreshInd(int slotId, int indicationType,
                          int token, RIL_Errno e, void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(RIL_SimRefreshResponse_v7)) {
             RLOGE("simRefreshInd: invalid response");
             return 0;
@@ -7225,7 +7506,7 @@ int radio::simRefreshInd(int slotId, int indicationType,
 #if VDBG
         RLOGD("simRefreshInd: type %d efId %d", refreshResult.type, refreshResult.efId);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->simRefresh(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->simRefresh(
                 convertIntToRadioIndicationType(indicationType), refreshResult);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7245,7 +7526,7 @@ void convertRilCdmaSignalInfoRecordToHal(RIL_CDMA_SignalInfoRecord *signalInfoRe
 
 int radio::callRingInd(int slotId, int indicationType,
                        int token, RIL_Errno e, void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         bool isGsm;
         CdmaSignalInfoRecord record = {};
         if (response == NULL || responseLen == 0) {
@@ -7262,7 +7543,7 @@ int radio::callRingInd(int slotId, int indicationType,
 #if VDBG
         RLOGD("callRingInd: isGsm %d", isGsm);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->callRing(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->callRing(
                 convertIntToRadioIndicationType(indicationType), isGsm, record);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7275,11 +7556,11 @@ int radio::callRingInd(int slotId, int indicationType,
 int radio::simStatusChangedInd(int slotId,
                                int indicationType, int token, RIL_Errno e, void *response,
                                size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
 #if VDBG
         RLOGD("simStatusChangedInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->simStatusChanged(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->simStatusChanged(
                 convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7291,7 +7572,7 @@ int radio::simStatusChangedInd(int slotId,
 
 int radio::cdmaNewSmsInd(int slotId, int indicationType,
                          int token, RIL_Errno e, void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(RIL_CDMA_SMS_Message)) {
             RLOGE("cdmaNewSmsInd: invalid response");
             return 0;
@@ -7327,7 +7608,7 @@ int radio::cdmaNewSmsInd(int slotId, int indicationType,
 #if VDBG
         RLOGD("cdmaNewSmsInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->cdmaNewSms(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->cdmaNewSms(
                 convertIntToRadioIndicationType(indicationType), msg);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7340,7 +7621,7 @@ int radio::cdmaNewSmsInd(int slotId, int indicationType,
 int radio::newBroadcastSmsInd(int slotId,
                               int indicationType, int token, RIL_Errno e, void *response,
                               size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen == 0) {
             RLOGE("newBroadcastSmsInd: invalid response");
             return 0;
@@ -7351,7 +7632,7 @@ int radio::newBroadcastSmsInd(int slotId,
 #if VDBG
         RLOGD("newBroadcastSmsInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->newBroadcastSms(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->newBroadcastSms(
                 convertIntToRadioIndicationType(indicationType), data);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7364,11 +7645,11 @@ int radio::newBroadcastSmsInd(int slotId,
 int radio::cdmaRuimSmsStorageFullInd(int slotId,
                                      int indicationType, int token, RIL_Errno e, void *response,
                                      size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
 #if VDBG
         RLOGD("cdmaRuimSmsStorageFullInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->cdmaRuimSmsStorageFull(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->cdmaRuimSmsStorageFull(
                 convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7382,7 +7663,7 @@ int radio::cdmaRuimSmsStorageFullInd(int slotId,
 int radio::restrictedStateChangedInd(int slotId,
                                      int indicationType, int token, RIL_Errno e, void *response,
                                      size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(int)) {
             RLOGE("restrictedStateChangedInd: invalid response");
             return 0;
@@ -7391,7 +7672,7 @@ int radio::restrictedStateChangedInd(int slotId,
 #if VDBG
         RLOGD("restrictedStateChangedInd: state %d", state);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->restrictedStateChanged(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->restrictedStateChanged(
                 convertIntToRadioIndicationType(indicationType), (PhoneRestrictedState) state);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7405,11 +7686,11 @@ int radio::restrictedStateChangedInd(int slotId,
 int radio::enterEmergencyCallbackModeInd(int slotId,
                                          int indicationType, int token, RIL_Errno e, void *response,
                                          size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
 #if VDBG
         RLOGD("enterEmergencyCallbackModeInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->enterEmergencyCallbackMode(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->enterEmergencyCallbackMode(
                 convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7423,7 +7704,7 @@ int radio::enterEmergencyCallbackModeInd(int slotId,
 int radio::cdmaCallWaitingInd(int slotId,
                               int indicationType, int token, RIL_Errno e, void *response,
                               size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(RIL_CDMA_CallWaiting_v6)) {
             RLOGE("cdmaCallWaitingInd: invalid response");
             return 0;
@@ -7443,7 +7724,7 @@ int radio::cdmaCallWaitingInd(int slotId,
 #if VDBG
         RLOGD("cdmaCallWaitingInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->cdmaCallWaiting(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->cdmaCallWaiting(
                 convertIntToRadioIndicationType(indicationType), callWaitingRecord);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7456,7 +7737,7 @@ int radio::cdmaCallWaitingInd(int slotId,
 int radio::cdmaOtaProvisionStatusInd(int slotId,
                                      int indicationType, int token, RIL_Errno e, void *response,
                                      size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(int)) {
             RLOGE("cdmaOtaProvisionStatusInd: invalid response");
             return 0;
@@ -7465,7 +7746,7 @@ int radio::cdmaOtaProvisionStatusInd(int slotId,
 #if VDBG
         RLOGD("cdmaOtaProvisionStatusInd: status %d", status);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->cdmaOtaProvisionStatus(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->cdmaOtaProvisionStatus(
                 convertIntToRadioIndicationType(indicationType), (CdmaOtaProvisionStatus) status);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7479,7 +7760,7 @@ int radio::cdmaOtaProvisionStatusInd(int slotId,
 int radio::cdmaInfoRecInd(int slotId,
                           int indicationType, int token, RIL_Errno e, void *response,
                           size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(RIL_CDMA_InformationRecords)) {
             RLOGE("cdmaInfoRecInd: invalid response");
             return 0;
@@ -7644,7 +7925,7 @@ int radio::cdmaInfoRecInd(int slotId,
 #if VDBG
         RLOGD("cdmaInfoRecInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->cdmaInfoRec(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->cdmaInfoRec(
                 convertIntToRadioIndicationType(indicationType), records);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7657,7 +7938,7 @@ int radio::cdmaInfoRecInd(int slotId,
 int radio::indicateRingbackToneInd(int slotId,
                                    int indicationType, int token, RIL_Errno e, void *response,
                                    size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(int)) {
             RLOGE("indicateRingbackToneInd: invalid response");
             return 0;
@@ -7666,7 +7947,7 @@ int radio::indicateRingbackToneInd(int slotId,
 #if VDBG
         RLOGD("indicateRingbackToneInd: start %d", start);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->indicateRingbackTone(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->indicateRingbackTone(
                 convertIntToRadioIndicationType(indicationType), start);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7679,11 +7960,11 @@ int radio::indicateRingbackToneInd(int slotId,
 int radio::resendIncallMuteInd(int slotId,
                                int indicationType, int token, RIL_Errno e, void *response,
                                size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
 #if VDBG
         RLOGD("resendIncallMuteInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->resendIncallMute(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->resendIncallMute(
                 convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7696,7 +7977,7 @@ int radio::resendIncallMuteInd(int slotId,
 int radio::cdmaSubscriptionSourceChangedInd(int slotId,
                                             int indicationType, int token, RIL_Errno e,
                                             void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(int)) {
             RLOGE("cdmaSubscriptionSourceChangedInd: invalid response");
             return 0;
@@ -7705,7 +7986,7 @@ int radio::cdmaSubscriptionSourceChangedInd(int slotId,
 #if VDBG
         RLOGD("cdmaSubscriptionSourceChangedInd: cdmaSource %d", cdmaSource);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->
+        Return<void> retStatus = radioCallbacks(slotId)->indication->
                 cdmaSubscriptionSourceChanged(convertIntToRadioIndicationType(indicationType),
                 (CdmaSubscriptionSource) cdmaSource);
         radioService[slotId]->checkReturnStatus(retStatus);
@@ -7720,7 +8001,7 @@ int radio::cdmaSubscriptionSourceChangedInd(int slotId,
 int radio::cdmaPrlChangedInd(int slotId,
                              int indicationType, int token, RIL_Errno e, void *response,
                              size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(int)) {
             RLOGE("cdmaPrlChangedInd: invalid response");
             return 0;
@@ -7729,7 +8010,7 @@ int radio::cdmaPrlChangedInd(int slotId,
 #if VDBG
         RLOGD("cdmaPrlChangedInd: version %d", version);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->cdmaPrlChanged(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->cdmaPrlChanged(
                 convertIntToRadioIndicationType(indicationType), version);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7742,11 +8023,11 @@ int radio::cdmaPrlChangedInd(int slotId,
 int radio::exitEmergencyCallbackModeInd(int slotId,
                                         int indicationType, int token, RIL_Errno e, void *response,
                                         size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
 #if VDBG
         RLOGD("exitEmergencyCallbackModeInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->exitEmergencyCallbackMode(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->exitEmergencyCallbackMode(
                 convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7760,9 +8041,9 @@ int radio::exitEmergencyCallbackModeInd(int slotId,
 int radio::rilConnectedInd(int slotId,
                            int indicationType, int token, RIL_Errno e, void *response,
                            size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         RLOGD("rilConnectedInd");
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->rilConnected(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->rilConnected(
                 convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7775,7 +8056,7 @@ int radio::rilConnectedInd(int slotId,
 int radio::voiceRadioTechChangedInd(int slotId,
                                     int indicationType, int token, RIL_Errno e, void *response,
                                     size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(int)) {
             RLOGE("voiceRadioTechChangedInd: invalid response");
             return 0;
@@ -7784,7 +8065,7 @@ int radio::voiceRadioTechChangedInd(int slotId,
 #if VDBG
         RLOGD("voiceRadioTechChangedInd: rat %d", rat);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->voiceRadioTechChanged(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->voiceRadioTechChanged(
                 convertIntToRadioIndicationType(indicationType), (RadioTechnology) rat);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7797,7 +8078,7 @@ int radio::voiceRadioTechChangedInd(int slotId,
 
 void convertRilCellInfoListToHal(void *response, size_t responseLen, hidl_vec<CellInfo>& records) {
     int num = responseLen / sizeof(RIL_CellInfo_v12);
-    records.resize(num);
+    resizeHidlVec(records, num);
 
     RIL_CellInfo_v12 *rillCellInfo = (RIL_CellInfo_v12 *) response;
     for (int i = 0; i < num; i++) {
@@ -7805,21 +8086,23 @@ void convertRilCellInfoListToHal(void *response, size_t responseLen, hidl_vec<Ce
         records[i].registered = rillCellInfo->registered;
         records[i].timeStampType = (TimeStampType) rillCellInfo->timeStampType;
         records[i].timeStamp = rillCellInfo->timeStamp;
-        // All vectors should be size 0 except one which will be size 1. Set everything to
-        // size 0 initially.
-        records[i].gsm.resize(0);
-        records[i].wcdma.resize(0);
-        records[i].cdma.resize(0);
-        records[i].lte.resize(0);
-        records[i].tdscdma.resize(0);
+        // All vectors should be size 0 except the one for cellInfoType, which will be size 1.
+        // A reused record usually holds the same type as last time, so nothing is reallocated.
+        CellInfoType type = records[i].cellInfoType;
+        resizeHidlVec(records[i].gsm, type == CellInfoType::GSM ? 1 : 0);
+        resizeHidlVec(records[i].wcdma, type == CellInfoType::WCDMA ? 1 : 0);
+        resizeHidlVec(records[i].cdma, type == CellInfoType::CDMA ? 1 : 0);
+        resizeHidlVec(records[i].lte, type == CellInfoType::LTE ? 1 : 0);
+        resizeHidlVec(records[i].tdscdma, type == CellInfoType::TD_SCDMA ? 1 : 0);
         switch(rillCellInfo->cellInfoType) {
             case RIL_CELL_INFO_TYPE_GSM: {
-                records[i].gsm.resize(1);
                 CellInfoGsm *cellInfoGsm = &records[i].gsm[0];
-                cellInfoGsm->cellIdentityGsm.mcc =
-                        ril::util::mcc::decode(rillCellInfo->CellInfo.gsm.cellIdentityGsm.mcc);
-                cellInfoGsm->cellIdentityGsm.mnc =
-                        ril::util::mnc::decode(rillCellInfo->CellInfo.gsm.cellIdentityGsm.mnc);
+                setHidlString(cellInfoGsm->cellIdentityGsm.mcc,
+                        ril::util::mcc::decodeStr(
+                                rillCellInfo->CellInfo.gsm.cellIdentityGsm.mcc));
+                setHidlString(cellInfoGsm->cellIdentityGsm.mnc,
+                        ril::util::mnc::decodeStr(
+                                rillCellInfo->CellInfo.gsm.cellIdentityGsm.mnc));
                 cellInfoGsm->cellIdentityGsm.lac =
                         rillCellInfo->CellInfo.gsm.cellIdentityGsm.lac;
                 cellInfoGsm->cellIdentityGsm.cid =
@@ -7838,12 +8121,13 @@ void convertRilCellInfoListToHal(void *response, size_t responseLen, hidl_vec<Ce
             }
 
             case RIL_CELL_INFO_TYPE_WCDMA: {
-                records[i].wcdma.resize(1);
                 CellInfoWcdma *cellInfoWcdma = &records[i].wcdma[0];
-                cellInfoWcdma->cellIdentityWcdma.mcc =
-                        ril::util::mcc::decode(rillCellInfo->CellInfo.wcdma.cellIdentityWcdma.mcc);
-                cellInfoWcdma->cellIdentityWcdma.mnc =
-                        ril::util::mnc::decode(rillCellInfo->CellInfo.wcdma.cellIdentityWcdma.mnc);
+                setHidlString(cellInfoWcdma->cellIdentityWcdma.mcc,
+                        ril::util::mcc::decodeStr(
+                                rillCellInfo->CellInfo.wcdma.cellIdentityWcdma.mcc));
+                setHidlString(cellInfoWcdma->cellIdentityWcdma.mnc,
+                        ril::util::mnc::decodeStr(
+                                rillCellInfo->CellInfo.wcdma.cellIdentityWcdma.mnc));
                 cellInfoWcdma->cellIdentityWcdma.lac =
                         rillCellInfo->CellInfo.wcdma.cellIdentityWcdma.lac;
                 cellInfoWcdma->cellIdentityWcdma.cid =
@@ -7860,7 +8144,6 @@ void convertRilCellInfoListToHal(void *response, size_t responseLen, hidl_vec<Ce
             }
 
             case RIL_CELL_INFO_TYPE_CDMA: {
-                records[i].cdma.resize(1);
                 CellInfoCdma *cellInfoCdma = &records[i].cdma[0];
                 cellInfoCdma->cellIdentityCdma.networkId =
                         rillCellInfo->CellInfo.cdma.cellIdentityCdma.networkId;
@@ -7886,12 +8169,13 @@ void convertRilCellInfoListToHal(void *response, size_t responseLen, hidl_vec<Ce
             }
 
             case RIL_CELL_INFO_TYPE_LTE: {
-                records[i].lte.resize(1);
                 CellInfoLte *cellInfoLte = &records[i].lte[0];
-                cellInfoLte->cellIdentityLte.mcc =
-                        ril::util::mcc::decode(rillCellInfo->CellInfo.lte.cellIdentityLte.mcc);
-                cellInfoLte->cellIdentityLte.mnc =
-                        ril::util::mnc::decode(rillCellInfo->CellInfo.lte.cellIdentityLte.mnc);
+                setHidlString(cellInfoLte->cellIdentityLte.mcc,
+                        ril::util::mcc::decodeStr(
+                                rillCellInfo->CellInfo.lte.cellIdentityLte.mcc));
+                setHidlString(cellInfoLte->cellIdentityLte.mnc,
+                        ril::util::mnc::decodeStr(
+                                rillCellInfo->CellInfo.lte.cellIdentityLte.mnc));
                 cellInfoLte->cellIdentityLte.ci =
                         rillCellInfo->CellInfo.lte.cellIdentityLte.ci;
                 cellInfoLte->cellIdentityLte.pci =
@@ -7916,14 +8200,13 @@ void convertRilCellInfoListToHal(void *response, size_t responseLen, hidl_vec<Ce
             }
 
             case RIL_CELL_INFO_TYPE_TD_SCDMA: {
-                records[i].tdscdma.resize(1);
                 CellInfoTdscdma *cellInfoTdscdma = &records[i].tdscdma[0];
-                cellInfoTdscdma->cellIdentityTdscdma.mcc =
-                        ril::util::mcc::decode(
-                                rillCellInfo->CellInfo.tdscdma.cellIdentityTdscdma.mcc);
-                cellInfoTdscdma->cellIdentityTdscdma.mnc =
-                        ril::util::mnc::decode(
-                                rillCellInfo->CellInfo.tdscdma.cellIdentityTdscdma.mnc);
+                setHidlString(cellInfoTdscdma->cellIdentityTdscdma.mcc,
+                        ril::util::mcc::decodeStr(
+                                rillCellInfo->CellInfo.tdscdma.cellIdentityTdscdma.mcc));
+                setHidlString(cellInfoTdscdma->cellIdentityTdscdma.mnc,
+                        ril::util::mnc::decodeStr(
+                                rillCellInfo->CellInfo.tdscdma.cellIdentityTdscdma.mnc));
                 cellInfoTdscdma->cellIdentityTdscdma.lac =
                         rillCellInfo->CellInfo.tdscdma.cellIdentityTdscdma.lac;
                 cellInfoTdscdma->cellIdentityTdscdma.cid =
@@ -7945,19 +8228,21 @@ void convertRilCellInfoListToHal(void *response, size_t responseLen, hidl_vec<Ce
 int radio::cellInfoListInd(int slotId,
                            int indicationType, int token, RIL_Errno e, void *response,
                            size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if ((response == NULL && responseLen != 0) || responseLen % sizeof(RIL_CellInfo_v12) != 0) {
             RLOGE("cellInfoListInd: invalid response");
             return 0;
         }
 
-        hidl_vec<CellInfo> records;
+        ScratchVec<CellInfo>& scratch = conversionScratch[slotId].cellInfoListInd;
+        std::lock_guard<std::mutex> lock(scratch.mutex);
+        hidl_vec<CellInfo>& records = scratch.vec;
         convertRilCellInfoListToHal(response, responseLen, records);
 
 #if VDBG
         RLOGD("cellInfoListInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->cellInfoList(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->cellInfoList(
                 convertIntToRadioIndicationType(indicationType), records);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7970,11 +8255,11 @@ int radio::cellInfoListInd(int slotId,
 int radio::imsNetworkStateChangedInd(int slotId,
                                      int indicationType, int token, RIL_Errno e, void *response,
                                      size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
 #if VDBG
         RLOGD("imsNetworkStateChangedInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->imsNetworkStateChanged(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->imsNetworkStateChanged(
                 convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -7988,7 +8273,7 @@ int radio::imsNetworkStateChangedInd(int slotId,
 int radio::subscriptionStatusChangedInd(int slotId,
                                         int indicationType, int token, RIL_Errno e, void *response,
                                         size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(int)) {
             RLOGE("subscriptionStatusChangedInd: invalid response");
             return 0;
@@ -7997,7 +8282,7 @@ int radio::subscriptionStatusChangedInd(int slotId,
 #if VDBG
         RLOGD("subscriptionStatusChangedInd: activate %d", activate);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->subscriptionStatusChanged(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->subscriptionStatusChanged(
                 convertIntToRadioIndicationType(indicationType), activate);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -8011,7 +8296,7 @@ int radio::subscriptionStatusChangedInd(int slotId,
 int radio::srvccStateNotifyInd(int slotId,
                                int indicationType, int token, RIL_Errno e, void *response,
                                size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(int)) {
             RLOGE("srvccStateNotifyInd: invalid response");
             return 0;
@@ -8020,7 +8305,7 @@ int radio::srvccStateNotifyInd(int slotId,
 #if VDBG
         RLOGD("srvccStateNotifyInd: rat %d", state);
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->srvccStateNotify(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->srvccStateNotify(
                 convertIntToRadioIndicationType(indicationType), (SrvccState) state);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -8033,17 +8318,19 @@ int radio::srvccStateNotifyInd(int slotId,
 void convertRilHardwareConfigListToHal(void *response, size_t responseLen,
         hidl_vec<HardwareConfig>& records) {
     int num = responseLen / sizeof(RIL_HardwareConfig);
-    records.resize(num);
+    resizeHidlVec(records, num);
 
     RIL_HardwareConfig *rilHardwareConfig = (RIL_HardwareConfig *) response;
     for (int i = 0; i < num; i++) {
         records[i].type = (HardwareConfigType) rilHardwareConfig[i].type;
-        records[i].uuid = convertCharPtrToHidlString(rilHardwareConfig[i].uuid);
+        setHidlString(records[i].uuid, rilHardwareConfig[i].uuid);
         records[i].state = (HardwareConfigState) rilHardwareConfig[i].state;
+        resizeHidlVec(records[i].modem,
+                rilHardwareConfig[i].type == RIL_HARDWARE_CONFIG_MODEM ? 1 : 0);
+        resizeHidlVec(records[i].sim,
+                rilHardwareConfig[i].type == RIL_HARDWARE_CONFIG_SIM ? 1 : 0);
         switch (rilHardwareConfig[i].type) {
             case RIL_HARDWARE_CONFIG_MODEM: {
-                records[i].modem.resize(1);
-                records[i].sim.resize(0);
                 HardwareConfigModem *hwConfigModem = &records[i].modem[0];
                 hwConfigModem->rat = rilHardwareConfig[i].cfg.modem.rat;
                 hwConfigModem->maxVoice = rilHardwareConfig[i].cfg.modem.maxVoice;
@@ -8053,10 +8340,8 @@ void convertRilHardwareConfigListToHal(void *response, size_t responseLen,
             }
 
             case RIL_HARDWARE_CONFIG_SIM: {
-                records[i].sim.resize(1);
-                records[i].modem.resize(0);
-                records[i].sim[0].modemUuid =
-                        convertCharPtrToHidlString(rilHardwareConfig[i].cfg.sim.modemUuid);
+                setHidlString(records[i].sim[0].modemUuid,
+                        rilHardwareConfig[i].cfg.sim.modemUuid);
                 break;
             }
         }
@@ -8066,20 +8351,22 @@ void convertRilHardwareConfigListToHal(void *response, size_t responseLen,
 int radio::hardwareConfigChangedInd(int slotId,
                                     int indicationType, int token, RIL_Errno e, void *response,
                                     size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if ((response == NULL && responseLen != 0)
                 || responseLen % sizeof(RIL_HardwareConfig) != 0) {
             RLOGE("hardwareConfigChangedInd: invalid response");
             return 0;
         }
 
-        hidl_vec<HardwareConfig> configs;
+        ScratchVec<HardwareConfig>& scratch = conversionScratch[slotId].hardwareConfigInd;
+        std::lock_guard<std::mutex> lock(scratch.mutex);
+        hidl_vec<HardwareConfig>& configs = scratch.vec;
         convertRilHardwareConfigListToHal(response, responseLen, configs);
 
 #if VDBG
         RLOGD("hardwareConfigChangedInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->hardwareConfigChanged(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->hardwareConfigChanged(
                 convertIntToRadioIndicationType(indicationType), configs);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -8102,7 +8389,7 @@ void convertRilRadioCapabilityToHal(void *response, size_t responseLen, RadioCap
 int radio::radioCapabilityIndicationInd(int slotId,
                                         int indicationType, int token, RIL_Errno e, void *response,
                                         size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(RIL_RadioCapability)) {
             RLOGE("radioCapabilityIndicationInd: invalid response");
             return 0;
@@ -8114,7 +8401,7 @@ int radio::radioCapabilityIndicationInd(int slotId,
 #if VDBG
         RLOGD("radioCapabilityIndicationInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->radioCapabilityIndication(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->radioCapabilityIndication(
                 convertIntToRadioIndicationType(indicationType), rc);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -8141,7 +8428,7 @@ bool isServiceTypeCfQuery(RIL_SsServiceType serType, RIL_SsRequestType reqType)
 int radio::onSupplementaryServiceIndicationInd(int slotId,
                                                int indicationType, int token, RIL_Errno e,
                                                void *response, size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(RIL_StkCcUnsolSsResponse)) {
             RLOGE("onSupplementaryServiceIndicationInd: invalid response");
             return 0;
@@ -8206,7 +8493,7 @@ int radio::onSupplementaryServiceIndicationInd(int slotId,
 #if VDBG
         RLOGD("onSupplementaryServiceIndicationInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->
+        Return<void> retStatus = radioCallbacks(slotId)->indication->
                 onSupplementaryServiceIndication(convertIntToRadioIndicationType(indicationType),
                 ss);
         radioService[slotId]->checkReturnStatus(retStatus);
@@ -8221,7 +8508,7 @@ int radio::onSupplementaryServiceIndicationInd(int slotId,
 int radio::stkCallControlAlphaNotifyInd(int slotId,
                                         int indicationType, int token, RIL_Errno e, void *response,
                                         size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen == 0) {
             RLOGE("stkCallControlAlphaNotifyInd: invalid response");
             return 0;
@@ -8229,7 +8516,7 @@ int radio::stkCallControlAlphaNotifyInd(int slotId,
 #if VDBG
         RLOGD("stkCallControlAlphaNotifyInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->stkCallControlAlphaNotify(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->stkCallControlAlphaNotify(
                 convertIntToRadioIndicationType(indicationType),
                 convertCharPtrToHidlString((char *) response));
         radioService[slotId]->checkReturnStatus(retStatus);
@@ -8251,7 +8538,7 @@ void convertRilLceDataInfoToHal(void *response, size_t responseLen, LceDataInfo&
 int radio::lceDataInd(int slotId,
                       int indicationType, int token, RIL_Errno e, void *response,
                       size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(RIL_LceDataInfo)) {
             RLOGE("lceDataInd: invalid response");
             return 0;
@@ -8262,7 +8549,7 @@ int radio::lceDataInd(int slotId,
 #if VDBG
         RLOGD("lceDataInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->lceData(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->lceData(
                 convertIntToRadioIndicationType(indicationType), lce);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -8275,7 +8562,7 @@ int radio::lceDataInd(int slotId,
 int radio::pcoDataInd(int slotId,
                       int indicationType, int token, RIL_Errno e, void *response,
                       size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen != sizeof(RIL_PCO_Data)) {
             RLOGE("pcoDataInd: invalid response");
             return 0;
@@ -8291,7 +8578,7 @@ int radio::pcoDataInd(int slotId,
 #if VDBG
         RLOGD("pcoDataInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->pcoData(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->pcoData(
                 convertIntToRadioIndicationType(indicationType), pco);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -8304,7 +8591,7 @@ int radio::pcoDataInd(int slotId,
 int radio::modemResetInd(int slotId,
                          int indicationType, int token, RIL_Errno e, void *response,
                          size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndication != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indication != NULL) {
         if (response == NULL || responseLen == 0) {
             RLOGE("modemResetInd: invalid response");
             return 0;
@@ -8312,7 +8599,7 @@ int radio::modemResetInd(int slotId,
 #if VDBG
         RLOGD("modemResetInd");
 #endif
-        Return<void> retStatus = radioService[slotId]->mRadioIndication->modemReset(
+        Return<void> retStatus = radioCallbacks(slotId)->indication->modemReset(
                 convertIntToRadioIndicationType(indicationType),
                 convertCharPtrToHidlString((char *) response));
         radioService[slotId]->checkReturnStatus(retStatus);
@@ -8329,7 +8616,7 @@ int radio::networkScanResultInd(int slotId,
 #if VDBG
     RLOGD("networkScanResultInd");
 #endif
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndicationV1_1 != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indicationV1_1 != NULL) {
         if (response == NULL || responseLen == 0) {
             RLOGE("networkScanResultInd: invalid response");
             return 0;
@@ -8350,7 +8637,7 @@ int radio::networkScanResultInd(int slotId,
                 networkScanResult->network_infos_length * sizeof(RIL_CellInfo_v12),
                 result.networkInfos);
 
-        Return<void> retStatus = radioService[slotId]->mRadioIndicationV1_1->networkScanResult(
+        Return<void> retStatus = radioCallbacks(slotId)->indicationV1_1->networkScanResult(
                 convertIntToRadioIndicationType(indicationType), result);
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -8362,13 +8649,13 @@ int radio::networkScanResultInd(int slotId,
 int radio::carrierInfoForImsiEncryption(int slotId,
                                   int indicationType, int token, RIL_Errno e, void *response,
                                   size_t responseLen) {
-    if (radioService[slotId] != NULL && radioService[slotId]->mRadioIndicationV1_1 != NULL) {
+    if (radioService[slotId] != NULL && radioCallbacks(slotId)->indicationV1_1 != NULL) {
         if (response == NULL || responseLen == 0) {
             RLOGE("carrierInfoForImsiEncryption: invalid response");
             return 0;
         }
         RLOGD("carrierInfoForImsiEncryption");
-        Return<void> retStatus = radioService[slotId]->mRadioIndicationV1_1->
+        Return<void> retStatus = radioCallbacks(slotId)->indicationV1_1->
                 carrierInfoForImsiEncryption(convertIntToRadioIndicationType(indicationType));
         radioService[slotId]->checkReturnStatus(retStatus);
     } else {
@@ -8385,13 +8672,13 @@ int radio::keepaliveStatusInd(int slotId,
 #if VDBG
     RLOGD("%s(): token=%d", __FUNCTION__, token);
 #endif
-    if (radioService[slotId] == NULL || radioService[slotId]->mRadioIndication == NULL) {
+    if (radioService[slotId] == NULL || radioCallbacks(slotId)->indication == NULL) {
         RLOGE("%s: radioService[%d]->mRadioIndication == NULL", __FUNCTION__, slotId);
         return 0;
     }
 
     auto ret = V1_1::IRadioIndication::castFrom(
-        radioService[slotId]->mRadioIndication);
+        radioCallbacks(slotId)->indication);
     if (!ret.isOk()) {
         RLOGE("%s: ret.isOk() == false for radioService[%d]", __FUNCTION__, slotId);
         return 0;
@@ -8435,7 +8722,14 @@ void radio::registerService(RIL_RadioFunctions *callbacks, CommandInfo *commands
     s_vendorFunctions = callbacks;
     s_commands = commands;
 
-    configureRpcThreadpool(1, true /* callerWillJoin */);
+    int binderThreads = property_get_int32(PROPERTY_BINDER_THREADS, 1);
+    if (binderThreads < 1 || binderThreads > MAX_BINDER_THREADS) {
+        RLOGE("registerService: ignoring %s=%d", PROPERTY_BINDER_THREADS, binderThreads);
+        binderThreads = 1;
+    }
+    RLOGI("registerService: %d binder thread(s)", binderThreads);
+
+    configureRpcThreadpool(binderThreads, true /* callerWillJoin */);
     for (int i = 0; i < simCount; i++) {
         pthread_rwlock_t *radioServiceRwlockPtr = getRadioServiceRwlock(i);
         int ret = pthread_rwlock_wrlock(radioServiceRwlockPtr);
@@ -8472,7 +8766,19 @@ pthread_rwlock_t * radio::getRadioServiceRwlock(int slotId) {
     return radioServiceRwlockPtr;
 }
 
-// should acquire write lock for the corresponding service before calling this
+sp<V1_1::IRadio> radio::getRadioService(int slotId) {
+    pthread_rwlock_t *radioServiceRwlockPtr = getRadioServiceRwlock(slotId);
+    int ret = pthread_rwlock_rdlock(radioServiceRwlockPtr);
+    assert(ret == 0);
+
+    sp<V1_1::IRadio> service = radioService[slotId];
+
+    ret = pthread_rwlock_unlock(radioServiceRwlockPtr);
+    assert(ret == 0);
+    return service;
+}
+
+// caller serializes this with the NITZ indication, which reads nitzTimeReceived
 void radio::setNitzTimeReceived(int slotId, int64_t timeReceived) {
     nitzTimeReceived[slotId] = timeReceived;
 }
@@ -17,6 +17,7 @@
 #ifndef RIL_SERVICE_H
 #define RIL_SERVICE_H
 
+#include <android/hardware/radio/1.1/IRadio.h>
 #include <telephony/ril.h>
 #include <ril_internal.h>
 
@@ -731,6 +732,28 @@ int carrierInfoForImsiEncryption(int slotId,
 
 pthread_rwlock_t * getRadioServiceRwlock(int slotId);
 
+struct RadioCallbacks;
+
+/**
+ * Read-side section over a slot's IRadioResponse / IRadioIndication
+ * callbacks; hold one around every call into the response and indication
+ * functions. Never blocks. The callbacks it sees stay alive until it ends,
+ * even if setResponseFunctions() replaces them meanwhile.
+ */
+class CallbacksReader {
+  public:
+    explicit CallbacksReader(int slotId);
+    ~CallbacksReader();
+
+  private:
+    int mSlotId;
+    uint32_t mPhase;
+    const RadioCallbacks *mOuter;
+};
+
+// In-process handle on a slot's IRadio service, for libril-bench
+android::sp<android::hardware::radio::V1_1::IRadio> getRadioService(int slotId);
+
 void setNitzTimeReceived(int slotId, int64_t timeReceived);
 
 }   // namespace radio
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "RILC"
+
+#include <telephony/ril.h>
+#include <utils/Log.h>
+#include <atomic>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ril_internal.h>
+#include <ril_stats.h>
+
+namespace android {
+
+/*
+ * Bucket 0 holds latencies below 1us, bucket i (i > 0) holds [2^(i-1), 2^i) us
+ * and the last bucket everything from ~67s up.
+ */
+#define LATENCY_BUCKETS 28
+
+typedef struct {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> totalNs;
+    std::atomic<uint64_t> maxNs;
+    std::atomic<uint32_t> buckets[LATENCY_BUCKETS];
+} LatencyHistogram;
+
+typedef struct {
+    LatencyHistogram toAck;         // dispatch -> RIL_onRequestAck
+    LatencyHistogram toComplete;    // dispatch -> RIL_onRequestComplete
+    LatencyHistogram inResponse;    // inside responseFunction
+} RequestStats;
+
+typedef struct {
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> wakeLocks;    // deliveries that grabbed the partial wake lock
+    std::atomic<uint64_t> coalesced;    // dropped in favour of a newer payload
+    LatencyHistogram deliver;           // inside responseFunction, i.e. the HIDL call
+} UnsolResponseStats;
+
+typedef struct {
+    LatencyHistogram queued;            // waiting for the slot's earlier requests
+    LatencyHistogram onRequest;         // inside the vendor's onRequest()
+} DispatchStats;
+
+static std::atomic<RequestStats *> s_requestStats(NULL);
+static int s_numRequests = 0;
+static std::atomic<UnsolResponseStats *> s_unsolStats(NULL);
+static int s_numUnsolResponses = 0;
+static DispatchStats s_dispatchStats[SIM_COUNT];
+
+static int latencyBucket(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    if (us == 0) {
+        return 0;
+    }
+    int bucket = 64 - __builtin_clzll(us);
+    return (bucket < LATENCY_BUCKETS) ? bucket : LATENCY_BUCKETS - 1;
+}
+
+static void histogramRecord(LatencyHistogram *h, uint64_t ns) {
+    h->count.fetch_add(1, std::memory_order_relaxed);
+    h->totalNs.fetch_add(ns, std::memory_order_relaxed);
+    h->buckets[latencyBucket(ns)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = h->maxNs.load(std::memory_order_relaxed);
+    while (ns > max && !h->maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+/** Upper bound, in us, of the bucket holding the given percentile */
+static uint64_t histogramPercentileUs(LatencyHistogram *h, uint64_t count, int percentile) {
+    uint64_t target = (count * percentile + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += h->buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return 1ULL << i;
+        }
+    }
+    return 1ULL << (LATENCY_BUCKETS - 1);
+}
+
+static void histogramDump(int fd, const char *label, LatencyHistogram *h) {
+    uint64_t count = h->count.load(std::memory_order_relaxed);
+    if (count == 0) {
+        return;
+    }
+    dprintf(fd, "    %-9s n=%" PRIu64 " avg=%" PRIu64 "us p50<%" PRIu64 "us p90<%" PRIu64
+            "us p99<%" PRIu64 "us max=%" PRIu64 "us\n",
+            label, count,
+            h->totalNs.load(std::memory_order_relaxed) / count / 1000,
+            histogramPercentileUs(h, count, 50),
+            histogramPercentileUs(h, count, 90),
+            histogramPercentileUs(h, count, 99),
+            h->maxNs.load(std::memory_order_relaxed) / 1000);
+}
+
+void statsInit(int numRequests, int numUnsolResponses) {
+    // calloc'ed memory is a valid all-zero state for the atomics
+    if (s_requestStats.load() == NULL) {
+        RequestStats *stats = (RequestStats *) calloc(numRequests, sizeof(RequestStats));
+        if (stats == NULL) {
+            RLOGE("statsInit: memory allocation failed, request stats disabled");
+        } else {
+            s_numRequests = numRequests;
+            s_requestStats.store(stats, std::memory_order_release);
+        }
+    }
+
+    if (s_unsolStats.load() == NULL) {
+        UnsolResponseStats *stats = (UnsolResponseStats *) calloc(numUnsolResponses,
+                sizeof(UnsolResponseStats));
+        if (stats == NULL) {
+            RLOGE("statsInit: memory allocation failed, indication stats disabled");
+        } else {
+            s_numUnsolResponses = numUnsolResponses;
+            s_unsolStats.store(stats, std::memory_order_release);
+        }
+    }
+}
+
+static RequestStats *getRequestStats(int request) {
+    RequestStats *stats = s_requestStats.load(std::memory_order_acquire);
+    if (stats == NULL || request < 0 || request >= s_numRequests) {
+        return NULL;
+    }
+    return &stats[request];
+}
+
+void statsRecordRequestAck(int request, uint64_t latencyNs) {
+    RequestStats *stats = getRequestStats(request);
+    if (stats != NULL) {
+        histogramRecord(&stats->toAck, latencyNs);
+    }
+}
+
+void statsRecordRequestComplete(int request, uint64_t latencyNs, uint64_t responseNs) {
+    RequestStats *stats = getRequestStats(request);
+    if (stats != NULL) {
+        histogramRecord(&stats->toComplete, latencyNs);
+        histogramRecord(&stats->inResponse, responseNs);
+    }
+}
+
+void statsRecordUnsolResponse(int unsolIndex, size_t datalen, bool wakeLock,
+        uint64_t deliverNs) {
+    UnsolResponseStats *stats = s_unsolStats.load(std::memory_order_acquire);
+    if (stats == NULL || unsolIndex < 0 || unsolIndex >= s_numUnsolResponses) {
+        return;
+    }
+    stats += unsolIndex;
+    stats->bytes.fetch_add(datalen, std::memory_order_relaxed);
+    if (wakeLock) {
+        stats->wakeLocks.fetch_add(1, std::memory_order_relaxed);
+    }
+    // deliver.count doubles as the indication count
+    histogramRecord(&stats->deliver, deliverNs);
+}
+
+void statsRecordUnsolCoalesced(int unsolIndex) {
+    UnsolResponseStats *stats = s_unsolStats.load(std::memory_order_acquire);
+    if (stats != NULL && unsolIndex >= 0 && unsolIndex < s_numUnsolResponses) {
+        stats[unsolIndex].coalesced.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void statsRecordDispatch(int slotId, uint64_t queuedNs, uint64_t onRequestNs) {
+    if (slotId < 0 || slotId >= SIM_COUNT) {
+        return;
+    }
+    histogramRecord(&s_dispatchStats[slotId].queued, queuedNs);
+    histogramRecord(&s_dispatchStats[slotId].onRequest, onRequestNs);
+}
+
+static void poolStatsDump(int fd, const char *label, const Ril_pool_stats *stats) {
+    dprintf(fd, "  %-16s capacity=%u inUse=%u highWater=%u allocs=%" PRIu64
+            " fallbacks=%" PRIu64 "\n", label, stats->capacity, stats->inUse,
+            stats->highWater, stats->allocs, stats->fallbacks);
+}
+
+void statsDump(int fd) {
+    Ril_pool_stats poolStats;
+
+    dprintf(fd, "Allocation pools:\n");
+    getRequestInfoPoolStats(&poolStats);
+    poolStatsDump(fd, "RequestInfo", &poolStats);
+    getUserCallbackInfoPoolStats(&poolStats);
+    poolStatsDump(fd, "UserCallbackInfo", &poolStats);
+
+    dprintf(fd, "Event loop wakeups:\n");
+    for (int i = 0; i < SIM_COUNT; i++) {
+        uint64_t issued, coalesced;
+        getEventLoopWakeupStats((RIL_SOCKET_ID) i, &issued, &coalesced);
+        dprintf(fd, "  slot%d issued=%" PRIu64 " coalesced=%" PRIu64 "\n",
+                i + 1, issued, coalesced);
+    }
+
+    dprintf(fd, "Request dispatch:\n");
+    for (int i = 0; i < SIM_COUNT; i++) {
+        if (s_dispatchStats[i].onRequest.count.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        dprintf(fd, "  slot%d\n", i + 1);
+        histogramDump(fd, "queued", &s_dispatchStats[i].queued);
+        histogramDump(fd, "onRequest", &s_dispatchStats[i].onRequest);
+    }
+
+    dprintf(fd, "Request latency:\n");
+    RequestStats *stats = s_requestStats.load(std::memory_order_acquire);
+    for (int i = 0; stats != NULL && i < s_numRequests; i++) {
+        if (stats[i].toAck.count.load(std::memory_order_relaxed) == 0
+                && stats[i].toComplete.count.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        dprintf(fd, "  %s\n", requestToString(i));
+        histogramDump(fd, "ack", &stats[i].toAck);
+        histogramDump(fd, "complete", &stats[i].toComplete);
+        histogramDump(fd, "response", &stats[i].inResponse);
+    }
+
+    dprintf(fd, "Unsolicited responses:\n");
+    UnsolResponseStats *unsolStats = s_unsolStats.load(std::memory_order_acquire);
+    for (int i = 0; unsolStats != NULL && i < s_numUnsolResponses; i++) {
+        uint64_t count = unsolStats[i].deliver.count.load(std::memory_order_relaxed);
+        if (count == 0 && unsolStats[i].coalesced.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        dprintf(fd, "  %s count=%" PRIu64 " bytes=%" PRIu64 " wakeLocks=%" PRIu64
+                " coalesced=%" PRIu64 "\n",
+                requestToString(i + RIL_UNSOL_RESPONSE_BASE), count,
+                unsolStats[i].bytes.load(std::memory_order_relaxed),
+                unsolStats[i].wakeLocks.load(std::memory_order_relaxed),
+                unsolStats[i].coalesced.load(std::memory_order_relaxed));
+        histogramDump(fd, "deliver", &unsolStats[i].deliver);
+    }
+}
+
+}   // namespace android
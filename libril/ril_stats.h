@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RIL_STATS_H
+#define RIL_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace android {
+
+/**
+ * Runtime instrumentation for libril. All recording calls are lock-free and
+ * may be made from any thread; they are no-ops until statsInit() has run.
+ */
+
+// Allocate the per-request and per-indication counters. Called once from
+// RIL_register.
+void statsInit(int numRequests, int numUnsolResponses);
+
+// Time from addRequestToList() to RIL_onRequestAck()
+void statsRecordRequestAck(int request, uint64_t latencyNs);
+
+// Time from addRequestToList() to RIL_onRequestComplete(), and the part of
+// it spent inside the request's responseFunction
+void statsRecordRequestComplete(int request, uint64_t latencyNs, uint64_t responseNs);
+
+// One delivery of indication RIL_UNSOL_RESPONSE_BASE + unsolIndex with a
+// datalen payload; deliverNs is the time spent inside its responseFunction
+void statsRecordUnsolResponse(int unsolIndex, size_t datalen, bool wakeLock,
+        uint64_t deliverNs);
+
+// An indication held for coalescing was replaced by a newer one before it
+// could be delivered
+void statsRecordUnsolCoalesced(int unsolIndex);
+
+// One request handed to slotId's onRequest(): queuedNs waiting behind other
+// requests for the slot, onRequestNs inside the vendor's onRequest()
+void statsRecordDispatch(int slotId, uint64_t queuedNs, uint64_t onRequestNs);
+
+// Write all counters in human readable form to fd
+void statsDump(int fd);
+
+}   // namespace android
+
+#endif  // RIL_STATS_H
@@ -18,6 +18,9 @@
 #include "at_tok.h"
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 /**
@@ -87,16 +90,72 @@ static char * nextTok(char **p_cur)
 }
 
 
+/**
+ * Decodes the integer at the start of s without strtol(), so there is no
+ * locale lookup or errno. Leading whitespace is skipped; base 10 takes an
+ * optional sign, base 16 an optional "0x". Base 16 values use all 32 bits.
+ * On success *p_end is just past the last digit.
+ * returns AT_TOK_OK, AT_TOK_ERR_SYNTAX if there are no digits,
+ * or AT_TOK_ERR_RANGE if the value does not fit in an int
+ */
+static int decodeInt(const char *s, int base, int *p_out, const char **p_end)
+{
+    const char *digits;
+    uint32_t value = 0;
+    uint32_t limit = INT_MAX;
+    int negative = 0;
+
+    while (isspace((unsigned char) *s)) s++;
+
+    if (base == 10) {
+        if (*s == '-' || *s == '+') {
+            negative = (*s == '-');
+            limit += negative;
+            s++;
+        }
+        for (digits = s; ; s++) {
+            uint32_t d = (unsigned char) *s - '0';
+            if (d > 9) break;
+            if (value > (limit - d) / 10) return AT_TOK_ERR_RANGE;
+            value = value * 10 + d;
+        }
+    } else {
+        limit = UINT32_MAX;
+        if (s[0] == '0' && (s[1] | 0x20) == 'x' && isxdigit((unsigned char) s[2])) {
+            s += 2;
+        }
+        for (digits = s; ; s++) {
+            uint32_t d = (unsigned char) *s - '0';
+            if (d > 9) {
+                d = ((unsigned char) *s | 0x20) - 'a';
+                if (d > 5) break;
+                d += 10;
+            }
+            if (value > (limit - d) / 16) return AT_TOK_ERR_RANGE;
+            value = value * 16 + d;
+        }
+    }
+
+    if (s == digits) {
+        return AT_TOK_ERR_SYNTAX;
+    }
+
+    *p_out = negative ? (int) (0u - value) : (int) value;
+    *p_end = s;
+    return AT_TOK_OK;
+}
+
 /**
  * Parses the next integer in the AT response line and places it in *p_out
  * returns 0 on success and -1 on fail
  * updates *p_cur
- * "base" is the same as the base param in strtol
+ * "base" is 10 or 16
  */
 
-static int at_tok_nextint_base(char **p_cur, int *p_out, int base, int  uns)
+static int at_tok_nextint_base(char **p_cur, int *p_out, int base)
 {
     char *ret;
+    const char *end;
 
     if (*p_cur == NULL) {
         return -1;
@@ -106,20 +165,12 @@ static int at_tok_nextint_base(char **p_cur, int *p_out, int base, int  uns)
 
     if (ret == NULL) {
         return -1;
-    } else {
-        long l;
-        char *end;
-
-        if (uns)
-            l = strtoul(ret, &end, base);
-        else
-            l = strtol(ret, &end, base);
+    }
 
-        *p_out = (int)l;
+    *p_out = 0;
 
-        if (end == ret) {
-            return -1;
-        }
+    if (decodeInt(ret, base, p_out, &end) != AT_TOK_OK) {
+        return -1;
     }
 
     return 0;
@@ -133,7 +184,7 @@ static int at_tok_nextint_base(char **p_cur, int *p_out, int base, int  uns)
  */
 int at_tok_nextint(char **p_cur, int *p_out)
 {
-    return at_tok_nextint_base(p_cur, p_out, 10, 0);
+    return at_tok_nextint_base(p_cur, p_out, 10);
 }
 
 /**
@@ -144,7 +195,7 @@ int at_tok_nextint(char **p_cur, int *p_out)
  */
 int at_tok_nexthexint(char **p_cur, int *p_out)
 {
-    return at_tok_nextint_base(p_cur, p_out, 16, 1);
+    return at_tok_nextint_base(p_cur, p_out, 16);
 }
 
 int at_tok_nextbool(char **p_cur, char *p_out)
@@ -188,3 +239,139 @@ int at_tok_hasmore(char **p_cur)
 }
 
 
+
+/**
+ * Finds the extent of the next field without modifying the line
+ * *p_start and *p_len get the field contents, quotes excluded
+ * returns a pointer past the field's trailing comma, or to the \0
+ */
+const char *at_tok_field(const char *p, const char **p_start, size_t *p_len)
+{
+    const char *end;
+
+    while (isspace((unsigned char) *p)) p++;
+
+    if (*p == '"') {
+        p++;
+        end = strchr(p, '"');
+        if (end == NULL) {
+            end = p + strlen(p);
+        }
+        *p_start = p;
+        *p_len = end - p;
+        p = (*end == '"') ? end + 1 : end;
+    } else {
+        *p_start = p;
+        p += strcspn(p, ",");
+        *p_len = p - *p_start;
+    }
+
+    p += strcspn(p, ",");
+    return (*p == ',') ? p + 1 : p;
+}
+
+/**
+ * Decodes a field found by at_tok_field() as an integer; only whitespace
+ * may follow the digits
+ * returns AT_TOK_OK or AT_TOK_ERR_*
+ */
+int at_tok_fieldint(const char *start, size_t len, int base, int *p_out)
+{
+    const char *end;
+    const char *limit = start + len;
+    int value;
+    int err;
+
+    err = decodeInt(start, base, &value, &end);
+    if (err != AT_TOK_OK) {
+        return err;
+    }
+    if (end > limit) {
+        return AT_TOK_ERR_SYNTAX;
+    }
+    while (end < limit && isspace((unsigned char) *end)) end++;
+    if (end != limit) {
+        return AT_TOK_ERR_SYNTAX;
+    }
+
+    *p_out = value;
+    return AT_TOK_OK;
+}
+
+int at_tok_scan(char **p_cur, const char *format, ...)
+{
+    va_list ap;
+    const char *p = *p_cur;
+    int count = 0;
+    int err = AT_TOK_OK;
+    int canEnd = 0;
+
+    if (p == NULL) {
+        return AT_TOK_ERR_MISSING;
+    }
+
+    va_start(ap, format);
+
+    for (; *format != '\0'; format++) {
+        const char *start;
+        size_t len;
+        int value;
+
+        if (*format == '|') {
+            canEnd = 1;
+            continue;
+        }
+
+        if (*p == '\0') {
+            err = canEnd ? AT_TOK_OK : AT_TOK_ERR_MISSING;
+            break;
+        }
+        canEnd = 0;
+
+        p = at_tok_field(p, &start, &len);
+
+        switch (*format) {
+            case 'd':
+            case 'x':
+                err = at_tok_fieldint(start, len, *format == 'd' ? 10 : 16, &value);
+                if (err == AT_TOK_OK) {
+                    *va_arg(ap, int *) = value;
+                }
+                break;
+
+            case 'b':
+                err = at_tok_fieldint(start, len, 10, &value);
+                if (err == AT_TOK_OK && value != 0 && value != 1) {
+                    err = AT_TOK_ERR_RANGE;
+                }
+                if (err == AT_TOK_OK) {
+                    *va_arg(ap, char *) = (char) value;
+                }
+                break;
+
+            case 's':
+                /* terminate the field in place, like at_tok_nextstr() */
+                ((char *) start)[len] = '\0';
+                *va_arg(ap, char **) = (char *) start;
+                break;
+
+            case '_':
+                break;
+
+            default:
+                err = AT_TOK_ERR_FORMAT;
+                break;
+        }
+
+        if (err != AT_TOK_OK) {
+            break;
+        }
+        count++;
+    }
+
+    va_end(ap);
+
+    *p_cur = (char *) p;
+
+    return (err == AT_TOK_OK) ? count : err;
+}
@@ -18,6 +18,8 @@
 #ifndef AT_TOK_H
 #define AT_TOK_H 1
 
+#include <stddef.h>
+
 int at_tok_start(char **p_cur);
 int at_tok_nextint(char **p_cur, int *p_out);
 int at_tok_nexthexint(char **p_cur, int *p_out);
@@ -27,4 +29,41 @@ int at_tok_nextstr(char **p_cur, char **out);
 
 int at_tok_hasmore(char **p_cur);
 
+/* at_tok_scan() errors */
+#define AT_TOK_OK            0
+#define AT_TOK_ERR_MISSING  -1  /* line ended before a required field */
+#define AT_TOK_ERR_SYNTAX   -2  /* field is not a number */
+#define AT_TOK_ERR_RANGE    -3  /* number does not fit, or bool not 0/1 */
+#define AT_TOK_ERR_FORMAT   -4  /* unknown format character */
+
+/**
+ * Parses the fields of an AT response line in one call, from *p_cur
+ * (usually just after at_tok_start()) up to the end of the format
+ *
+ * Each format character consumes one comma separated field:
+ *   'd' base 10 int     -> int *
+ *   'x' base 16 int     -> int *
+ *   'b' 0 or 1          -> char *
+ *   's' string          -> char **, terminated in place like at_tok_nextstr
+ *   '_' skipped field
+ * and a '|' marks a point where the line is allowed to end
+ *
+ * Numeric fields must be the whole field, optionally quoted, and are
+ * decoded without strtol(). Lines are only modified by 's' fields.
+ *
+ * returns the number of fields consumed on success, AT_TOK_ERR_* on error
+ * updates *p_cur
+ */
+int at_tok_scan(char **p_cur, const char *format, ...);
+
+/* The field primitives under at_tok_scan(), for parsers that must not
+   modify the line. at_tok_field() finds the next field of p: *p_start and
+   *p_len get its contents, leading whitespace and quotes excluded. It
+   returns a pointer past the field's trailing comma, or to the \0 */
+const char *at_tok_field(const char *p, const char **p_start, size_t *p_len);
+
+/* Decodes a whole field as a base 10 or 16 int, by at_tok_scan()'s rules
+   returns AT_TOK_OK or AT_TOK_ERR_* */
+int at_tok_fieldint(const char *start, size_t len, int base, int *p_out);
+
 #endif /*AT_TOK_H */
@@ -0,0 +1,210 @@
+/* //device/system/reference-ril/at_urc.c
+**
+** Copyright 2026, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "at_urc.h"
+#include "at_tok.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define LOG_TAG "AT"
+#include <utils/Log.h>
+
+/*
+ * Registered prefixes are kept in a trie, one node per prefix character,
+ * so that dispatching a line costs one walk down the trie no matter how
+ * many handlers there are. Children of a node are a sibling list; the
+ * fan-out of AT prefixes is small.
+ */
+typedef struct {
+    char c;
+    int firstChild;     /* index into s_nodes, -1 if none */
+    int nextSibling;    /* index into s_nodes, -1 if none */
+    ATUrcHandler handler; /* set if a registered prefix ends here */
+} UrcTrieNode;
+
+static UrcTrieNode *s_nodes = NULL;
+static int s_numNodes = 0;
+static int s_nodesSize = 0;
+
+static int newNode(char c)
+{
+    if (s_numNodes == s_nodesSize) {
+        int size = s_nodesSize > 0 ? s_nodesSize * 2 : 64;
+        UrcTrieNode *p_nodes = (UrcTrieNode *) realloc(s_nodes, size * sizeof(UrcTrieNode));
+
+        if (p_nodes == NULL) {
+            return -1;
+        }
+        s_nodes = p_nodes;
+        s_nodesSize = size;
+    }
+
+    s_nodes[s_numNodes].c = c;
+    s_nodes[s_numNodes].firstChild = -1;
+    s_nodes[s_numNodes].nextSibling = -1;
+    s_nodes[s_numNodes].handler = NULL;
+
+    return s_numNodes++;
+}
+
+static int findChild(int node, char c)
+{
+    int child;
+
+    for (child = s_nodes[node].firstChild; child >= 0; child = s_nodes[child].nextSibling) {
+        if (s_nodes[child].c == c) {
+            return child;
+        }
+    }
+
+    return -1;
+}
+
+int at_urc_register(const char *prefix, ATUrcHandler handler)
+{
+    int node;
+
+    if (prefix == NULL || prefix[0] == '\0' || handler == NULL) {
+        return -1;
+    }
+
+    if (s_numNodes == 0 && newNode('\0') < 0) {
+        return -1;
+    }
+
+    node = 0;
+    for (; *prefix != '\0'; prefix++) {
+        int child = findChild(node, *prefix);
+
+        if (child < 0) {
+            child = newNode(*prefix);
+            if (child < 0) {
+                RLOGE("at_urc_register: out of memory");
+                return -1;
+            }
+            s_nodes[child].nextSibling = s_nodes[node].firstChild;
+            s_nodes[node].firstChild = child;
+        }
+        node = child;
+    }
+
+    s_nodes[node].handler = handler;
+
+    return 0;
+}
+
+/** fills in view->args from the text after the first ':', as at_tok would */
+static void tokenize(ATUrcView *view)
+{
+    const char *p = strchr(view->line, ':');
+
+    view->numArgs = 0;
+
+    if (p == NULL) {
+        return;
+    }
+    p++;
+
+    while (view->numArgs < AT_URC_MAX_ARGS) {
+        ATUrcArg *arg = &view->args[view->numArgs];
+        const char *next = at_tok_field(p, &arg->p, &arg->len);
+
+        view->numArgs++;
+
+        /* at_tok_field() stops at the \0 unless a comma was consumed */
+        if (next == p || next[-1] != ',') {
+            break;
+        }
+        p = next;
+    }
+}
+
+int at_urc_dispatch(const char *line, const char *sms_pdu)
+{
+    ATUrcHandler handler = NULL;
+    ATUrcView view;
+    const char *p;
+    int node = 0;
+
+    if (s_numNodes == 0 || line == NULL) {
+        return 0;
+    }
+
+    /* the longest registered prefix of line wins */
+    for (p = line; *p != '\0'; p++) {
+        node = findChild(node, *p);
+        if (node < 0) {
+            break;
+        }
+        if (s_nodes[node].handler != NULL) {
+            handler = s_nodes[node].handler;
+        }
+    }
+
+    if (handler == NULL) {
+        return 0;
+    }
+
+    view.line = line;
+    tokenize(&view);
+    handler(&view, sms_pdu);
+
+    return 1;
+}
+
+int at_urc_arg_int(const ATUrcView *view, int index, int *p_out)
+{
+    const ATUrcArg *arg;
+
+    if (index < 0 || index >= view->numArgs) {
+        return -1;
+    }
+    arg = &view->args[index];
+
+    return (at_tok_fieldint(arg->p, arg->len, 10, p_out) == AT_TOK_OK) ? 0 : -1;
+}
+
+int at_urc_arg_bool(const ATUrcView *view, int index, char *p_out)
+{
+    int value;
+
+    if (at_urc_arg_int(view, index, &value) < 0 || (value != 0 && value != 1)) {
+        return -1;
+    }
+
+    *p_out = (char) value;
+    return 0;
+}
+
+int at_urc_arg_str(const ATUrcView *view, int index, char *buf, size_t size)
+{
+    const ATUrcArg *arg;
+
+    if (index < 0 || index >= view->numArgs || size == 0) {
+        return -1;
+    }
+    arg = &view->args[index];
+
+    if (arg->len >= size) {
+        return -1;
+    }
+
+    memcpy(buf, arg->p, arg->len);
+    buf[arg->len] = '\0';
+    return 0;
+}
@@ -0,0 +1,67 @@
+/* //device/system/reference-ril/at_urc.h
+**
+** Copyright 2026, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef AT_URC_H
+#define AT_URC_H 1
+
+#include <stddef.h>
+
+/* arguments past this many are not tokenized */
+#define AT_URC_MAX_ARGS 16
+
+/** a piece of the URC line; not \0 terminated */
+typedef struct {
+    const char *p;
+    size_t len;
+} ATUrcArg;
+
+/**
+ * An unsolicited response split up for its handler, without copying
+ * "args" are the comma separated fields after the first ':', split by
+ * at_tok_field(): leading whitespace and quotes removed. Lines without a
+ * ':' have none
+ */
+typedef struct {
+    const char *line;
+    int numArgs;
+    ATUrcArg args[AT_URC_MAX_ARGS];
+} ATUrcView;
+
+/**
+ * "sms_pdu" is NULL except for the two-line TS 27.005 SMS responses
+ * Called on the reader thread, so do not block
+ */
+typedef void (*ATUrcHandler)(const ATUrcView *view, const char *sms_pdu);
+
+/* Registers handler for lines starting with prefix; the longest matching
+   prefix wins. Registering a prefix again replaces its handler.
+   Must not race with at_urc_dispatch(): register before at_open().
+   returns 0 on success, -1 on error */
+int at_urc_register(const char *prefix, ATUrcHandler handler);
+
+/* Calls the handler registered for line, if any
+   returns 1 if a handler was called, 0 otherwise */
+int at_urc_dispatch(const char *line, const char *sms_pdu);
+
+/* Argument accessors; return 0 on success, -1 if the argument is missing
+   or malformed */
+int at_urc_arg_int(const ATUrcView *view, int index, int *p_out);
+int at_urc_arg_bool(const ATUrcView *view, int index, char *p_out);
+/* copies the argument, \0 terminated, into buf */
+int at_urc_arg_str(const ATUrcView *view, int index, char *buf, size_t size);
+
+#endif /*AT_URC_H */
@@ -26,9 +26,16 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #define LOG_NDEBUG 0
 #define LOG_TAG "AT"
 #include <utils/Log.h>
@@ -38,19 +45,65 @@
 
 #define NUM_ELEMS(x) (sizeof(x)/sizeof((x)[0]))
 
+/* initial size of a channel's input buffer; it doubles for longer lines,
+   up to MAX_AT_LINE */
 #define MAX_AT_RESPONSE (8 * 1024)
+#define MAX_AT_LINE (512 * 1024)
 #define HANDSHAKE_RETRY_COUNT 8
 #define HANDSHAKE_TIMEOUT_MSEC 250
 
-static pthread_t s_tid_reader;
-static int s_fd = -1;    /* fd of the AT channel */
+/** a command waiting for, or receiving, its response */
+typedef struct ATCommand {
+    struct ATCommand *p_next;
+    const char *command;
+    ATCommandType type;
+    const char *responsePrefix;
+    const char *smsPDU;         /* cleared once the PDU has been sent */
+    ATResponse *p_response;
+    int done;                   /* synchronous commands: err is final */
+    int abandoned;              /* timed out after it was written; kept
+                                   queued to swallow its final response */
+    int err;
+    ATCommandCallback callback; /* NULL for synchronous commands */
+    void *param;
+} ATCommand;
+
+typedef struct {
+    int fd;
+    pthread_t tid_reader;
+    int readerClosed;
+
+    /* FIFO of commands. The first numWritten have been sent to the modem
+       and are matched to the final responses in order */
+    ATCommand *p_head;
+    ATCommand *p_tail;
+    int numWritten;
+    int numQueued;
+
+    /* finished asynchronous commands whose callback is still to be run */
+    ATCommand *p_completed;
+    ATCommand *p_completedTail;
+
+    /* for input buffering: a ring of ATBufferSize bytes, a power of two.
+       The positions are free running and taken modulo ATBufferSize;
+       [ATBufferHead, ATBufferTail) is unconsumed input, of which
+       [ATBufferHead, ATBufferScan) is known to hold no line terminator */
+    char *ATBuffer;
+    size_t ATBufferSize;
+    size_t ATBufferHead;
+    size_t ATBufferScan;
+    size_t ATBufferTail;
+
+    /* a line that wraps around the end of the ring is joined up here */
+    char *ATLine;
+    size_t ATLineSize;
+} ATChannel;
+
+static ATChannel s_channels[AT_MAX_CHANNELS];
+static int s_numChannels = 0;
+static int s_pipelineDepth = 1;
 static ATUnsolHandler s_unsolHandler;
 
-/* for input buffering */
-
-static char s_ATBuffer[MAX_AT_RESPONSE+1];
-static char *s_ATBufferCur = s_ATBuffer;
-
 #if AT_DEBUG
 void  AT_DUMP(const char*  prefix, const char*  buff, int  len)
 {
@@ -61,30 +114,26 @@ void  AT_DUMP(const char*  prefix, const char*  buff, int  len)
 #endif
 
 /*
- * There is one reader thread |s_tid_reader| and potentially multiple writer
- * threads. |s_commandmutex| and |s_commandcond| are used to maintain the
- * condition that the writer thread will not read from |sp_response| until the
- * reader thread has signaled itself is finished, etc. |s_writeMutex| is used to
- * prevent multiple writer threads from calling at_send_command_full_nolock
- * function at the same time.
+ * There is one reader thread per channel and potentially multiple writer
+ * threads. |s_commandmutex| protects the command queues of all channels.
+ * Writers append to a queue and, while fewer than |s_pipelineDepth| commands
+ * are outstanding, write the command to the modem right away; otherwise the
+ * reader thread writes it when an earlier one gets its final response.
+ * Synchronous callers wait on |s_commandcond| for their command to finish,
+ * asynchronous ones get their callback run without the mutex held.
  */
 
 static pthread_mutex_t s_commandmutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t s_commandcond = PTHREAD_COND_INITIALIZER;
-static pthread_mutex_t s_writeMutex = PTHREAD_MUTEX_INITIALIZER;
-
-static ATCommandType s_type;
-static const char *s_responsePrefix = NULL;
-static const char *s_smsPDU = NULL;
-static ATResponse *sp_response = NULL;
 
 static void (*s_onTimeout)(void) = NULL;
 static void (*s_onReaderClosed)(void) = NULL;
-static int s_readerClosed;
 
-static void onReaderClosed();
-static int writeCtrlZ (const char *s);
-static int writeline (const char *s);
+static void onReaderClosed(ATChannel *ch);
+static int writeCtrlZ (ATChannel *ch, const char *s);
+static int writeEsc (ATChannel *ch);
+static int writeline (ATChannel *ch, const char *s);
+static ATResponse * at_response_new();
 
 #define NS_PER_S 1000000000
 static void setTimespecRelative(struct timespec *p_ts, long long msec)
@@ -117,111 +166,431 @@ static void sleepMsec(long long msec)
 
 
 
-/** add an intermediate response to sp_response*/
-static void addIntermediate(const char *line)
+/**
+ * A chunk of an ATResponse's arena. The first one is allocated together
+ * with the response, later ones double in size
+ */
+typedef struct ATArenaBlock {
+    struct ATArenaBlock *p_next;
+    size_t used;
+    size_t size;
+    /* followed by "size" bytes of storage */
+} ATArenaBlock;
+
+/* room in the block allocated together with each ATResponse: enough for
+   the final response and a few short intermediate lines */
+#define AT_ARENA_FIRST_BLOCK 512
+
+#define AT_ARENA_ALIGN(n) (((n) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+/**
+ * Allocates "size" bytes from the response's arena
+ * returns NULL on allocation failure
+ */
+static void *arenaAlloc(ATResponse *p_response, size_t size)
 {
+    ATArenaBlock *p_block = p_response->p_arena;
+    char *ret;
+
+    size = AT_ARENA_ALIGN(size);
+
+    if (p_block->size - p_block->used < size) {
+        size_t blockSize = p_block->size * 2;
+        ATArenaBlock *p_new;
+
+        while (blockSize < size) {
+            blockSize *= 2;
+        }
+
+        p_new = (ATArenaBlock *) malloc(sizeof(ATArenaBlock) + blockSize);
+        if (p_new == NULL) {
+            return NULL;
+        }
+
+        p_new->p_next = p_block;
+        p_new->used = 0;
+        p_new->size = blockSize;
+        p_response->p_arena = p_block = p_new;
+    }
+
+    ret = (char *) (p_block + 1) + p_block->used;
+    p_block->used += size;
+
+    return ret;
+}
+
+static char *arenaStrdup(ATResponse *p_response, const char *s)
+{
+    size_t len = strlen(s) + 1;
+    char *ret = (char *) arenaAlloc(p_response, len);
+
+    if (ret != NULL) {
+        memcpy(ret, s, len);
+    }
+
+    return ret;
+}
+
+/** add an intermediate response to p_response, after the ones already there */
+static void addIntermediate(ATResponse *p_response, const char *line)
+{
+    size_t len = strlen(line) + 1;
     ATLine *p_new;
 
-    p_new = (ATLine  *) malloc(sizeof(ATLine));
+    if (p_response->numIntermediates == p_response->indexSize) {
+        int indexSize = p_response->indexSize > 0 ? p_response->indexSize * 2 : 8;
+        ATLine **pp_index = (ATLine **) arenaAlloc(p_response, indexSize * sizeof(ATLine *));
 
-    p_new->line = strdup(line);
+        if (pp_index == NULL) {
+            RLOGE("addIntermediate: out of memory, dropping line");
+            return;
+        }
+        if (p_response->numIntermediates > 0) {
+            memcpy(pp_index, p_response->pp_index,
+                    p_response->numIntermediates * sizeof(ATLine *));
+        }
+        p_response->pp_index = pp_index;
+        p_response->indexSize = indexSize;
+    }
+
+    /* the text goes right behind its ATLine */
+    p_new = (ATLine *) arenaAlloc(p_response, sizeof(ATLine) + len);
+
+    if (p_new == NULL) {
+        RLOGE("addIntermediate: out of memory, dropping line");
+        return;
+    }
 
-    /* note: this adds to the head of the list, so the list
-       will be in reverse order of lines received. the order is flipped
-       again before passing on to the command issuer */
-    p_new->p_next = sp_response->p_intermediates;
-    sp_response->p_intermediates = p_new;
+    p_new->line = (char *) (p_new + 1);
+    memcpy(p_new->line, line, len);
+    p_new->p_next = NULL;
+
+    if (p_response->p_lastIntermediate == NULL) {
+        p_response->p_intermediates = p_new;
+    } else {
+        p_response->p_lastIntermediate->p_next = p_new;
+    }
+    p_response->p_lastIntermediate = p_new;
+    p_response->pp_index[p_response->numIntermediates++] = p_new;
 }
 
 
+typedef enum {
+    LINE_OTHER,
+    LINE_FINAL_SUCCESS,     /* final response indicating success */
+    LINE_FINAL_ERROR,       /* final response indicating error */
+    LINE_SMS_UNSOLICITED    /* first line in (what will be) a two-line
+                               SMS unsolicited response */
+} ATLineClass;
+
 /**
- * returns 1 if line is a final response indicating error
+ * Line prefixes that the reader thread treats specially
  * See 27.007 annex B
  * WARNING: NO CARRIER and others are sometimes unsolicited
  */
-static const char * s_finalResponsesError[] = {
-    "ERROR",
-    "+CMS ERROR:",
-    "+CME ERROR:",
-    "NO CARRIER", /* sometimes! */
-    "NO ANSWER",
-    "NO DIALTONE",
+#define LINE_PREFIX(prefix, lineClass) { prefix, sizeof(prefix) - 1, lineClass }
+static const struct {
+    const char *prefix;
+    size_t len;
+    ATLineClass lineClass;
+} s_linePrefixes[] = {
+    LINE_PREFIX("OK", LINE_FINAL_SUCCESS),
+    LINE_PREFIX("CONNECT", LINE_FINAL_SUCCESS), /* some stacks start up data on another channel */
+    LINE_PREFIX("ERROR", LINE_FINAL_ERROR),
+    LINE_PREFIX("+CMS ERROR:", LINE_FINAL_ERROR),
+    LINE_PREFIX("+CME ERROR:", LINE_FINAL_ERROR),
+    LINE_PREFIX("NO CARRIER", LINE_FINAL_ERROR), /* sometimes! */
+    LINE_PREFIX("NO ANSWER", LINE_FINAL_ERROR),
+    LINE_PREFIX("NO DIALTONE", LINE_FINAL_ERROR),
+    LINE_PREFIX("+CMT:", LINE_SMS_UNSOLICITED),
+    LINE_PREFIX("+CDS:", LINE_SMS_UNSOLICITED),
+    LINE_PREFIX("+CBM:", LINE_SMS_UNSOLICITED),
 };
-static int isFinalResponseError(const char *line)
+
+/**
+ * Classifies a line against all of s_linePrefixes at once
+ * The first character rules out most entries before any string compare
+ */
+static ATLineClass classifyLine(const char *line)
 {
     size_t i;
 
-    for (i = 0 ; i < NUM_ELEMS(s_finalResponsesError) ; i++) {
-        if (strStartsWith(line, s_finalResponsesError[i])) {
-            return 1;
+    for (i = 0 ; i < NUM_ELEMS(s_linePrefixes) ; i++) {
+        if (line[0] == s_linePrefixes[i].prefix[0]
+            && 0 == strncmp(line, s_linePrefixes[i].prefix, s_linePrefixes[i].len)
+        ) {
+            return s_linePrefixes[i].lineClass;
         }
     }
 
-    return 0;
+    return LINE_OTHER;
 }
 
+
 /**
- * returns 1 if line is a final response indicating success
- * See 27.007 annex B
- * WARNING: NO CARRIER and others are sometimes unsolicited
+ * Allocates a command with its own copy of the strings.
+ * Returns NULL on allocation failure
  */
-static const char * s_finalResponsesSuccess[] = {
-    "OK",
-    "CONNECT"       /* some stacks start up data on another channel */
-};
-static int isFinalResponseSuccess(const char *line)
+static ATCommand *newCommand(const char *command, ATCommandType type,
+                    const char *responsePrefix, const char *smspdu)
 {
-    size_t i;
+    size_t commandLen = strlen(command) + 1;
+    size_t prefixLen = responsePrefix != NULL ? strlen(responsePrefix) + 1 : 0;
+    size_t pduLen = smspdu != NULL ? strlen(smspdu) + 1 : 0;
+    ATCommand *cmd;
+    char *strings;
+
+    cmd = (ATCommand *) calloc(1, sizeof(ATCommand) + commandLen + prefixLen + pduLen);
+    if (cmd == NULL) {
+        return NULL;
+    }
 
-    for (i = 0 ; i < NUM_ELEMS(s_finalResponsesSuccess) ; i++) {
-        if (strStartsWith(line, s_finalResponsesSuccess[i])) {
-            return 1;
-        }
+    cmd->p_response = at_response_new();
+    if (cmd->p_response == NULL) {
+        free(cmd);
+        return NULL;
     }
 
-    return 0;
+    strings = (char *) (cmd + 1);
+
+    memcpy(strings, command, commandLen);
+    cmd->command = strings;
+    strings += commandLen;
+
+    if (responsePrefix != NULL) {
+        memcpy(strings, responsePrefix, prefixLen);
+        cmd->responsePrefix = strings;
+        strings += prefixLen;
+    }
+
+    if (smspdu != NULL) {
+        memcpy(strings, smspdu, pduLen);
+        cmd->smsPDU = strings;
+    }
+
+    cmd->type = type;
+
+    return cmd;
+}
+
+static void freeCommand(ATCommand *cmd)
+{
+    at_response_free(cmd->p_response);
+    free(cmd);
+}
+
+/** assumes s_commandmutex is held */
+static void enqueueCommand(ATChannel *ch, ATCommand *cmd)
+{
+    cmd->p_next = NULL;
+
+    if (ch->p_tail == NULL) {
+        ch->p_head = cmd;
+    } else {
+        ch->p_tail->p_next = cmd;
+    }
+    ch->p_tail = cmd;
+    ch->numQueued++;
+}
+
+/** unlinks cmd wherever it is in the queue. assumes s_commandmutex is held */
+static void dequeueCommand(ATChannel *ch, ATCommand *cmd)
+{
+    ATCommand *p_prev = NULL;
+    ATCommand *p_cur = ch->p_head;
+    int index = 0;
+
+    while (p_cur != NULL && p_cur != cmd) {
+        p_prev = p_cur;
+        p_cur = p_cur->p_next;
+        index++;
+    }
+
+    if (p_cur == NULL) {
+        return;
+    }
+
+    if (p_prev == NULL) {
+        ch->p_head = cmd->p_next;
+    } else {
+        p_prev->p_next = cmd->p_next;
+    }
+
+    if (ch->p_tail == cmd) {
+        ch->p_tail = p_prev;
+    }
+
+    if (index < ch->numWritten) {
+        ch->numWritten--;
+    }
+    ch->numQueued--;
+    cmd->p_next = NULL;
 }
 
 /**
- * returns 1 if line is a final response, either  error or success
- * See 27.007 annex B
- * WARNING: NO CARRIER and others are sometimes unsolicited
+ * Takes cmd off the queue with its final result and hands it to its issuer.
+ * assumes s_commandmutex is held
  */
-static int isFinalResponse(const char *line)
+static void finishCommand(ATChannel *ch, ATCommand *cmd, int err)
 {
-    return isFinalResponseSuccess(line) || isFinalResponseError(line);
+    dequeueCommand(ch, cmd);
+
+    if (cmd->abandoned) {
+        /* its issuer gave up waiting; nobody else holds it */
+        freeCommand(cmd);
+        return;
+    }
+
+    cmd->err = err;
+
+    if (cmd->callback == NULL) {
+        cmd->done = 1;
+        pthread_cond_broadcast(&s_commandcond);
+        return;
+    }
+
+    if (ch->p_completedTail == NULL) {
+        ch->p_completed = cmd;
+    } else {
+        ch->p_completedTail->p_next = cmd;
+    }
+    ch->p_completedTail = cmd;
 }
 
+/**
+ * Gives up on a command whose issuer timed out. A command the modem has
+ * not seen yet is simply dropped. One already written keeps its place in
+ * the queue and its pipeline slot until its late final response arrives,
+ * or the channel is closed, so that responses keep matching their commands.
+ * assumes s_commandmutex is held
+ */
+static void abandonCommand(ATChannel *ch, ATCommand *cmd)
+{
+    ATCommand *p_cur = ch->p_head;
+    int i;
+
+    for (i = 0; i < ch->numWritten && p_cur != cmd; i++) {
+        p_cur = p_cur->p_next;
+    }
+
+    if (i == ch->numWritten) {
+        dequeueCommand(ch, cmd);
+        freeCommand(cmd);
+        return;
+    }
+
+    cmd->abandoned = 1;
+}
 
 /**
- * returns 1 if line is the first line in (what will be) a two-line
- * SMS unsolicited response
+ * Drops the abandoned commands that were written to ch, so the next
+ * queued ones go out. Their late final responses then complete the wrong
+ * commands: only for at_handshake(), where all of them are the same.
+ * assumes s_commandmutex is held
  */
-static const char * s_smsUnsoliciteds[] = {
-    "+CMT:",
-    "+CDS:",
-    "+CBM:"
-};
-static int isSMSUnsolicited(const char *line)
+static void dropAbandonedCommands(ATChannel *ch)
 {
-    size_t i;
+    ATCommand *cmd = ch->p_head;
 
-    for (i = 0 ; i < NUM_ELEMS(s_smsUnsoliciteds) ; i++) {
-        if (strStartsWith(line, s_smsUnsoliciteds[i])) {
-            return 1;
+    while (cmd != NULL) {
+        ATCommand *p_next = cmd->p_next;
+
+        if (cmd->abandoned) {
+            dequeueCommand(ch, cmd);
+            freeCommand(cmd);
         }
+        cmd = p_next;
     }
+}
 
-    return 0;
+/** assumes s_commandmutex is held */
+static void failAllCommands(ATChannel *ch, int err)
+{
+    while (ch->p_head != NULL) {
+        finishCommand(ch, ch->p_head, err);
+    }
 }
 
+/**
+ * Sends queued commands to the modem as long as the pipeline has room.
+ * assumes s_commandmutex is held
+ */
+static void writePendingCommands(ATChannel *ch)
+{
+    while (ch->numWritten < s_pipelineDepth) {
+        ATCommand *cmd = ch->p_head;
+        int i;
+        int err;
+
+        for (i = 0; i < ch->numWritten && cmd != NULL; i++) {
+            cmd = cmd->p_next;
+        }
+
+        if (cmd == NULL) {
+            return;
+        }
+
+        /* A "> " prompt can only be matched to its command if that is the
+           only one outstanding */
+        if (ch->numWritten > 0 && (cmd->smsPDU != NULL || ch->p_head->smsPDU != NULL)) {
+            return;
+        }
+
+        err = writeline(ch, cmd->command);
+        ch->numWritten++;
+
+        if (err < 0) {
+            finishCommand(ch, cmd, err);
+        }
+    }
+}
+
+/**
+ * Runs the callbacks of the asynchronous commands that finished on ch.
+ * Must be called without s_commandmutex held
+ */
+static void runCompletedCallbacks(ATChannel *ch)
+{
+    ATCommand *cmd;
+
+    pthread_mutex_lock(&s_commandmutex);
+    cmd = ch->p_completed;
+    ch->p_completed = NULL;
+    ch->p_completedTail = NULL;
+    pthread_mutex_unlock(&s_commandmutex);
+
+    while (cmd != NULL) {
+        ATCommand *p_next = cmd->p_next;
+        ATResponse *p_response = NULL;
+        int err = cmd->err;
+
+        if (err == 0 && (cmd->type == SINGLELINE || cmd->type == NUMERIC)
+            && cmd->p_response->success > 0
+            && cmd->p_response->p_intermediates == NULL
+        ) {
+            /* successful command must have an intermediate response */
+            err = AT_ERROR_INVALID_RESPONSE;
+        }
+
+        if (err == 0) {
+            p_response = cmd->p_response;
+            cmd->p_response = NULL;
+        }
+
+        cmd->callback(err, p_response, cmd->param);
+        freeCommand(cmd);
+
+        cmd = p_next;
+    }
+}
 
 /** assumes s_commandmutex is held */
-static void handleFinalResponse(const char *line)
+static void handleFinalResponse(ATChannel *ch, ATCommand *cmd, const char *line)
 {
-    sp_response->finalResponse = strdup(line);
+    cmd->p_response->finalResponse = arenaStrdup(cmd->p_response, line);
 
-    pthread_cond_signal(&s_commandcond);
+    finishCommand(ch, cmd, 0);
+    writePendingCommands(ch);
 }
 
 static void handleUnsolicited(const char *line)
@@ -231,33 +600,43 @@ static void handleUnsolicited(const char *line)
     }
 }
 
-static void processLine(const char *line)
+static void processLine(ATChannel *ch, const char *line, ATLineClass lineClass)
 {
+    ATCommand *cmd;
+
     pthread_mutex_lock(&s_commandmutex);
 
-    if (sp_response == NULL) {
+    /* responses come back in the order the commands were written */
+    cmd = ch->numWritten > 0 ? ch->p_head : NULL;
+
+    if (cmd == NULL) {
         /* no command pending */
         handleUnsolicited(line);
-    } else if (isFinalResponseSuccess(line)) {
-        sp_response->success = 1;
-        handleFinalResponse(line);
-    } else if (isFinalResponseError(line)) {
-        sp_response->success = 0;
-        handleFinalResponse(line);
-    } else if (s_smsPDU != NULL && 0 == strcmp(line, "> ")) {
+    } else if (lineClass == LINE_FINAL_SUCCESS) {
+        cmd->p_response->success = 1;
+        handleFinalResponse(ch, cmd, line);
+    } else if (lineClass == LINE_FINAL_ERROR) {
+        cmd->p_response->success = 0;
+        handleFinalResponse(ch, cmd, line);
+    } else if (cmd->smsPDU != NULL && 0 == strcmp(line, "> ")) {
         // See eg. TS 27.005 4.3
         // Commands like AT+CMGS have a "> " prompt
-        writeCtrlZ(s_smsPDU);
-        s_smsPDU = NULL;
-    } else switch (s_type) {
+        if (cmd->abandoned) {
+            /* too late to send it; ESC cancels the message */
+            writeEsc(ch);
+        } else {
+            writeCtrlZ(ch, cmd->smsPDU);
+        }
+        cmd->smsPDU = NULL;
+    } else switch (cmd->type) {
         case NO_RESULT:
             handleUnsolicited(line);
             break;
         case NUMERIC:
-            if (sp_response->p_intermediates == NULL
+            if (cmd->p_response->p_intermediates == NULL
                 && isdigit(line[0])
             ) {
-                addIntermediate(line);
+                addIntermediate(cmd->p_response, line);
             } else {
                 /* either we already have an intermediate response or
                    the line doesn't begin with a digit */
@@ -265,50 +644,191 @@ static void processLine(const char *line)
             }
             break;
         case SINGLELINE:
-            if (sp_response->p_intermediates == NULL
-                && strStartsWith (line, s_responsePrefix)
+            if (cmd->p_response->p_intermediates == NULL
+                && strStartsWith (line, cmd->responsePrefix)
             ) {
-                addIntermediate(line);
+                addIntermediate(cmd->p_response, line);
             } else {
                 /* we already have an intermediate response */
                 handleUnsolicited(line);
             }
             break;
         case MULTILINE:
-            if (strStartsWith (line, s_responsePrefix)) {
-                addIntermediate(line);
+            if (strStartsWith (line, cmd->responsePrefix)) {
+                addIntermediate(cmd->p_response, line);
             } else {
                 handleUnsolicited(line);
             }
         break;
 
         default: /* this should never be reached */
-            RLOGE("Unsupported AT command type %d\n", s_type);
+            RLOGE("Unsupported AT command type %d\n", cmd->type);
             handleUnsolicited(line);
         break;
     }
 
     pthread_mutex_unlock(&s_commandmutex);
+
+    runCompletedCallbacks(ch);
+}
+
+
+/**
+ * Returns the first '\r' or '\n' in [p, end), or NULL
+ * Looks at 16 bytes per step where SSE2 or NEON is available
+ */
+static const char *findEOL(const char *p, const char *end)
+{
+#if defined(__SSE2__)
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) p);
+        int mask = _mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, lf)));
+
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t cr = vdupq_n_u8('\r');
+    const uint8x16_t lf = vdupq_n_u8('\n');
+
+    while (end - p >= 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t *) p);
+        uint8x16_t eq = vorrq_u8(vceqq_u8(v, cr), vceqq_u8(v, lf));
+        /* narrow each 0x00/0xff byte to a nibble of a 64 bit mask */
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+                vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+
+        if (mask != 0) {
+            return p + (__builtin_ctzll(mask) >> 2);
+        }
+        p += 16;
+    }
+#endif
+
+    while (p < end && *p != '\r' && *p != '\n') p++;
+
+    return p < end ? p : NULL;
 }
 
+/**
+ * Advances ATBufferScan to the next line terminator in the buffered input
+ *
+ * returns 1 if there is a complete line, 0 otherwise
+ */
+static int scanForEOL(ATChannel *ch)
+{
+    size_t mask = ch->ATBufferSize - 1;
+
+    while (ch->ATBufferScan < ch->ATBufferTail) {
+        /* look at the input up to the end of the ring at once */
+        size_t off = ch->ATBufferScan & mask;
+        size_t len = ch->ATBufferTail - ch->ATBufferScan;
+        const char *p_eol;
+
+        if (len > ch->ATBufferSize - off) {
+            len = ch->ATBufferSize - off;
+        }
+
+        p_eol = findEOL(ch->ATBuffer + off, ch->ATBuffer + off + len);
+
+        if (p_eol != NULL) {
+            ch->ATBufferScan += p_eol - (ch->ATBuffer + off);
+            return 1;
+        }
+
+        ch->ATBufferScan += len;
+    }
+
+    return 0;
+}
+
+/**
+ * Doubles the ring, moving the unconsumed input to the start of it
+ *
+ * returns 0 on success, -1 if the ring is already MAX_AT_LINE bytes or
+ * memory is short
+ */
+static int growBuffer(ATChannel *ch)
+{
+    size_t mask = ch->ATBufferSize - 1;
+    size_t count = ch->ATBufferTail - ch->ATBufferHead;
+    size_t off = ch->ATBufferHead & mask;
+    size_t first = ch->ATBufferSize - off;
+    char *p_new;
+
+    if (ch->ATBufferSize >= MAX_AT_LINE) {
+        return -1;
+    }
+
+    p_new = (char *) malloc(ch->ATBufferSize * 2);
+    if (p_new == NULL) {
+        return -1;
+    }
+
+    if (first > count) {
+        first = count;
+    }
+    memcpy(p_new, ch->ATBuffer + off, first);
+    memcpy(p_new + first, ch->ATBuffer, count - first);
+
+    free(ch->ATBuffer);
+    ch->ATBuffer = p_new;
+    ch->ATBufferSize *= 2;
+    ch->ATBufferScan -= ch->ATBufferHead;
+    ch->ATBufferHead = 0;
+    ch->ATBufferTail = count;
+
+    return 0;
+}
 
 /**
- * Returns a pointer to the end of the next line
- * special-cases the "> " SMS prompt
+ * Consumes the line at the head of the ring, ending at ATBufferScan
  *
- * returns NULL if there is no complete line
+ * The line is terminated in place unless it wraps around the end of the
+ * ring, in which case it is joined up in ATLine
  */
-static char * findNextEOL(char *cur)
+static const char *takeLine(ATChannel *ch)
 {
-    if (cur[0] == '>' && cur[1] == ' ' && cur[2] == '\0') {
-        /* SMS prompt character...not \r terminated */
-        return cur+2;
+    size_t mask = ch->ATBufferSize - 1;
+    size_t off = ch->ATBufferHead & mask;
+    size_t len = ch->ATBufferScan - ch->ATBufferHead;
+    char *ret;
+
+    if (off + len < ch->ATBufferSize) {
+        ret = ch->ATBuffer + off;
+        /* Place a \0 over the \r or \n */
+        ret[len] = '\0';
+    } else {
+        size_t first = ch->ATBufferSize - off;
+
+        if (ch->ATLineSize < len + 1) {
+            char *p_line = (char *) realloc(ch->ATLine, ch->ATBufferSize + 1);
+
+            if (p_line == NULL) {
+                RLOGE("ERROR: no memory for a wrapped line, dropping it\n");
+                ch->ATBufferHead = ch->ATBufferScan = ch->ATBufferScan + 1;
+                return NULL;
+            }
+            ch->ATLine = p_line;
+            ch->ATLineSize = ch->ATBufferSize + 1;
+        }
+
+        ret = ch->ATLine;
+        memcpy(ret, ch->ATBuffer + off, first);
+        memcpy(ret + first, ch->ATBuffer, len - first);
+        ret[len] = '\0';
     }
 
-    // Find next newline
-    while (*cur != '\0' && *cur != '\r' && *cur != '\n') cur++;
+    /* skip the terminator */
+    ch->ATBufferHead = ch->ATBufferScan = ch->ATBufferScan + 1;
 
-    return *cur == '\0' ? NULL : cur;
+    return ret;
 }
 
 
@@ -322,72 +842,71 @@ static char * findNextEOL(char *cur)
  * have buffered stdio.
  */
 
-static const char *readline()
+static const char *readline(ATChannel *ch)
 {
     ssize_t count;
 
-    char *p_read = NULL;
-    char *p_eol = NULL;
-    char *ret;
-
-    /* this is a little odd. I use *s_ATBufferCur == 0 to
-     * mean "buffer consumed completely". If it points to a character, than
-     * the buffer continues until a \0
-     */
-    if (*s_ATBufferCur == '\0') {
-        /* empty buffer */
-        s_ATBufferCur = s_ATBuffer;
-        *s_ATBufferCur = '\0';
-        p_read = s_ATBuffer;
-    } else {   /* *s_ATBufferCur != '\0' */
-        /* there's data in the buffer from the last read */
+    for (;;) {
+        size_t mask = ch->ATBufferSize - 1;
+        size_t used;
+        size_t off;
+        size_t room;
+        const char *ret;
 
         // skip over leading newlines
-        while (*s_ATBufferCur == '\r' || *s_ATBufferCur == '\n')
-            s_ATBufferCur++;
+        while (ch->ATBufferHead < ch->ATBufferTail
+                && (ch->ATBuffer[ch->ATBufferHead & mask] == '\r'
+                    || ch->ATBuffer[ch->ATBufferHead & mask] == '\n')) {
+            ch->ATBufferHead++;
+        }
+        if (ch->ATBufferScan < ch->ATBufferHead) {
+            ch->ATBufferScan = ch->ATBufferHead;
+        }
 
-        p_eol = findNextEOL(s_ATBufferCur);
+        used = ch->ATBufferTail - ch->ATBufferHead;
 
-        if (p_eol == NULL) {
-            /* a partial line. move it up and prepare to read more */
-            size_t len;
+        if (used == 2 && ch->ATBuffer[ch->ATBufferHead & mask] == '>'
+                && ch->ATBuffer[(ch->ATBufferHead + 1) & mask] == ' ') {
+            /* SMS prompt character...not \r terminated */
+            ch->ATBufferHead = ch->ATBufferScan = ch->ATBufferTail;
+            RLOGD("AT< > \n");
+            return "> ";
+        }
 
-            len = strlen(s_ATBufferCur);
+        if (scanForEOL(ch)) {
+            ret = takeLine(ch);
 
-            memmove(s_ATBuffer, s_ATBufferCur, len + 1);
-            p_read = s_ATBuffer + len;
-            s_ATBufferCur = s_ATBuffer;
+            if (ret != NULL) {
+                RLOGD("AT< %s\n", ret);
+                return ret;
+            }
+            continue;
         }
-        /* Otherwise, (p_eol !- NULL) there is a complete line  */
-        /* that will be returned the while () loop below        */
-    }
 
-    while (p_eol == NULL) {
-        if (0 == MAX_AT_RESPONSE - (p_read - s_ATBuffer)) {
+        if (used == ch->ATBufferSize && growBuffer(ch) < 0) {
             RLOGE("ERROR: Input line exceeded buffer\n");
             /* ditch buffer and start over again */
-            s_ATBufferCur = s_ATBuffer;
-            *s_ATBufferCur = '\0';
-            p_read = s_ATBuffer;
+            ch->ATBufferHead = ch->ATBufferScan = ch->ATBufferTail;
+            continue;
+        }
+
+        /* read into the free space up to the end of the ring */
+        mask = ch->ATBufferSize - 1;
+        off = ch->ATBufferTail & mask;
+        room = ch->ATBufferSize - (ch->ATBufferTail - ch->ATBufferHead);
+        if (room > ch->ATBufferSize - off) {
+            room = ch->ATBufferSize - off;
         }
 
         do {
-            count = read(s_fd, p_read,
-                            MAX_AT_RESPONSE - (p_read - s_ATBuffer));
+            count = read(ch->fd, ch->ATBuffer + off, room);
         } while (count < 0 && errno == EINTR);
 
         if (count > 0) {
-            AT_DUMP( "<< ", p_read, count );
+            AT_DUMP( "<< ", ch->ATBuffer + off, count );
 
-            p_read[count] = '\0';
-
-            // skip over leading newlines
-            while (*s_ATBufferCur == '\r' || *s_ATBufferCur == '\n')
-                s_ATBufferCur++;
-
-            p_eol = findNextEOL(s_ATBufferCur);
-            p_read += count;
-        } else if (count <= 0) {
+            ch->ATBufferTail += count;
+        } else {
             /* read error encountered or EOF reached */
             if(count == 0) {
                 RLOGD("atchannel: EOF reached");
@@ -397,48 +916,46 @@ static const char *readline()
             return NULL;
         }
     }
-
-    /* a full line in the buffer. Place a \0 over the \r and return */
-
-    ret = s_ATBufferCur;
-    *p_eol = '\0';
-    s_ATBufferCur = p_eol + 1; /* this will always be <= p_read,    */
-                              /* and there will be a \0 at *p_read */
-
-    RLOGD("AT< %s\n", ret);
-    return ret;
 }
 
 
-static void onReaderClosed()
+static void onReaderClosed(ATChannel *ch)
 {
-    if (s_onReaderClosed != NULL && s_readerClosed == 0) {
+    int notify;
 
-        pthread_mutex_lock(&s_commandmutex);
+    pthread_mutex_lock(&s_commandmutex);
 
-        s_readerClosed = 1;
+    notify = (ch->readerClosed == 0);
+    ch->readerClosed = 1;
+    failAllCommands(ch, AT_ERROR_CHANNEL_CLOSED);
 
-        pthread_cond_signal(&s_commandcond);
+    pthread_mutex_unlock(&s_commandmutex);
 
-        pthread_mutex_unlock(&s_commandmutex);
+    runCompletedCallbacks(ch);
 
+    if (notify && s_onReaderClosed != NULL) {
         s_onReaderClosed();
     }
 }
 
 
-static void *readerLoop(void *arg __unused)
+static void *readerLoop(void *arg)
 {
+    ATChannel *ch = (ATChannel *) arg;
+
     for (;;) {
         const char * line;
+        ATLineClass lineClass;
 
-        line = readline();
+        line = readline(ch);
 
         if (line == NULL) {
             break;
         }
 
-        if(isSMSUnsolicited(line)) {
+        lineClass = classifyLine(line);
+
+        if(lineClass == LINE_SMS_UNSOLICITED) {
             char *line1;
             const char *line2;
 
@@ -446,7 +963,7 @@ static void *readerLoop(void *arg __unused)
             // till next call to 'readline()' hence making a copy of line
             // before calling readline again.
             line1 = strdup(line);
-            line2 = readline();
+            line2 = readline(ch);
 
             if (line2 == NULL) {
                 free(line1);
@@ -458,11 +975,11 @@ static void *readerLoop(void *arg __unused)
             }
             free(line1);
         } else {
-            processLine(line);
+            processLine(ch, line, lineClass);
         }
     }
 
-    onReaderClosed();
+    onReaderClosed(ch);
 
     return NULL;
 }
@@ -474,52 +991,60 @@ static void *readerLoop(void *arg __unused)
  * This function exists because as of writing, android libc does not
  * have buffered stdio.
  */
-static int writeline (const char *s)
+/**
+ * Writes s and its terminator with a single writev() where possible, so
+ * that a stream socket does not hold the terminator back (Nagle) until
+ * the modem acknowledges the string
+ */
+static int writeTerminated (ATChannel *ch, const char *s, const char *terminator)
 {
-    size_t cur = 0;
-    size_t len = strlen(s);
+    struct iovec iov[2];
+    int iovcnt = 2;
     ssize_t written;
 
-    if (s_fd < 0 || s_readerClosed > 0) {
-        return AT_ERROR_CHANNEL_CLOSED;
-    }
+    iov[0].iov_base = (void *) s;
+    iov[0].iov_len = strlen(s);
+    iov[1].iov_base = (void *) terminator;
+    iov[1].iov_len = 1;
 
-    RLOGD("AT> %s\n", s);
-
-    AT_DUMP( ">> ", s, strlen(s) );
-
-    /* the main string */
-    while (cur < len) {
+    while (iovcnt > 0) {
         do {
-            written = write (s_fd, s + cur, len - cur);
-        } while (written < 0 && errno == EINTR);
+            written = writev (ch->fd, iov + 2 - iovcnt, iovcnt);
+        } while ((written < 0 && errno == EINTR) || (written == 0));
 
         if (written < 0) {
             return AT_ERROR_GENERIC;
         }
 
-        cur += written;
+        /* skip what went out, which may end mid-string */
+        while (iovcnt > 0 && (size_t) written >= iov[2 - iovcnt].iov_len) {
+            written -= iov[2 - iovcnt].iov_len;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov[2 - iovcnt].iov_base = (char *) iov[2 - iovcnt].iov_base + written;
+            iov[2 - iovcnt].iov_len -= written;
+        }
     }
 
-    /* the \r  */
-
-    do {
-        written = write (s_fd, "\r" , 1);
-    } while ((written < 0 && errno == EINTR) || (written == 0));
+    return 0;
+}
 
-    if (written < 0) {
-        return AT_ERROR_GENERIC;
+static int writeline (ATChannel *ch, const char *s)
+{
+    if (ch->fd < 0 || ch->readerClosed > 0) {
+        return AT_ERROR_CHANNEL_CLOSED;
     }
 
-    return 0;
+    RLOGD("AT> %s\n", s);
+
+    AT_DUMP( ">> ", s, strlen(s) );
+
+    return writeTerminated(ch, s, "\r");
 }
-static int writeCtrlZ (const char *s)
+static int writeCtrlZ (ATChannel *ch, const char *s)
 {
-    size_t cur = 0;
-    size_t len = strlen(s);
-    ssize_t written;
-
-    if (s_fd < 0 || s_readerClosed > 0) {
+    if (ch->fd < 0 || ch->readerClosed > 0) {
         return AT_ERROR_CHANNEL_CLOSED;
     }
 
@@ -527,206 +1052,282 @@ static int writeCtrlZ (const char *s)
 
     AT_DUMP( ">* ", s, strlen(s) );
 
-    /* the main string */
-    while (cur < len) {
-        do {
-            written = write (s_fd, s + cur, len - cur);
-        } while (written < 0 && errno == EINTR);
-
-        if (written < 0) {
-            return AT_ERROR_GENERIC;
-        }
-
-        cur += written;
+    return writeTerminated(ch, s, "\032");
+}
+static int writeEsc (ATChannel *ch)
+{
+    if (ch->fd < 0 || ch->readerClosed > 0) {
+        return AT_ERROR_CHANNEL_CLOSED;
     }
 
-    /* the ^Z  */
+    RLOGD("AT> ^[\n");
 
-    do {
-        written = write (s_fd, "\032" , 1);
-    } while ((written < 0 && errno == EINTR) || (written == 0));
+    return writeTerminated(ch, "", "\033");
+}
 
-    if (written < 0) {
-        return AT_ERROR_GENERIC;
+/** returns 1 if called from the reader thread of any channel */
+static int isReaderThread()
+{
+    int i;
+
+    for (i = 0 ; i < s_numChannels ; i++) {
+        if (0 != pthread_equal(s_channels[i].tid_reader, pthread_self())) {
+            return 1;
+        }
     }
 
     return 0;
 }
 
-static void clearPendingCommand()
+/**
+ * Picks the open channel with the fewest queued commands.
+ * assumes s_commandmutex is held. Returns NULL if no channel is open
+ */
+static ATChannel *pickChannel()
 {
-    if (sp_response != NULL) {
-        at_response_free(sp_response);
+    ATChannel *best = NULL;
+    int i;
+
+    for (i = 0 ; i < s_numChannels ; i++) {
+        ATChannel *ch = &s_channels[i];
+
+        if (ch->fd < 0 || ch->readerClosed > 0) {
+            continue;
+        }
+        if (best == NULL || ch->numQueued < best->numQueued) {
+            best = ch;
+        }
     }
 
-    sp_response = NULL;
-    s_responsePrefix = NULL;
-    s_smsPDU = NULL;
+    return best;
 }
 
-
 /**
  * Starts AT handler on stream "fd'
  * returns 0 on success, -1 on error
  */
 int at_open(int fd, ATUnsolHandler h)
+{
+    s_unsolHandler = h;
+    s_numChannels = 0;
+
+    return at_open_channel(fd) < 0 ? -1 : 0;
+}
+
+/**
+ * Starts an additional command channel on stream "fd"
+ * returns the channel number on success, -1 on error
+ */
+int at_open_channel(int fd)
 {
     int ret;
-    pthread_t tid;
     pthread_attr_t attr;
+    ATChannel *ch;
 
-    s_fd = fd;
-    s_unsolHandler = h;
-    s_readerClosed = 0;
+    if (s_numChannels >= AT_MAX_CHANNELS) {
+        RLOGE("at_open_channel: all %d channels in use", AT_MAX_CHANNELS);
+        return -1;
+    }
+
+    ch = &s_channels[s_numChannels];
+
+    if (ch->ATBuffer == NULL) {
+        ch->ATBuffer = (char *) malloc(MAX_AT_RESPONSE);
+        if (ch->ATBuffer == NULL) {
+            RLOGE("at_open_channel: no memory for the input buffer");
+            return -1;
+        }
+        ch->ATBufferSize = MAX_AT_RESPONSE;
+    }
+
+    pthread_mutex_lock(&s_commandmutex);
+
+    ch->fd = fd;
+    ch->readerClosed = 0;
+    ch->p_head = ch->p_tail = NULL;
+    ch->numWritten = 0;
+    ch->numQueued = 0;
+    ch->p_completed = ch->p_completedTail = NULL;
+    ch->ATBufferHead = ch->ATBufferScan = ch->ATBufferTail = 0;
 
-    s_responsePrefix = NULL;
-    s_smsPDU = NULL;
-    sp_response = NULL;
+    pthread_mutex_unlock(&s_commandmutex);
 
     pthread_attr_init (&attr);
     pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
 
-    ret = pthread_create(&s_tid_reader, &attr, readerLoop, &attr);
+    ret = pthread_create(&ch->tid_reader, &attr, readerLoop, ch);
 
-    if (ret < 0) {
+    if (ret != 0) {
+        errno = ret;
         perror ("pthread_create");
         return -1;
     }
 
-
-    return 0;
+    return s_numChannels++;
 }
 
 /* FIXME is it ok to call this from the reader and the command thread? */
 void at_close()
 {
-    if (s_fd >= 0) {
-        close(s_fd);
+    int i;
+
+    for (i = 0 ; i < s_numChannels ; i++) {
+        ATChannel *ch = &s_channels[i];
+
+        if (ch->fd >= 0) {
+            close(ch->fd);
+        }
+        ch->fd = -1;
+
+        pthread_mutex_lock(&s_commandmutex);
+
+        ch->readerClosed = 1;
+        failAllCommands(ch, AT_ERROR_CHANNEL_CLOSED);
+
+        pthread_mutex_unlock(&s_commandmutex);
+
+        runCompletedCallbacks(ch);
     }
-    s_fd = -1;
+
+    /* the reader threads should eventually die */
+}
+
+void at_set_pipeline_depth(int depth)
+{
+    int i;
 
     pthread_mutex_lock(&s_commandmutex);
 
-    s_readerClosed = 1;
+    s_pipelineDepth = depth < 1 ? 1 : depth;
 
-    pthread_cond_signal(&s_commandcond);
+    for (i = 0 ; i < s_numChannels ; i++) {
+        writePendingCommands(&s_channels[i]);
+    }
 
     pthread_mutex_unlock(&s_commandmutex);
 
-    /* the reader thread should eventually die */
+    for (i = 0 ; i < s_numChannels ; i++) {
+        runCompletedCallbacks(&s_channels[i]);
+    }
 }
 
 static ATResponse * at_response_new()
 {
-    return (ATResponse *) calloc(1, sizeof(ATResponse));
+    ATResponse *p_response;
+    ATArenaBlock *p_block;
+
+    p_response = (ATResponse *) malloc(AT_ARENA_ALIGN(sizeof(ATResponse))
+            + sizeof(ATArenaBlock) + AT_ARENA_FIRST_BLOCK);
+
+    if (p_response == NULL) {
+        return NULL;
+    }
+
+    memset(p_response, 0, sizeof(ATResponse));
+
+    p_block = (ATArenaBlock *) ((char *) p_response + AT_ARENA_ALIGN(sizeof(ATResponse)));
+    p_block->p_next = NULL;
+    p_block->used = 0;
+    p_block->size = AT_ARENA_FIRST_BLOCK;
+    p_response->p_arena = p_block;
+
+    return p_response;
 }
 
 void at_response_free(ATResponse *p_response)
 {
-    ATLine *p_line;
+    ATArenaBlock *p_block;
 
     if (p_response == NULL) return;
 
-    p_line = p_response->p_intermediates;
+    /* the last block in the chain is part of p_response itself */
+    p_block = p_response->p_arena;
 
-    while (p_line != NULL) {
-        ATLine *p_toFree;
+    while (p_block->p_next != NULL) {
+        ATArenaBlock *p_toFree;
 
-        p_toFree = p_line;
-        p_line = p_line->p_next;
+        p_toFree = p_block;
+        p_block = p_block->p_next;
 
-        free(p_toFree->line);
         free(p_toFree);
     }
 
-    free (p_response->finalResponse);
     free (p_response);
 }
 
-/**
- * The line reader places the intermediate responses in reverse order
- * here we flip them back
- */
-static void reverseIntermediates(ATResponse *p_response)
+int at_response_get_line_count(const ATResponse *p_response)
 {
-    ATLine *pcur,*pnext;
-
-    pcur = p_response->p_intermediates;
-    p_response->p_intermediates = NULL;
+    return p_response->numIntermediates;
+}
 
-    while (pcur != NULL) {
-        pnext = pcur->p_next;
-        pcur->p_next = p_response->p_intermediates;
-        p_response->p_intermediates = pcur;
-        pcur = pnext;
+char *at_response_get_line(const ATResponse *p_response, int index)
+{
+    if (index < 0 || index >= p_response->numIntermediates) {
+        return NULL;
     }
+
+    return p_response->pp_index[index]->line;
 }
 
 /**
  * Internal send_command implementation
- * Doesn't lock or call the timeout callback
+ * Doesn't lock, run completion callbacks or call the timeout callback
  *
  * timeoutMsec == 0 means infinite timeout
  */
 
-static int at_send_command_full_nolock (const char *command, ATCommandType type,
-                    const char *responsePrefix, const char *smspdu,
-                    long long timeoutMsec, ATResponse **pp_outResponse)
+static int at_send_command_full_nolock (ATChannel *ch, const char *command,
+                    ATCommandType type, const char *responsePrefix,
+                    const char *smspdu, long long timeoutMsec,
+                    ATResponse **pp_outResponse)
 {
     int err = 0;
     struct timespec ts;
+    ATCommand *cmd;
 
-    if(sp_response != NULL) {
-        err = AT_ERROR_COMMAND_PENDING;
-        goto error;
+    if (ch == NULL || ch->fd < 0 || ch->readerClosed > 0) {
+        return AT_ERROR_CHANNEL_CLOSED;
     }
 
-    err = writeline (command);
+    cmd = newCommand(command, type, responsePrefix, smspdu);
 
-    if (err < 0) {
-        goto error;
+    if (cmd == NULL) {
+        return AT_ERROR_GENERIC;
     }
 
-    s_type = type;
-    s_responsePrefix = responsePrefix;
-    s_smsPDU = smspdu;
-    sp_response = at_response_new();
+    enqueueCommand(ch, cmd);
+    writePendingCommands(ch);
 
     if (timeoutMsec != 0) {
         setTimespecRelative(&ts, timeoutMsec);
     }
 
-    while (sp_response->finalResponse == NULL && s_readerClosed == 0) {
+    while (!cmd->done) {
         if (timeoutMsec != 0) {
             err = pthread_cond_timedwait(&s_commandcond, &s_commandmutex, &ts);
         } else {
             err = pthread_cond_wait(&s_commandcond, &s_commandmutex);
         }
 
-        if (err == ETIMEDOUT) {
-            err = AT_ERROR_TIMEOUT;
-            goto error;
+        if (err == ETIMEDOUT && !cmd->done) {
+            /* the caller's s_onTimeout is expected to reset the channel */
+            abandonCommand(ch, cmd);
+            return AT_ERROR_TIMEOUT;
         }
     }
 
-    if (pp_outResponse == NULL) {
-        at_response_free(sp_response);
-    } else {
-        /* line reader stores intermediate responses in reverse order */
-        reverseIntermediates(sp_response);
-        *pp_outResponse = sp_response;
-    }
+    err = cmd->err;
 
-    sp_response = NULL;
-
-    if(s_readerClosed > 0) {
+    if (err == 0 && ch->readerClosed > 0) {
         err = AT_ERROR_CHANNEL_CLOSED;
-        goto error;
     }
 
-    err = 0;
-error:
-    clearPendingCommand();
+    if (err == 0 && pp_outResponse != NULL) {
+        *pp_outResponse = cmd->p_response;
+        cmd->p_response = NULL;
+    }
+
+    freeCommand(cmd);
 
     return err;
 }
@@ -741,19 +1342,27 @@ static int at_send_command_full (const char *command, ATCommandType type,
                     long long timeoutMsec, ATResponse **pp_outResponse)
 {
     int err;
+    ATChannel *ch;
 
-    if (0 != pthread_equal(s_tid_reader, pthread_self())) {
+    if (isReaderThread()) {
         /* cannot be called from reader thread */
         return AT_ERROR_INVALID_THREAD;
     }
     pthread_mutex_lock(&s_commandmutex);
 
-    err = at_send_command_full_nolock(command, type,
+    ch = pickChannel();
+    err = at_send_command_full_nolock(ch, command, type,
                     responsePrefix, smspdu,
                     timeoutMsec, pp_outResponse);
 
     pthread_mutex_unlock(&s_commandmutex);
 
+    if (ch != NULL) {
+        /* writing our command may have failed asynchronous ones queued
+           behind it */
+        runCompletedCallbacks(ch);
+    }
+
     if (err == AT_ERROR_TIMEOUT && s_onTimeout != NULL) {
         s_onTimeout();
     }
@@ -761,6 +1370,161 @@ static int at_send_command_full (const char *command, ATCommandType type,
     return err;
 }
 
+/**
+ * Queues a command and returns without waiting for the response
+ *
+ * On 0, callback runs exactly once when the command finishes or fails;
+ * otherwise it is never called
+ */
+int at_send_command_async (int channel, const char *command,
+                    ATCommandType type, const char *responsePrefix,
+                    const char *smspdu, ATCommandCallback callback,
+                    void *param)
+{
+    ATChannel *ch = NULL;
+    ATCommand *cmd;
+
+    if (callback == NULL) {
+        return AT_ERROR_GENERIC;
+    }
+
+    pthread_mutex_lock(&s_commandmutex);
+
+    if (channel == AT_CHANNEL_ANY) {
+        ch = pickChannel();
+    } else if (channel >= 0 && channel < s_numChannels) {
+        ch = &s_channels[channel];
+    }
+
+    if (ch == NULL || ch->fd < 0 || ch->readerClosed > 0) {
+        pthread_mutex_unlock(&s_commandmutex);
+        return AT_ERROR_CHANNEL_CLOSED;
+    }
+
+    cmd = newCommand(command, type, responsePrefix, smspdu);
+
+    if (cmd == NULL) {
+        pthread_mutex_unlock(&s_commandmutex);
+        return AT_ERROR_GENERIC;
+    }
+
+    cmd->callback = callback;
+    cmd->param = param;
+
+    enqueueCommand(ch, cmd);
+    writePendingCommands(ch);
+
+    pthread_mutex_unlock(&s_commandmutex);
+
+    runCompletedCallbacks(ch);
+
+    return 0;
+}
+
+/**
+ * Queues a script of commands on one channel and waits for all of them
+ *
+ * Commands are queued under a single hold of s_commandmutex, so they
+ * reach the modem in order and nothing else is interleaved with them
+ */
+int at_send_command_batch (ATBatchCommand *p_commands, int count)
+{
+    ATChannel *ch;
+    ATCommand **pp_cmds;
+    int numQueued;
+    int i;
+
+    if (count <= 0) {
+        return 0;
+    }
+
+    if (isReaderThread()) {
+        /* cannot be called from reader thread */
+        return AT_ERROR_INVALID_THREAD;
+    }
+
+    pp_cmds = (ATCommand **) calloc(count, sizeof(ATCommand *));
+    if (pp_cmds == NULL) {
+        return AT_ERROR_GENERIC;
+    }
+
+    for (i = 0 ; i < count ; i++) {
+        p_commands[i].err = AT_ERROR_GENERIC;
+        p_commands[i].p_response = NULL;
+    }
+
+    pthread_mutex_lock(&s_commandmutex);
+
+    ch = pickChannel();
+
+    if (ch == NULL || ch->fd < 0 || ch->readerClosed > 0) {
+        pthread_mutex_unlock(&s_commandmutex);
+        free(pp_cmds);
+        return AT_ERROR_CHANNEL_CLOSED;
+    }
+
+    for (numQueued = 0 ; numQueued < count ; numQueued++) {
+        ATBatchCommand *p_batch = &p_commands[numQueued];
+
+        pp_cmds[numQueued] = newCommand(p_batch->command, p_batch->type,
+                                        p_batch->responsePrefix, NULL);
+        if (pp_cmds[numQueued] == NULL) {
+            break;
+        }
+        enqueueCommand(ch, pp_cmds[numQueued]);
+    }
+
+    if (numQueued == 0) {
+        pthread_mutex_unlock(&s_commandmutex);
+        free(pp_cmds);
+        return AT_ERROR_GENERIC;
+    }
+
+    writePendingCommands(ch);
+
+    /* gather results in order; each wakeup is one or more completions */
+    for (i = 0 ; i < numQueued ; i++) {
+        ATCommand *cmd = pp_cmds[i];
+        ATBatchCommand *p_batch = &p_commands[i];
+
+        while (!cmd->done) {
+            pthread_cond_wait(&s_commandcond, &s_commandmutex);
+        }
+
+        p_batch->err = cmd->err;
+
+        if (p_batch->err == 0 && ch->readerClosed > 0) {
+            p_batch->err = AT_ERROR_CHANNEL_CLOSED;
+        }
+
+        if (p_batch->err == 0) {
+            p_batch->p_response = cmd->p_response;
+            cmd->p_response = NULL;
+
+            if (p_batch->type == SINGLELINE
+                && p_batch->p_response->success > 0
+                && p_batch->p_response->p_intermediates == NULL
+            ) {
+                /* successful command must have an intermediate response */
+                at_response_free(p_batch->p_response);
+                p_batch->p_response = NULL;
+                p_batch->err = AT_ERROR_INVALID_RESPONSE;
+            }
+        }
+
+        freeCommand(cmd);
+    }
+
+    pthread_mutex_unlock(&s_commandmutex);
+
+    /* writing our commands may have failed asynchronous ones queued
+       behind them */
+    runCompletedCallbacks(ch);
+
+    free(pp_cmds);
+
+    return 0;
+}
 
 /**
  * Issue a single normal AT command with no intermediate response expected
@@ -891,21 +1655,30 @@ void at_set_on_reader_closed(void (*onClose)(void))
 int at_handshake()
 {
     int i;
+    int c;
     int err = 0;
 
-    if (0 != pthread_equal(s_tid_reader, pthread_self())) {
+    if (isReaderThread()) {
         /* cannot be called from reader thread */
         return AT_ERROR_INVALID_THREAD;
     }
     pthread_mutex_lock(&s_commandmutex);
 
-    for (i = 0 ; i < HANDSHAKE_RETRY_COUNT ; i++) {
-        /* some stacks start with verbose off */
-        err = at_send_command_full_nolock ("ATE0Q0V1", NO_RESULT,
-                    NULL, NULL, HANDSHAKE_TIMEOUT_MSEC, NULL);
+    for (c = 0 ; c < s_numChannels && err == 0 ; c++) {
+        for (i = 0 ; i < HANDSHAKE_RETRY_COUNT ; i++) {
+            /* some stacks start with verbose off */
+            err = at_send_command_full_nolock (&s_channels[c], "ATE0Q0V1",
+                        NO_RESULT, NULL, NULL, HANDSHAKE_TIMEOUT_MSEC, NULL);
 
-        if (err == 0) {
-            break;
+            if (err == 0) {
+                break;
+            }
+
+            /* the modem may have dropped it; retry rather than wait for
+               its OK. A late OK completes the retry instead, which is the
+               same command, and any left over is drained below */
+            dropAbandonedCommands(&s_channels[c]);
+            writePendingCommands(&s_channels[c]);
         }
     }
 
@@ -918,6 +1691,10 @@ int at_handshake()
 
     pthread_mutex_unlock(&s_commandmutex);
 
+    for (c = 0 ; c < s_numChannels ; c++) {
+        runCompletedCallbacks(&s_channels[c]);
+    }
+
     return err;
 }
 
@@ -57,12 +57,23 @@ typedef struct ATLine  {
     char *line;
 } ATLine;
 
+struct ATArenaBlock;
+
 /** Free this with at_response_free() */
 typedef struct {
     int success;              /* true if final response indicates
                                     success (eg "OK") */
     char *finalResponse;      /* eg OK, ERROR */
     ATLine  *p_intermediates; /* any intermediate responses */
+
+    /* The lines above live in an arena owned by the response, freed with
+       it in one go. Use at_response_get_line_count/at_response_get_line
+       for indexed access; the fields below are private to atchannel.c */
+    int numIntermediates;
+    int indexSize;
+    ATLine **pp_index;
+    ATLine *p_lastIntermediate;
+    struct ATArenaBlock *p_arena;
 } ATResponse;
 
 /**
@@ -73,9 +84,40 @@ typedef struct {
  */
 typedef void (*ATUnsolHandler)(const char *s, const char *sms_pdu);
 
+/**
+ * Completion callback of at_send_command_async()
+ * This is usually called from the reader thread of the channel the command
+ * ran on, so do not block and do not issue synchronous commands from it
+ * (asynchronous ones are fine). When writing a command to the modem fails,
+ * it is instead called on the thread that submitted or wrote it, from
+ * at_send_command_async(), the synchronous at_send_command*() calls or
+ * at_handshake(), before they return: do not hold a lock the callback
+ * takes while calling those
+ * "err" is 0 or AT_ERROR_*; on 0, "p_response" must be freed with
+ * at_response_free(), otherwise it is NULL
+ */
+typedef void (*ATCommandCallback)(int err, ATResponse *p_response, void *param);
+
+/* the most command channels that can be open at once */
+#define AT_MAX_CHANNELS 4
+
+/* "channel" argument of at_send_command_async(): the least busy one */
+#define AT_CHANNEL_ANY (-1)
+
 int at_open(int fd, ATUnsolHandler h);
 void at_close();
 
+/* For modems exposing several AT channels: opens another one after at_open()
+   Synchronous commands and AT_CHANNEL_ANY go to the least busy channel.
+   Unsolicited responses from all channels go to the at_open() handler.
+   Returns the channel number, or -1 */
+int at_open_channel(int fd);
+
+/* Lets up to "depth" commands per channel be sent to the modem before the
+   final response of the first one. The default of 1 is what 27.007 requires;
+   only raise it for modems that queue commands */
+void at_set_pipeline_depth(int depth);
+
 /* This callback is invoked on the command thread.
    You should reset or handshake here to avoid getting out of sync */
 void at_set_on_timeout(void (*onTimeout)(void));
@@ -107,8 +149,45 @@ int at_send_command_sms (const char *command, const char *pdu,
                             const char *responsePrefix,
                             ATResponse **pp_outResponse);
 
+/* Queues a command on "channel" (or AT_CHANNEL_ANY) and returns at once
+   Commands on one channel complete in the order they were queued.
+   "sms_pdu" is NULL except for commands answering with a "> " prompt.
+   Returns 0 if queued, in which case "callback" runs exactly once,
+   or AT_ERROR_* */
+int at_send_command_async (int channel, const char *command,
+                            ATCommandType type, const char *responsePrefix,
+                            const char *sms_pdu, ATCommandCallback callback,
+                            void *param);
+
+/* One command of a script for at_send_command_batch() */
+typedef struct {
+    const char *command;
+    ATCommandType type;
+    const char *responsePrefix;
+
+    /* results: "err" is 0 or AT_ERROR_*; on 0, "p_response" must be freed
+       with at_response_free(), otherwise it is NULL */
+    int err;
+    ATResponse *p_response;
+} ATBatchCommand;
+
+/* Queues "count" commands back to back on one channel and waits until all
+   of them have completed, so each command goes out as soon as the previous
+   final response arrives instead of after a round trip through the caller.
+   Results are stored in each entry as they arrive; a failed command does
+   not stop the ones after it.
+   Returns 0 once all have completed, or AT_ERROR_* if none were sent */
+int at_send_command_batch (ATBatchCommand *p_commands, int count);
+
 void at_response_free(ATResponse *p_response);
 
+/* number of intermediate responses, in O(1) */
+int at_response_get_line_count(const ATResponse *p_response);
+
+/* intermediate response "index" (0 based) in arrival order, in O(1),
+   or NULL if out of range. The line may be tokenized in place */
+char *at_response_get_line(const ATResponse *p_response, int index);
+
 typedef enum {
     CME_ERROR_NON_CME = -1,
     CME_SUCCESS = 0,
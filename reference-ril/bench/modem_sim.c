@@ -0,0 +1,1150 @@
+/* //device/system/reference-ril/bench/modem_sim.c
+**
+** Copyright 2026, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+/*
+ * A stand-in AT modem for driving reference-ril without hardware
+ *
+ * Serves one client at a time on a TCP port (reference-ril -p) or a Unix
+ * socket (reference-ril -s), and answers the 27.007 / 27.005 commands
+ * reference-ril issues from a small model of a GSM modem: radio power,
+ * registration, calls, PDP contexts, SIM and SMS.
+ *
+ * Answers are held back by a configurable latency and jitter, per command
+ * if need be, but always leave in command order. A script can inject
+ * unsolicited responses; see usage().
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_COMMAND     4096
+#define MAX_CALLS       7
+#define MAX_CONTEXTS    4
+#define MAX_RULES       64
+
+/* 27.007 +CLCC <stat> */
+#define CALL_ACTIVE     0
+#define CALL_HOLDING    1
+#define CALL_DIALING    2
+#define CALL_ALERTING   3
+#define CALL_INCOMING   4
+#define CALL_WAITING    5
+/* pushed for a released call; not in 27.007 */
+#define CALL_RELEASED   6
+
+typedef enum {
+    RULE_AFTER,     /* send "line" once, "msec" after the client connects */
+    RULE_EVERY,     /* send "line" every "msec" while connected */
+    RULE_ON,        /* send "line" after answering commands starting with "prefix" */
+    RULE_CALL,      /* ring in a call from "line", "msec" after connecting */
+    RULE_LATENCY,   /* answer commands starting with "prefix" after msec +- jitter */
+} RuleType;
+
+typedef struct {
+    RuleType type;
+    long long msec;
+    long long jitter;
+    char *prefix;
+    char *line;
+    long long due;      /* RULE_AFTER, RULE_EVERY, RULE_CALL: next firing, -1 if done */
+} Rule;
+
+/* text waiting to go out to the client */
+typedef struct Output {
+    struct Output *p_next;
+    long long due;
+    size_t len;
+    char text[];
+} Output;
+
+typedef struct {
+    int id;
+    int isMT;
+    int state;
+    char number[32];
+} Call;
+
+typedef struct {
+    int cid;
+    int active;
+    char type[16];
+    char apn[64];
+} Context;
+
+static int s_verbose = 0;
+static long long s_latency = 0;
+static long long s_jitter = 0;
+
+static Rule s_rules[MAX_RULES];
+static int s_numRules = 0;
+
+static int s_clientFd = -1;
+static Output *s_outHead = NULL;
+static Output *s_outTail = NULL;
+
+/* modem state, reset for every client */
+static int s_cfun;
+static int s_initialCfun = 1;
+static int s_clccPushSupported = 0;
+static int s_clccPush;
+static int s_cregMode;
+static int s_cgregMode;
+static int s_cgerepMode;
+static Call s_calls[MAX_CALLS];
+static Context s_contexts[MAX_CONTEXTS];
+static int s_smsRef;
+static int s_copsFormat;
+
+/* set while a "> " prompt waits for an SMS PDU */
+static int s_inPdu = 0;
+static long long s_pduLatency;
+
+static long long nowMsec()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+        "usage: %s (-p <tcp port> | -s <unix socket path>) [-l <latency ms>]\n"
+        "          [-j <jitter ms>] [-f <script>] [-c] [-o] [-v]\n"
+        "  -c  accept AT+CLCC=1 and push +CLCC for every call that changes\n"
+        "  -o  start with the radio off (AT+CFUN? answers 0)\n"
+        "\n"
+        "script lines:\n"
+        "  after <ms> <line>          send <line> once, <ms> after connecting\n"
+        "  every <ms> <line>          send <line> every <ms>\n"
+        "  on <prefix> <line>         send <line> after answering <prefix>...\n"
+        "  call <ms> <number>         ring in a call from <number> after <ms>\n"
+        "  latency <prefix> <ms> [<jitter ms>]\n"
+        "                             answer <prefix>... after <ms>\n"
+        "  # comment\n", argv0);
+    exit(-1);
+}
+
+static char *nextWord(char **p_cur)
+{
+    char *word;
+
+    while (isspace((unsigned char) **p_cur)) (*p_cur)++;
+
+    if (**p_cur == '\0') {
+        return NULL;
+    }
+
+    word = *p_cur;
+    while (**p_cur != '\0' && !isspace((unsigned char) **p_cur)) (*p_cur)++;
+    if (**p_cur != '\0') {
+        *(*p_cur)++ = '\0';
+    }
+
+    return word;
+}
+
+static void loadScript(const char *path)
+{
+    FILE *fp;
+    char buf[1024];
+    int lineNum = 0;
+
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        perror(path);
+        exit(-1);
+    }
+
+    while (fgets(buf, sizeof(buf), fp) != NULL) {
+        char *p = buf;
+        char *keyword;
+        char *arg;
+        Rule *rule;
+
+        lineNum++;
+        buf[strcspn(buf, "\r\n")] = '\0';
+
+        keyword = nextWord(&p);
+        if (keyword == NULL || keyword[0] == '#') {
+            continue;
+        }
+
+        if (s_numRules == MAX_RULES) {
+            fprintf(stderr, "%s:%d: too many rules\n", path, lineNum);
+            exit(-1);
+        }
+        rule = &s_rules[s_numRules];
+        memset(rule, 0, sizeof(*rule));
+
+        arg = nextWord(&p);
+        while (isspace((unsigned char) *p)) p++;
+
+        if (arg == NULL) {
+            goto error;
+        } else if (!strcmp(keyword, "after") || !strcmp(keyword, "every")
+                || !strcmp(keyword, "call")) {
+            rule->type = !strcmp(keyword, "after") ? RULE_AFTER
+                    : !strcmp(keyword, "every") ? RULE_EVERY : RULE_CALL;
+            rule->msec = atoll(arg);
+            if (*p == '\0' || (rule->type == RULE_EVERY && rule->msec <= 0)) goto error;
+            rule->line = strdup(p);
+        } else if (!strcmp(keyword, "on")) {
+            rule->type = RULE_ON;
+            if (*p == '\0') goto error;
+            rule->prefix = strdup(arg);
+            rule->line = strdup(p);
+        } else if (!strcmp(keyword, "latency")) {
+            char *msec = nextWord(&p);
+            char *jitter = nextWord(&p);
+
+            if (msec == NULL) goto error;
+            rule->type = RULE_LATENCY;
+            rule->prefix = strdup(arg);
+            rule->msec = atoll(msec);
+            rule->jitter = jitter != NULL ? atoll(jitter) : 0;
+        } else {
+            goto error;
+        }
+
+        s_numRules++;
+        continue;
+
+error:
+        fprintf(stderr, "%s:%d: invalid line\n", path, lineNum);
+        exit(-1);
+    }
+
+    fclose(fp);
+}
+
+static long long latencyFor(const char *command)
+{
+    long long latency = s_latency;
+    long long jitter = s_jitter;
+    int i;
+
+    for (i = 0; i < s_numRules; i++) {
+        Rule *rule = &s_rules[i];
+
+        if (rule->type == RULE_LATENCY
+                && !strncasecmp(command, rule->prefix, strlen(rule->prefix))) {
+            latency = rule->msec;
+            jitter = rule->jitter;
+            break;
+        }
+    }
+
+    if (jitter > 0) {
+        latency += random() % (2 * jitter + 1) - jitter;
+    }
+
+    return latency < 0 ? 0 : latency;
+}
+
+/**
+ * Queues text for the client no earlier than "due", and never ahead of
+ * text queued before it
+ */
+static void queueOutput(long long due, const char *text, size_t len)
+{
+    Output *out;
+
+    if (len == 0) {
+        return;
+    }
+
+    out = (Output *) malloc(sizeof(Output) + len);
+    if (out == NULL) {
+        return;
+    }
+
+    if (s_outTail != NULL && s_outTail->due > due) {
+        due = s_outTail->due;
+    }
+
+    out->p_next = NULL;
+    out->due = due;
+    out->len = len;
+    memcpy(out->text, text, len);
+
+    if (s_outTail == NULL) {
+        s_outHead = out;
+    } else {
+        s_outTail->p_next = out;
+    }
+    s_outTail = out;
+}
+
+static void flushOutput(long long now)
+{
+    while (s_outHead != NULL && s_outHead->due <= now) {
+        Output *out = s_outHead;
+        size_t written = 0;
+
+        if (s_verbose) {
+            fprintf(stderr, "sim> %.*s\n", (int) out->len, out->text);
+        }
+
+        while (s_clientFd >= 0 && written < out->len) {
+            ssize_t n = write(s_clientFd, out->text + written, out->len - written);
+
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            written += n;
+        }
+
+        s_outHead = out->p_next;
+        if (s_outHead == NULL) {
+            s_outTail = NULL;
+        }
+        free(out);
+    }
+}
+
+static void discardOutput()
+{
+    while (s_outHead != NULL) {
+        Output *out = s_outHead;
+
+        s_outHead = out->p_next;
+        free(out);
+    }
+    s_outTail = NULL;
+}
+
+static void sendUnsolicited(long long due, const char *line)
+{
+    char buf[MAX_COMMAND];
+    int len;
+
+    len = snprintf(buf, sizeof(buf), "\r\n%s\r\n", line);
+    if (len > 0 && len < (int) sizeof(buf)) {
+        queueOutput(due, buf, len);
+    }
+}
+
+/*** Modem model ***/
+
+/* intermediate responses of the command being answered */
+static char s_reply[65536];
+static size_t s_replyLen;
+
+static void reply(const char *fmt, ...)
+{
+    va_list ap;
+    int len;
+
+    if (s_replyLen + 4 >= sizeof(s_reply)) {
+        return;
+    }
+
+    va_start(ap, fmt);
+    len = vsnprintf(s_reply + s_replyLen + 2, sizeof(s_reply) - s_replyLen - 4, fmt, ap);
+    va_end(ap);
+
+    if (len < 0 || s_replyLen + len + 4 >= sizeof(s_reply)) {
+        return;
+    }
+
+    s_reply[s_replyLen] = '\r';
+    s_reply[s_replyLen + 1] = '\n';
+    s_replyLen += len + 2;
+    s_reply[s_replyLen] = '\r';
+    s_reply[s_replyLen + 1] = '\n';
+    s_replyLen += 2;
+}
+
+static void resetModem()
+{
+    s_cfun = s_initialCfun;
+    s_cregMode = 0;
+    s_cgregMode = 0;
+    s_cgerepMode = 0;
+    s_smsRef = 0;
+    s_copsFormat = 0;
+    s_clccPush = 0;
+    s_inPdu = 0;
+    memset(s_calls, 0, sizeof(s_calls));
+    memset(s_contexts, 0, sizeof(s_contexts));
+}
+
+static int registrationState()
+{
+    return s_cfun ? 1 : 0;
+}
+
+static void sendRegistration(long long due)
+{
+    char line[64];
+
+    if (s_cregMode > 0) {
+        snprintf(line, sizeof(line), s_cregMode == 2 ? "+CREG: %d,\"1000\",\"0001a2b3\"" : "+CREG: %d",
+                registrationState());
+        sendUnsolicited(due, line);
+    }
+    if (s_cgregMode > 0) {
+        snprintf(line, sizeof(line), "+CGREG: %d", registrationState());
+        sendUnsolicited(due, line);
+    }
+}
+
+static Call *newCall(int isMT, int state, const char *number)
+{
+    int i;
+
+    for (i = 0; i < MAX_CALLS; i++) {
+        if (s_calls[i].id == 0) {
+            s_calls[i].id = i + 1;
+            s_calls[i].isMT = isMT;
+            s_calls[i].state = state;
+            snprintf(s_calls[i].number, sizeof(s_calls[i].number), "%s", number);
+            return &s_calls[i];
+        }
+    }
+
+    return NULL;
+}
+
+/** ends calls for which match() is true; returns how many */
+static int hangupCalls(int (*match)(const Call *call, int arg), int arg)
+{
+    int count = 0;
+    int i;
+
+    for (i = 0; i < MAX_CALLS; i++) {
+        if (s_calls[i].id != 0 && match(&s_calls[i], arg)) {
+            s_calls[i].id = 0;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/** with AT+CLCC=1, reports each call that differs from its slot in before */
+static void pushCallChanges(const Call *before, long long due)
+{
+    char line[128];
+    int i;
+
+    if (!s_clccPush) {
+        return;
+    }
+
+    for (i = 0; i < MAX_CALLS; i++) {
+        const Call *call = &s_calls[i];
+        int state = call->state;
+
+        if (call->id == 0) {
+            if (before[i].id == 0) {
+                continue;
+            }
+            call = &before[i];
+            state = CALL_RELEASED;
+        } else if (call->id == before[i].id && call->state == before[i].state) {
+            continue;
+        }
+
+        snprintf(line, sizeof(line), "+CLCC: %d,%d,%d,0,0,\"%s\",%d", call->id, call->isMT,
+                state, call->number, call->number[0] == '+' ? 145 : 129);
+        sendUnsolicited(due, line);
+    }
+}
+
+/** with AT+CGEREP=1, reports each context activated or deactivated since before */
+static void pushContextChanges(const Context *before, long long due)
+{
+    char line[64];
+    int i;
+
+    if (!s_cgerepMode) {
+        return;
+    }
+
+    for (i = 0; i < MAX_CONTEXTS; i++) {
+        const Context *ctx = &s_contexts[i];
+
+        if (ctx->cid == 0 || (ctx->cid == before[i].cid && ctx->active == before[i].active)) {
+            continue;
+        }
+
+        snprintf(line, sizeof(line), "+CGEV: ME PDN %s %d", ctx->active ? "ACT" : "DEACT", ctx->cid);
+        sendUnsolicited(due, line);
+    }
+}
+
+static int matchAll(const Call *call __unused, int arg __unused)
+{
+    return 1;
+}
+
+static int matchState(const Call *call, int state)
+{
+    return call->state == state;
+}
+
+static int matchId(const Call *call, int id)
+{
+    return call->id == id;
+}
+
+static Context *findContext(int cid, int create)
+{
+    int i;
+
+    for (i = 0; i < MAX_CONTEXTS; i++) {
+        if (s_contexts[i].cid == cid) {
+            return &s_contexts[i];
+        }
+    }
+
+    if (!create) {
+        return NULL;
+    }
+
+    for (i = 0; i < MAX_CONTEXTS; i++) {
+        if (s_contexts[i].cid == 0) {
+            memset(&s_contexts[i], 0, sizeof(Context));
+            s_contexts[i].cid = cid;
+            return &s_contexts[i];
+        }
+    }
+
+    return NULL;
+}
+
+/** copies the "quoted" or bare field at *p_cur into buf and skips its comma */
+static void nextField(const char **p_cur, char *buf, size_t size)
+{
+    const char *p = *p_cur;
+    size_t len;
+
+    if (*p == '"') {
+        p++;
+        len = strcspn(p, "\"");
+        *p_cur = p + len + (p[len] == '"');
+    } else {
+        len = strcspn(p, ",");
+        *p_cur = p + len;
+    }
+
+    if (len >= size) {
+        len = size - 1;
+    }
+    memcpy(buf, p, len);
+    buf[len] = '\0';
+
+    if (**p_cur == ',') {
+        (*p_cur)++;
+    }
+}
+
+/**
+ * Answers one basic or extended command, without its "AT" or ";"
+ * Intermediate responses go to s_reply
+ * returns 0 for OK, -1 for ERROR, 1 if a "> " prompt is needed
+ */
+static int executeCommand(const char *cmd)
+{
+    char field[64];
+    int i;
+
+    if (cmd[0] == '\0' || cmd[0] == 'E' || cmd[0] == 'S' || cmd[0] == 'Q' || cmd[0] == 'V') {
+        /* ATE0Q0V1, ATS0=0 */
+        return 0;
+    }
+
+    if (!strcmp(cmd, "+CFUN?")) {
+        reply("+CFUN: %d", s_cfun);
+        return 0;
+    }
+    if (!strncmp(cmd, "+CFUN=", 6)) {
+        int cfun = atoi(cmd + 6) ? 1 : 0;
+
+        if (cfun != s_cfun) {
+            s_cfun = cfun;
+            if (!cfun) {
+                hangupCalls(matchAll, 0);
+            }
+            sendRegistration(0);
+        }
+        return 0;
+    }
+
+    if (!strcmp(cmd, "+CPIN?")) {
+        reply("+CPIN: READY");
+        return 0;
+    }
+
+    if (!strcmp(cmd, "+CREG?")) {
+        if (s_cregMode == 2) {
+            reply("+CREG: 2,%d,\"1000\",\"0001a2b3\"", registrationState());
+        } else {
+            reply("+CREG: %d,%d", s_cregMode, registrationState());
+        }
+        return 0;
+    }
+    if (!strncmp(cmd, "+CREG=", 6)) {
+        s_cregMode = atoi(cmd + 6);
+        return 0;
+    }
+    if (!strcmp(cmd, "+CGREG?")) {
+        reply("+CGREG: %d,%d,\"1000\",\"0001a2b3\",\"%d\"", s_cgregMode, registrationState(), 3);
+        return 0;
+    }
+    if (!strncmp(cmd, "+CGREG=", 7)) {
+        s_cgregMode = atoi(cmd + 7);
+        return 0;
+    }
+
+    if (!strcmp(cmd, "+CSQ")) {
+        /* GW, CDMA, EVDO, LTE and TD-SCDMA fields of RIL_SignalStrength_v10 */
+        reply("+CSQ: %d,99,-1,-1,-1,-1,-1,%d,-90,-10,150,2147483647,2147483647",
+                s_cfun ? 20 : 99, s_cfun ? 25 : 99);
+        return 0;
+    }
+
+    if (!strcmp(cmd, "+COPS?")) {
+        if (!s_cfun) {
+            reply("+COPS: 0");
+        } else {
+            reply("+COPS: 0,%d,\"%s\"", s_copsFormat,
+                    s_copsFormat == 2 ? "310260" : "Android");
+        }
+        return 0;
+    }
+    if (!strncmp(cmd, "+COPS=3,", 8)) {
+        s_copsFormat = atoi(cmd + 8);
+        return 0;
+    }
+
+    if (!strcmp(cmd, "+CIMI")) {
+        reply("310260000000000");
+        return 0;
+    }
+    if (!strcmp(cmd, "+CGSN")) {
+        reply("000000000000000");
+        return 0;
+    }
+    if (!strncmp(cmd, "+CGM", 4)) {
+        reply("modem-sim");
+        return 0;
+    }
+
+    if (!strncmp(cmd, "+CRSM=", 6)) {
+        reply("+CRSM: 144,0,\"\"");
+        return 0;
+    }
+
+    if (!strncmp(cmd, "+CLCC=", 6)) {
+        if (!s_clccPushSupported) return -1;
+        s_clccPush = atoi(cmd + 6);
+        return 0;
+    }
+    if (!strcmp(cmd, "+CLCC")) {
+        for (i = 0; i < MAX_CALLS; i++) {
+            if (s_calls[i].id != 0) {
+                reply("+CLCC: %d,%d,%d,0,0,\"%s\",%d", s_calls[i].id, s_calls[i].isMT,
+                        s_calls[i].state, s_calls[i].number,
+                        s_calls[i].number[0] == '+' ? 145 : 129);
+            }
+        }
+        return 0;
+    }
+    if (cmd[0] == 'D' && strncmp(cmd, "D*99", 4) != 0) {
+        char number[32];
+
+        if (!s_cfun) return -1;
+        snprintf(number, sizeof(number), "%.*s", (int) strcspn(cmd + 1, ";"), cmd + 1);
+        return newCall(0, CALL_ACTIVE, number) != NULL ? 0 : -1;
+    }
+    if (cmd[0] == 'A') {
+        for (i = 0; i < MAX_CALLS; i++) {
+            if (s_calls[i].id != 0 && s_calls[i].state == CALL_INCOMING) {
+                s_calls[i].state = CALL_ACTIVE;
+                return 0;
+            }
+        }
+        return -1;
+    }
+    if (cmd[0] == 'H') {
+        hangupCalls(matchAll, 0);
+        return 0;
+    }
+    if (!strncmp(cmd, "+CHLD=", 6)) {
+        int arg = atoi(cmd + 6);
+
+        if (arg == 0) {
+            if (!hangupCalls(matchState, CALL_WAITING)) {
+                hangupCalls(matchState, CALL_HOLDING);
+            }
+        } else if (arg == 1) {
+            hangupCalls(matchState, CALL_ACTIVE);
+        } else if (arg >= 10 && arg < 20) {
+            return hangupCalls(matchId, arg - 10) ? 0 : -1;
+        } else if (arg == 2) {
+            for (i = 0; i < MAX_CALLS; i++) {
+                if (s_calls[i].state == CALL_ACTIVE) {
+                    s_calls[i].state = CALL_HOLDING;
+                } else if (s_calls[i].state == CALL_HOLDING || s_calls[i].state == CALL_WAITING) {
+                    s_calls[i].state = CALL_ACTIVE;
+                }
+            }
+        }
+        return 0;
+    }
+
+    if (!strncmp(cmd, "+CGDCONT=", 9)) {
+        const char *p = cmd + 9;
+        Context *ctx;
+
+        nextField(&p, field, sizeof(field));
+        ctx = findContext(atoi(field), 1);
+        if (ctx == NULL) return -1;
+        nextField(&p, ctx->type, sizeof(ctx->type));
+        nextField(&p, ctx->apn, sizeof(ctx->apn));
+        return 0;
+    }
+    if (!strcmp(cmd, "+CGDCONT?")) {
+        for (i = 0; i < MAX_CONTEXTS; i++) {
+            if (s_contexts[i].cid != 0) {
+                reply("+CGDCONT: %d,\"%s\",\"%s\",\"10.0.2.%d\",0,0", s_contexts[i].cid,
+                        s_contexts[i].type, s_contexts[i].apn, 15 + i);
+            }
+        }
+        return 0;
+    }
+    if (!strncmp(cmd, "+CGACT=", 7)) {
+        const char *p = cmd + 7;
+        int state;
+        Context *ctx;
+
+        nextField(&p, field, sizeof(field));
+        state = atoi(field);
+        nextField(&p, field, sizeof(field));
+        ctx = findContext(atoi(field), 0);
+        if (ctx != NULL) {
+            ctx->active = state;
+        }
+        return 0;
+    }
+    if (!strncmp(cmd, "+CGPADDR=", 9)) {
+        Context *ctx = findContext(atoi(cmd + 9), 0);
+
+        if (ctx == NULL) return -1;
+        reply("+CGPADDR: %d,\"10.0.2.%d\"", ctx->cid, 15 + (int) (ctx - s_contexts));
+        return 0;
+    }
+    if (!strncmp(cmd, "+CGEREP=", 8)) {
+        s_cgerepMode = atoi(cmd + 8);
+        return 0;
+    }
+    if (!strcmp(cmd, "+CGACT?")) {
+        for (i = 0; i < MAX_CONTEXTS; i++) {
+            if (s_contexts[i].cid != 0) {
+                reply("+CGACT: %d,%d", s_contexts[i].cid, s_contexts[i].active);
+            }
+        }
+        return 0;
+    }
+    if (!strncmp(cmd, "D*99***", 7)) {
+        Context *ctx = findContext(atoi(cmd + 7), 0);
+
+        if (ctx == NULL || !s_cfun) return -1;
+        ctx->active = 1;
+        return 0;
+    }
+
+    if (!strncmp(cmd, "+CMGS=", 6) || !strncmp(cmd, "+CMGW=", 6)) {
+        return 1;
+    }
+    if (!strncmp(cmd, "+CSMS=", 6)) {
+        reply("+CSMS: 1,1,1");
+        return 0;
+    }
+
+    if (!strncmp(cmd, "+CTEC", 5) || !strncmp(cmd, "+WNAM", 5)) {
+        /* a GSM only modem */
+        return -1;
+    }
+
+    /* everything else is accepted and ignored */
+    return 0;
+}
+
+static void fireOnRules(const char *command, long long due)
+{
+    int i;
+
+    for (i = 0; i < s_numRules; i++) {
+        Rule *rule = &s_rules[i];
+
+        if (rule->type == RULE_ON
+                && !strncasecmp(command, rule->prefix, strlen(rule->prefix))) {
+            sendUnsolicited(due, rule->line);
+        }
+    }
+}
+
+/** answers one command line from the client, which starts with "AT" */
+static void processCommand(char *line, long long now)
+{
+    long long due = now + latencyFor(line);
+    Call before[MAX_CALLS];
+    Context contextsBefore[MAX_CONTEXTS];
+    char *cmd;
+    char *p;
+    int ret = 0;
+
+    if (s_verbose) {
+        fprintf(stderr, "sim< %s\n", line);
+    }
+
+    if (strncasecmp(line, "AT", 2) != 0) {
+        return;
+    }
+
+    s_replyLen = 0;
+    memcpy(before, s_calls, sizeof(before));
+    memcpy(contextsBefore, s_contexts, sizeof(contextsBefore));
+
+    /* "AT+COPS=3,0;+COPS?" runs each command in turn and answers once */
+    for (cmd = line + 2; cmd != NULL && ret == 0; cmd = p) {
+        p = strchr(cmd, ';');
+        if (p != NULL && (p[1] == '+' || p[1] == '%')) {
+            *p++ = '\0';
+        } else {
+            p = NULL;
+        }
+
+        ret = executeCommand(cmd);
+    }
+
+    if (ret == 1) {
+        queueOutput(due, s_reply, s_replyLen);
+        queueOutput(due, "> ", 2);
+        s_inPdu = 1;
+        s_pduLatency = due - now;
+        return;
+    }
+
+    if (ret == 0) {
+        memcpy(s_reply + s_replyLen, "\r\nOK\r\n", 6);
+        s_replyLen += 6;
+    } else {
+        memcpy(s_reply, "\r\nERROR\r\n", 9);
+        s_replyLen = 9;
+    }
+    queueOutput(due, s_reply, s_replyLen);
+
+    pushCallChanges(before, due);
+    pushContextChanges(contextsBefore, due);
+    fireOnRules(line + 2, due);
+}
+
+static void processPdu(long long now)
+{
+    char buf[64];
+    int len;
+
+    s_inPdu = 0;
+    len = snprintf(buf, sizeof(buf), "\r\n+CMGS: %d\r\n\r\nOK\r\n", ++s_smsRef & 0xff);
+    queueOutput(now + s_pduLatency, buf, len);
+}
+
+static void fireTimedRules(long long now)
+{
+    int i;
+
+    for (i = 0; i < s_numRules; i++) {
+        Rule *rule = &s_rules[i];
+
+        if (rule->due < 0 || rule->due > now) {
+            continue;
+        }
+
+        switch (rule->type) {
+            case RULE_AFTER:
+                sendUnsolicited(now, rule->line);
+                rule->due = -1;
+                break;
+
+            case RULE_EVERY:
+                sendUnsolicited(now, rule->line);
+                rule->due += rule->msec;
+                if (rule->due <= now) {
+                    /* fell behind; don't burst */
+                    rule->due = now + rule->msec;
+                }
+                break;
+
+            case RULE_CALL: {
+                Call before[MAX_CALLS];
+
+                memcpy(before, s_calls, sizeof(before));
+                if (s_cfun && newCall(1, CALL_INCOMING, rule->line) != NULL) {
+                    sendUnsolicited(now, "RING");
+                    pushCallChanges(before, now);
+                }
+                rule->due = -1;
+                break;
+            }
+
+            default:
+                rule->due = -1;
+                break;
+        }
+    }
+}
+
+static long long nextTimedRule()
+{
+    long long next = -1;
+    int i;
+
+    for (i = 0; i < s_numRules; i++) {
+        if (s_rules[i].due >= 0 && (next < 0 || s_rules[i].due < next)) {
+            next = s_rules[i].due;
+        }
+    }
+
+    return next;
+}
+
+static void serveClient(int fd)
+{
+    char buf[MAX_COMMAND];
+    size_t len = 0;
+    long long connected = nowMsec();
+    int i;
+
+    s_clientFd = fd;
+    resetModem();
+
+    for (i = 0; i < s_numRules; i++) {
+        Rule *rule = &s_rules[i];
+
+        switch (rule->type) {
+            case RULE_AFTER:
+            case RULE_EVERY:
+            case RULE_CALL:
+                rule->due = connected + rule->msec;
+                break;
+            default:
+                rule->due = -1;
+                break;
+        }
+    }
+
+    for (;;) {
+        struct pollfd pfd;
+        long long now = nowMsec();
+        long long wake = nextTimedRule();
+        int timeout = -1;
+        ssize_t n;
+        char *p;
+        char *end;
+
+        if (s_outHead != NULL && (wake < 0 || s_outHead->due < wake)) {
+            wake = s_outHead->due;
+        }
+        if (wake >= 0) {
+            timeout = wake > now ? (int) (wake - now) : 0;
+        }
+
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if (poll(&pfd, 1, timeout) < 0 && errno != EINTR) {
+            break;
+        }
+
+        now = nowMsec();
+        fireTimedRules(now);
+        flushOutput(now);
+
+        if (!(pfd.revents & (POLLIN | POLLHUP | POLLERR))) {
+            continue;
+        }
+
+        n = read(fd, buf + len, sizeof(buf) - len - 1);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        len += n;
+        buf[len] = '\0';
+
+        /* commands end with \r; SMS PDUs with ^Z (or ESC to cancel) */
+        p = buf;
+        for (;;) {
+            if (s_inPdu) {
+                end = strpbrk(p, "\032\033");
+                if (end == NULL) break;
+                if (*end == '\032') {
+                    processPdu(now);
+                } else {
+                    s_inPdu = 0;
+                    queueOutput(now, "\r\nOK\r\n", 6);
+                }
+            } else {
+                end = strpbrk(p, "\r\n");
+                if (end == NULL) break;
+                *end = '\0';
+                if (*p != '\0') {
+                    processCommand(p, now);
+                }
+            }
+            p = end + 1;
+        }
+
+        len -= p - buf;
+        memmove(buf, p, len);
+
+        if (len == sizeof(buf) - 1) {
+            fprintf(stderr, "command too long, discarded\n");
+            len = 0;
+        }
+
+        flushOutput(now);
+    }
+
+    discardOutput();
+    close(fd);
+    s_clientFd = -1;
+}
+
+static int listenOn(int port, const char *path)
+{
+    int fd;
+    int on = 1;
+
+    if (path != NULL) {
+        struct sockaddr_un addr;
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+        unlink(path);
+
+        if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        struct sockaddr_in addr;
+
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+
+        if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+    }
+
+    if (listen(fd, 1) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int main(int argc, char **argv)
+{
+    int port = 0;
+    const char *path = NULL;
+    int listenFd;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "p:s:l:j:f:cov"))) {
+        switch (opt) {
+            case 'p': port = atoi(optarg); break;
+            case 's': path = optarg; break;
+            case 'l': s_latency = atoll(optarg); break;
+            case 'j': s_jitter = atoll(optarg); break;
+            case 'f': loadScript(optarg); break;
+            case 'c': s_clccPushSupported = 1; break;
+            case 'o': s_initialCfun = 0; break;
+            case 'v': s_verbose = 1; break;
+            default: usage(argv[0]);
+        }
+    }
+
+    if ((port <= 0) == (path == NULL)) {
+        usage(argv[0]);
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    srandom(time(NULL));
+
+    listenFd = listenOn(port, path);
+    if (listenFd < 0) {
+        perror("listen");
+        return -1;
+    }
+
+    for (;;) {
+        int fd = accept(listenFd, NULL, NULL);
+
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            return -1;
+        }
+
+        if (path == NULL) {
+            int on = 1;
+
+            /* behave like a serial line: no Nagle delay between writes */
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+
+        fprintf(stderr, "client connected\n");
+        serveClient(fd);
+        fprintf(stderr, "client disconnected\n");
+    }
+}
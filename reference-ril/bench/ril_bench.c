@@ -0,0 +1,564 @@
+/* //device/system/reference-ril/bench/ril_bench.c
+**
+** Copyright 2026, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+/*
+ * End-to-end request benchmark for a vendor RIL
+ *
+ * Loads the RIL library the way rild does and hands it a RIL_Env of its
+ * own: requests and timed callbacks run on one dispatch thread, as libril
+ * would run them, and completions are timed from submission to
+ * OnRequestComplete. Pointed at modem_sim this measures
+ * onRequest -> atchannel -> modem and back with no hardware.
+ *
+ *   ril-modem-sim -p 9999 -l 2 -j 1 &
+ *   ril-bench -n 2000 -r signal,calls,operator -- -p 9999
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/cdefs.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <telephony/ril.h>
+
+#define DEFAULT_RIL_LIBRARY     "libreference-ril.so"
+#define MAX_UNSOL_CODES         128
+
+typedef struct {
+    const char *name;
+    int request;
+    void *data;
+    size_t datalen;
+} BenchRequest;
+
+/* a 3GPP SMS-SUBMIT to +15555550000, "hello" */
+static const char *s_smsArgs[2] = { NULL, "01000b915155555500f0000005e8329bfd06" };
+
+static BenchRequest s_requests[] = {
+    { "signal",     RIL_REQUEST_SIGNAL_STRENGTH,            NULL, 0 },
+    { "calls",      RIL_REQUEST_GET_CURRENT_CALLS,          NULL, 0 },
+    { "operator",   RIL_REQUEST_OPERATOR,                   NULL, 0 },
+    { "voicereg",   RIL_REQUEST_VOICE_REGISTRATION_STATE,   NULL, 0 },
+    { "datareg",    RIL_REQUEST_DATA_REGISTRATION_STATE,    NULL, 0 },
+    { "datacalls",  RIL_REQUEST_DATA_CALL_LIST,             NULL, 0 },
+    { "imsi",       RIL_REQUEST_GET_IMSI,                   NULL, 0 },
+    { "simstatus",  RIL_REQUEST_GET_SIM_STATUS,             NULL, 0 },
+    { "sms",        RIL_REQUEST_SEND_SMS,                   s_smsArgs, sizeof(s_smsArgs) },
+};
+#define NUM_REQUESTS ((int) (sizeof(s_requests) / sizeof(s_requests[0])))
+
+typedef struct {
+    long long *samples;     /* usec from submission to completion */
+    int count;
+    int errors;
+    long long total;
+} BenchStats;
+
+/* the request in flight; the benchmark is closed loop like libril */
+typedef struct {
+    int request;
+    long long start;
+    long long latency;
+    RIL_Errno e;
+    int done;
+} BenchToken;
+
+/* work for the dispatch thread */
+typedef struct WorkItem {
+    struct WorkItem *p_next;
+    long long when;
+    RIL_TimedCallback callback;     /* NULL for a request */
+    void *param;
+    const BenchRequest *p_req;
+    BenchToken *token;
+} WorkItem;
+
+static const RIL_RadioFunctions *s_funcs;
+
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_workCond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t s_doneCond = PTHREAD_COND_INITIALIZER;
+static WorkItem *s_work = NULL;             /* sorted by "when" */
+
+static long long s_unsolCounts[MAX_UNSOL_CODES];
+static long long s_unsolOther;
+static long long s_timedCallbacks;
+static long long s_lateCompletions;
+
+static long long nowUsec()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/** assumes s_mutex is held */
+static void queueWork(WorkItem *item)
+{
+    WorkItem **pp;
+
+    for (pp = &s_work; *pp != NULL && (*pp)->when <= item->when; pp = &(*pp)->p_next) {
+    }
+    item->p_next = *pp;
+    *pp = item;
+
+    pthread_cond_signal(&s_workCond);
+}
+
+static void *dispatchLoop(void *param __unused)
+{
+    pthread_mutex_lock(&s_mutex);
+
+    for (;;) {
+        WorkItem *item = s_work;
+        long long now = nowUsec();
+
+        if (item == NULL) {
+            pthread_cond_wait(&s_workCond, &s_mutex);
+            continue;
+        }
+
+        if (item->when > now) {
+            struct timespec ts;
+            long long when = item->when;
+
+            clock_gettime(CLOCK_REALTIME, &ts);
+            when = (long long) ts.tv_sec * 1000000 + ts.tv_nsec / 1000 + (when - now);
+            ts.tv_sec = when / 1000000;
+            ts.tv_nsec = (when % 1000000) * 1000;
+            pthread_cond_timedwait(&s_workCond, &s_mutex, &ts);
+            continue;
+        }
+
+        s_work = item->p_next;
+        pthread_mutex_unlock(&s_mutex);
+
+        if (item->callback != NULL) {
+            item->callback(item->param);
+        } else {
+#if defined(ANDROID_MULTI_SIM)
+            s_funcs->onRequest(item->p_req->request, item->p_req->data,
+                    item->p_req->datalen, item->token, RIL_SOCKET_1);
+#else
+            s_funcs->onRequest(item->p_req->request, item->p_req->data,
+                    item->p_req->datalen, item->token);
+#endif
+        }
+        free(item);
+
+        pthread_mutex_lock(&s_mutex);
+    }
+
+    return NULL;
+}
+
+/*** RIL_Env ***/
+
+static void onRequestComplete(RIL_Token t, RIL_Errno e,
+                              void *response __unused, size_t responselen __unused)
+{
+    BenchToken *token = (BenchToken *) t;
+    long long now = nowUsec();
+
+    pthread_mutex_lock(&s_mutex);
+
+    if (token->done) {
+        s_lateCompletions++;
+    } else {
+        token->latency = now - token->start;
+        token->e = e;
+        token->done = 1;
+        pthread_cond_broadcast(&s_doneCond);
+    }
+
+    pthread_mutex_unlock(&s_mutex);
+}
+
+#if defined(ANDROID_MULTI_SIM)
+static void onUnsolicitedResponse(int unsolResponse, const void *data __unused,
+                                  size_t datalen __unused, RIL_SOCKET_ID socket_id __unused)
+#else
+static void onUnsolicitedResponse(int unsolResponse, const void *data __unused,
+                                  size_t datalen __unused)
+#endif
+{
+    int index = unsolResponse - RIL_UNSOL_RESPONSE_BASE;
+
+    pthread_mutex_lock(&s_mutex);
+    if (index >= 0 && index < MAX_UNSOL_CODES) {
+        s_unsolCounts[index]++;
+    } else {
+        s_unsolOther++;
+    }
+    pthread_mutex_unlock(&s_mutex);
+}
+
+static void requestTimedCallback(RIL_TimedCallback callback, void *param,
+                                 const struct timeval *relativeTime)
+{
+    WorkItem *item = (WorkItem *) calloc(1, sizeof(WorkItem));
+
+    if (item == NULL) {
+        return;
+    }
+
+    item->when = nowUsec();
+    if (relativeTime != NULL) {
+        item->when += (long long) relativeTime->tv_sec * 1000000 + relativeTime->tv_usec;
+    }
+    item->callback = callback;
+    item->param = param;
+
+    pthread_mutex_lock(&s_mutex);
+    s_timedCallbacks++;
+    queueWork(item);
+    pthread_mutex_unlock(&s_mutex);
+}
+
+static void onRequestAck(RIL_Token t __unused)
+{
+}
+
+static const struct RIL_Env s_benchEnv = {
+    onRequestComplete,
+    onUnsolicitedResponse,
+    requestTimedCallback,
+    onRequestAck
+};
+
+/*** Benchmark ***/
+
+/**
+ * Runs one request to completion on the dispatch thread
+ * returns 0, or -1 if it did not complete within timeoutUsec
+ */
+static int runRequest(const BenchRequest *p_req, long long timeoutUsec, BenchToken **pp_token)
+{
+    WorkItem *item = (WorkItem *) calloc(1, sizeof(WorkItem));
+    BenchToken *token = (BenchToken *) calloc(1, sizeof(BenchToken));
+    long long deadline;
+    int ret = 0;
+
+    if (item == NULL || token == NULL) {
+        free(item);
+        free(token);
+        return -1;
+    }
+
+    token->request = p_req->request;
+    item->p_req = p_req;
+    item->token = token;
+
+    pthread_mutex_lock(&s_mutex);
+
+    token->start = item->when = nowUsec();
+    deadline = token->start + timeoutUsec;
+    queueWork(item);
+
+    while (!token->done) {
+        struct timespec ts;
+        long long now = nowUsec();
+        long long when;
+
+        if (now >= deadline) {
+            ret = -1;
+            break;
+        }
+        clock_gettime(CLOCK_REALTIME, &ts);
+        when = (long long) ts.tv_sec * 1000000 + ts.tv_nsec / 1000 + (deadline - now);
+        ts.tv_sec = when / 1000000;
+        ts.tv_nsec = (when % 1000000) * 1000;
+        pthread_cond_timedwait(&s_doneCond, &s_mutex, &ts);
+    }
+
+    if (ret < 0) {
+        /* a late completion still writes to the token, so keep it */
+        token->done = 1;
+        token = NULL;
+    }
+
+    pthread_mutex_unlock(&s_mutex);
+
+    *pp_token = token;
+    return ret;
+}
+
+static int waitForRadioOn(int timeoutSec)
+{
+    /* padded: reference-ril asserts datalen >= sizeof(int *) */
+    static int s_radioOn[2] = { 1, 0 };
+    static const BenchRequest powerOn = {
+        "radiopower", RIL_REQUEST_RADIO_POWER, s_radioOn, sizeof(s_radioOn)
+    };
+    long long deadline = nowUsec() + (long long) timeoutSec * 1000000;
+    long long offSince = -1;
+    int poweredOn = 0;
+
+    for (;;) {
+#if defined(ANDROID_MULTI_SIM)
+        RIL_RadioState state = s_funcs->onStateRequest(RIL_SOCKET_1);
+#else
+        RIL_RadioState state = s_funcs->onStateRequest();
+#endif
+
+        if (state == RADIO_STATE_ON) {
+            return 0;
+        }
+
+        if (state != RADIO_STATE_OFF) {
+            offSince = -1;
+        } else if (offSince < 0) {
+            offSince = nowUsec();
+        } else if (!poweredOn && nowUsec() - offSince > 3000000) {
+            BenchToken *token;
+
+            /* initialization left the radio off; turn it on like the
+               framework would */
+            if (runRequest(&powerOn, 10000000, &token) == 0) {
+                free(token);
+            }
+            poweredOn = 1;
+        }
+
+        if (nowUsec() > deadline) {
+            return -1;
+        }
+        usleep(20000);
+    }
+}
+
+static int compareSamples(const void *a, const void *b)
+{
+    long long x = *(const long long *) a;
+    long long y = *(const long long *) b;
+
+    return (x > y) - (x < y);
+}
+
+static long long percentile(const BenchStats *stats, int pct)
+{
+    int index;
+
+    if (stats->count == 0) {
+        return 0;
+    }
+    index = (int) (((long long) stats->count * pct + 99) / 100) - 1;
+    return stats->samples[index < 0 ? 0 : index];
+}
+
+static void printReport(BenchRequest **pp_mix, BenchStats *stats, int numMix, long long elapsed)
+{
+    long long total = 0;
+    int i;
+
+    printf("%-10s %8s %6s %10s %9s %9s %9s %9s\n", "request", "count", "errors",
+            "ops/s", "p50 us", "p90 us", "p99 us", "max us");
+
+    for (i = 0; i < numMix; i++) {
+        BenchStats *s = &stats[i];
+
+        qsort(s->samples, s->count, sizeof(long long), compareSamples);
+        total += s->count;
+
+        printf("%-10s %8d %6d %10.1f %9lld %9lld %9lld %9lld\n", pp_mix[i]->name,
+                s->count, s->errors,
+                s->total > 0 ? s->count * 1e6 / s->total : 0.0,
+                percentile(s, 50), percentile(s, 90), percentile(s, 99),
+                s->count > 0 ? s->samples[s->count - 1] : 0);
+    }
+
+    printf("\n%lld requests in %.3f s: %.1f requests/s\n", total, elapsed / 1e6,
+            elapsed > 0 ? total * 1e6 / elapsed : 0.0);
+
+    printf("timed callbacks %lld, late completions %lld\n", s_timedCallbacks, s_lateCompletions);
+    printf("unsolicited responses:");
+    for (i = 0; i < MAX_UNSOL_CODES; i++) {
+        if (s_unsolCounts[i] > 0) {
+            printf(" %d:%lld", RIL_UNSOL_RESPONSE_BASE + i, s_unsolCounts[i]);
+        }
+    }
+    if (s_unsolOther > 0) {
+        printf(" other:%lld", s_unsolOther);
+    }
+    printf("\n");
+}
+
+static void usage(const char *argv0)
+{
+    int i;
+
+    fprintf(stderr,
+        "usage: %s [-l <ril library>] [-n <requests per type>] [-w <warmup per type>]\n"
+        "          [-r <request>[,<request>...]] [-t <timeout ms>] -- <ril args>\n"
+        "requests:", argv0);
+    for (i = 0; i < NUM_REQUESTS; i++) {
+        fprintf(stderr, " %s", s_requests[i].name);
+    }
+    fprintf(stderr, "\n");
+    exit(-1);
+}
+
+static int parseMix(char *list, BenchRequest **pp_mix)
+{
+    int numMix = 0;
+    char *name;
+
+    if (list == NULL) {
+        /* everything but SMS, which a real network would charge for */
+        for (numMix = 0; numMix < NUM_REQUESTS - 1; numMix++) {
+            pp_mix[numMix] = &s_requests[numMix];
+        }
+        return numMix;
+    }
+
+    while ((name = strsep(&list, ",")) != NULL) {
+        int i;
+
+        for (i = 0; i < NUM_REQUESTS && strcmp(name, s_requests[i].name); i++) {
+        }
+        if (i == NUM_REQUESTS) {
+            fprintf(stderr, "unknown request %s\n", name);
+            return -1;
+        }
+        pp_mix[numMix++] = &s_requests[i];
+    }
+
+    return numMix;
+}
+
+int main(int argc, char **argv)
+{
+    const char *libPath = DEFAULT_RIL_LIBRARY;
+    const RIL_RadioFunctions *(*rilInit)(const struct RIL_Env *, int, char **);
+    BenchRequest *mix[NUM_REQUESTS];
+    BenchStats stats[NUM_REQUESTS];
+    char *mixList = NULL;
+    int numMix;
+    int count = 1000;
+    int warmup = 10;
+    long long timeoutUsec = 5000000;
+    long long start;
+    pthread_t tid;
+    void *dlHandle;
+    char **rilArgv;
+    int rilArgc;
+    int opt;
+    int i;
+    int j;
+
+    while (-1 != (opt = getopt(argc, argv, "l:n:w:r:t:"))) {
+        switch (opt) {
+            case 'l': libPath = optarg; break;
+            case 'n': count = atoi(optarg); break;
+            case 'w': warmup = atoi(optarg); break;
+            case 'r': mixList = optarg; break;
+            case 't': timeoutUsec = atoll(optarg) * 1000; break;
+            default: usage(argv[0]);
+        }
+    }
+
+    numMix = parseMix(mixList, mix);
+    if (numMix <= 0 || count <= 0) {
+        usage(argv[0]);
+    }
+
+    dlHandle = dlopen(libPath, RTLD_NOW);
+    if (dlHandle == NULL) {
+        fprintf(stderr, "dlopen failed: %s\n", dlerror());
+        return -1;
+    }
+
+    rilInit = (const RIL_RadioFunctions *(*)(const struct RIL_Env *, int, char **))
+            dlsym(dlHandle, "RIL_Init");
+    if (rilInit == NULL) {
+        fprintf(stderr, "RIL_Init not defined or exported in %s\n", libPath);
+        return -1;
+    }
+
+    pthread_create(&tid, NULL, dispatchLoop, NULL);
+
+    /* the RIL parses what follows "--", like rild's RIL arguments */
+    rilArgv = argv + optind - 1;
+    rilArgc = argc - optind + 1;
+    rilArgv[0] = argv[0];
+    optind = 1;
+    s_funcs = rilInit(&s_benchEnv, rilArgc, rilArgv);
+    if (s_funcs == NULL) {
+        fprintf(stderr, "RIL_Init failed\n");
+        return -1;
+    }
+
+    if (waitForRadioOn(30) < 0) {
+        fprintf(stderr, "radio did not turn on\n");
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(stats));
+    for (i = 0; i < numMix; i++) {
+        stats[i].samples = (long long *) calloc(count, sizeof(long long));
+        if (stats[i].samples == NULL) {
+            return -1;
+        }
+    }
+
+    /* warm up, then interleave the request types round robin */
+    for (j = 0; j < warmup; j++) {
+        for (i = 0; i < numMix; i++) {
+            BenchToken *token;
+
+            if (runRequest(mix[i], timeoutUsec, &token) == 0) {
+                free(token);
+            }
+        }
+    }
+
+    start = nowUsec();
+
+    for (j = 0; j < count; j++) {
+        for (i = 0; i < numMix; i++) {
+            BenchToken *token;
+
+            if (runRequest(mix[i], timeoutUsec, &token) < 0) {
+                stats[i].errors++;
+                stats[i].samples[stats[i].count++] = timeoutUsec;
+                stats[i].total += timeoutUsec;
+                continue;
+            }
+
+            if (token->e != RIL_E_SUCCESS) {
+                stats[i].errors++;
+            }
+            stats[i].samples[stats[i].count++] = token->latency;
+            stats[i].total += token->latency;
+            free(token);
+        }
+    }
+
+    printReport(mix, stats, numMix, nowUsec() - start);
+
+    for (i = 0; i < numMix; i++) {
+        free(stats[i].samples);
+    }
+
+    return 0;
+}
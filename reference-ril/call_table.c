@@ -0,0 +1,163 @@
+/* //device/system/reference-ril/call_table.c
+**
+** Copyright 2026, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "call_table.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define LOG_TAG "RIL"
+#include <utils/Log.h>
+
+/* only as much of a number as storeCall() keeps counts */
+static int sameNumber(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    return strncmp(a, b, CALL_TABLE_MAX_NUMBER - 1) == 0;
+}
+
+/* the fields the framework sees; number is compared by value */
+static int sameCall(const RIL_Call *a, const RIL_Call *b)
+{
+    return a->state == b->state
+            && a->index == b->index
+            && a->toa == b->toa
+            && a->isMpty == b->isMpty
+            && a->isMT == b->isMT
+            && a->als == b->als
+            && a->isVoice == b->isVoice
+            && a->isVoicePrivacy == b->isVoicePrivacy
+            && a->numberPresentation == b->numberPresentation
+            && a->namePresentation == b->namePresentation
+            && sameNumber(a->number, b->number);
+}
+
+/** stores call in slot i of table, copying its number */
+static void storeCall(CallTable *table, int i, const RIL_Call *call)
+{
+    table->calls[i] = *call;
+    table->calls[i].name = NULL;
+    table->calls[i].uusInfo = NULL;
+
+    if (call->number != NULL) {
+        if (snprintf(table->numbers[i], CALL_TABLE_MAX_NUMBER, "%s", call->number)
+                >= CALL_TABLE_MAX_NUMBER) {
+            RLOGW("call %d: number truncated to %d characters", call->index,
+                    CALL_TABLE_MAX_NUMBER - 1);
+        }
+        table->calls[i].number = table->numbers[i];
+    }
+}
+
+/** moves slot from to slot to, keeping the number pointer valid */
+static void moveCall(CallTable *table, int to, int from)
+{
+    table->calls[to] = table->calls[from];
+    if (table->calls[from].number != NULL) {
+        memcpy(table->numbers[to], table->numbers[from], CALL_TABLE_MAX_NUMBER);
+        table->calls[to].number = table->numbers[to];
+    }
+}
+
+void call_table_init(CallTable *table)
+{
+    table->numCalls = 0;
+}
+
+int call_table_set(CallTable *table, const RIL_Call *calls, int numCalls)
+{
+    CallTable old;
+    int changed;
+    int i;
+
+    call_table_copy(&old, table);
+    table->numCalls = 0;
+
+    for (i = 0; i < numCalls; i++) {
+        if (call_table_update(table, &calls[i]) < 0) {
+            RLOGW("more than %d calls, dropping call %d", CALL_TABLE_MAX_CALLS,
+                    calls[i].index);
+        }
+    }
+
+    changed = old.numCalls != table->numCalls;
+    for (i = 0; !changed && i < table->numCalls; i++) {
+        changed = !sameCall(&old.calls[i], &table->calls[i]);
+    }
+
+    return changed;
+}
+
+int call_table_update(CallTable *table, const RIL_Call *call)
+{
+    int i;
+    int j;
+
+    for (i = 0; i < table->numCalls && table->calls[i].index < call->index; i++) {
+    }
+
+    if (i < table->numCalls && table->calls[i].index == call->index) {
+        if (sameCall(&table->calls[i], call)) {
+            return 0;
+        }
+        storeCall(table, i, call);
+        return 1;
+    }
+
+    if (table->numCalls == CALL_TABLE_MAX_CALLS) {
+        return -1;
+    }
+
+    for (j = table->numCalls; j > i; j--) {
+        moveCall(table, j, j - 1);
+    }
+    storeCall(table, i, call);
+    table->numCalls++;
+
+    return 1;
+}
+
+int call_table_remove(CallTable *table, int index)
+{
+    int i;
+
+    for (i = 0; i < table->numCalls && table->calls[i].index != index; i++) {
+    }
+
+    if (i == table->numCalls) {
+        return 0;
+    }
+
+    for (; i < table->numCalls - 1; i++) {
+        moveCall(table, i, i + 1);
+    }
+    table->numCalls--;
+
+    return 1;
+}
+
+void call_table_copy(CallTable *dst, const CallTable *src)
+{
+    int i;
+
+    dst->numCalls = src->numCalls;
+    for (i = 0; i < src->numCalls; i++) {
+        storeCall(dst, i, &src->calls[i]);
+    }
+}
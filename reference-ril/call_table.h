@@ -0,0 +1,58 @@
+/* //device/system/reference-ril/call_table.h
+**
+** Copyright 2026, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef CALL_TABLE_H
+#define CALL_TABLE_H 1
+
+#include <telephony/ril.h>
+
+/* 27.007 call indices run from 1 to 7 */
+#define CALL_TABLE_MAX_CALLS    7
+/* '+', the 80 digits of a 24.008 called party BCD number and the \0;
+   longer numbers are truncated, and compared on what was kept */
+#define CALL_TABLE_MAX_NUMBER   82
+
+/**
+ * A copy of the modem's call list, ordered by call index
+ * Each call's "number" points into "numbers", or is NULL; "name" and
+ * "uusInfo" are always NULL
+ */
+typedef struct {
+    int numCalls;
+    RIL_Call calls[CALL_TABLE_MAX_CALLS];
+    char numbers[CALL_TABLE_MAX_CALLS][CALL_TABLE_MAX_NUMBER];
+} CallTable;
+
+void call_table_init(CallTable *table);
+
+/* Replaces the contents of table with calls, in any order; calls past
+   CALL_TABLE_MAX_CALLS are dropped
+   returns 1 if the call list changed, 0 if not */
+int call_table_set(CallTable *table, const RIL_Call *calls, int numCalls);
+
+/* Adds call, or replaces the call with the same index
+   returns 1 if the call list changed, 0 if not, -1 if the table is full */
+int call_table_update(CallTable *table, const RIL_Call *call);
+
+/* Drops the call with the given index
+   returns 1 if there was one, 0 if not */
+int call_table_remove(CallTable *table, int index);
+
+/* Copies src into dst, pointing dst's numbers at its own storage */
+void call_table_copy(CallTable *dst, const CallTable *src);
+
+#endif /* CALL_TABLE_H */
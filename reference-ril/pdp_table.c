@@ -0,0 +1,107 @@
+/* //device/system/reference-ril/pdp_table.c
+**
+** Copyright 2026, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "pdp_table.h"
+
+#include <string.h>
+
+/* the fields the framework sees */
+static int sameContext(const PdpContext *a, const PdpContext *b)
+{
+    if (a->cid != b->cid || a->active != b->active || a->defined != b->defined) {
+        return 0;
+    }
+    if (!a->defined) {
+        return 1;
+    }
+    return strcmp(a->type, b->type) == 0 && strcmp(a->address, b->address) == 0;
+}
+
+/** returns the slot cid is in, or would be inserted at */
+static int findSlot(const PdpTable *table, int cid)
+{
+    int lo = 0;
+    int hi = table->numContexts;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+
+        if (table->contexts[mid].cid < cid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+void pdp_table_init(PdpTable *table)
+{
+    table->numContexts = 0;
+}
+
+PdpContext *pdp_table_find(PdpTable *table, int cid)
+{
+    int i = findSlot(table, cid);
+
+    if (i < table->numContexts && table->contexts[i].cid == cid) {
+        return &table->contexts[i];
+    }
+    return NULL;
+}
+
+int pdp_table_update(PdpTable *table, const PdpContext *ctx)
+{
+    int i = findSlot(table, ctx->cid);
+
+    if (i < table->numContexts && table->contexts[i].cid == ctx->cid) {
+        if (sameContext(&table->contexts[i], ctx)) {
+            return 0;
+        }
+        table->contexts[i] = *ctx;
+        return 1;
+    }
+
+    if (table->numContexts == PDP_TABLE_MAX_CONTEXTS) {
+        return -1;
+    }
+
+    memmove(&table->contexts[i + 1], &table->contexts[i],
+            (table->numContexts - i) * sizeof(PdpContext));
+    table->contexts[i] = *ctx;
+    table->numContexts++;
+
+    return 1;
+}
+
+int pdp_table_set(PdpTable *table, const PdpTable *src)
+{
+    int changed;
+    int i;
+
+    changed = table->numContexts != src->numContexts;
+    for (i = 0; !changed && i < src->numContexts; i++) {
+        changed = !sameContext(&table->contexts[i], &src->contexts[i]);
+    }
+
+    if (changed) {
+        *table = *src;
+    }
+
+    return changed;
+}
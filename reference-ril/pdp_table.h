@@ -0,0 +1,57 @@
+/* //device/system/reference-ril/pdp_table.h
+**
+** Copyright 2026, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef PDP_TABLE_H
+#define PDP_TABLE_H 1
+
+#define PDP_TABLE_MAX_CONTEXTS  16
+#define PDP_TABLE_MAX_TYPE      16
+#define PDP_TABLE_MAX_ADDRESS   128
+
+/**
+ * One PDP context as the modem reports it
+ * "active" comes from AT+CGACT?; "type" and "address" from AT+CGDCONT?,
+ * and are only meaningful if "defined" is set
+ */
+typedef struct {
+    int cid;
+    int active;
+    int defined;
+    char type[PDP_TABLE_MAX_TYPE];
+    char address[PDP_TABLE_MAX_ADDRESS];
+} PdpContext;
+
+/* A copy of the modem's PDP contexts, ordered by cid */
+typedef struct {
+    int numContexts;
+    PdpContext contexts[PDP_TABLE_MAX_CONTEXTS];
+} PdpTable;
+
+void pdp_table_init(PdpTable *table);
+
+/* returns the context with the given cid, or NULL */
+PdpContext *pdp_table_find(PdpTable *table, int cid);
+
+/* Adds ctx, or replaces the context with the same cid
+   returns 1 if the table changed, 0 if not, -1 if the table is full */
+int pdp_table_update(PdpTable *table, const PdpContext *ctx);
+
+/* Replaces the contents of table with those of src
+   returns 1 if the table changed, 0 if not */
+int pdp_table_set(PdpTable *table, const PdpTable *src);
+
+#endif /* PDP_TABLE_H */
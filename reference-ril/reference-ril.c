@@ -28,9 +28,13 @@
 #include <inttypes.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <time.h>
 #include <alloca.h>
 #include "atchannel.h"
 #include "at_tok.h"
+#include "at_urc.h"
+#include "call_table.h"
+#include "pdp_table.h"
 #include "misc.h"
 #include <getopt.h>
 #include <sys/socket.h>
@@ -186,10 +190,10 @@ static int onSupports (int requestCode);
 static void onCancel (RIL_Token t);
 static const char *getVersion();
 static int isRadioOn();
+static int radioOnFromResponse(ATResponse *p_response);
 static SIM_Status getSIMStatus();
 static int getCardStatus(RIL_CardStatus_v6 **pp_card_status);
 static void freeCardStatus(RIL_CardStatus_v6 *p_card_status);
-static void onDataCallListChanged(void *param);
 
 extern const char * requestToString(int request);
 
@@ -213,6 +217,17 @@ static const struct RIL_Env *s_rilenv;
 
 static RIL_RadioState sState = RADIO_STATE_UNAVAILABLE;
 
+/* Modem bring-up timeline, from at_open() to RADIO_STATE_ON */
+#define MAX_BOOT_STAGES 16
+
+static pthread_mutex_t s_boot_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct {
+    const char *stage;
+    long long msec;     /* since at_open() */
+} s_bootStages[MAX_BOOT_STAGES];
+static int s_numBootStages = 0;
+static long long s_bootStart = -1;   /* -1: no bring-up in progress */
+
 static pthread_mutex_t s_state_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t s_state_cond = PTHREAD_COND_INITIALIZER;
 
@@ -252,6 +267,37 @@ static int s_repollCallsCount = 0;
 static int s_expectAnswer = 0;
 #endif /* WORKAROUND_ERRONEOUS_ANSWER */
 
+// Call-state engine: s_callTable mirrors the modem's call list. With +CLCC
+// push reporting it is kept current from unsolicited responses and answers
+// GET_CURRENT_CALLS by itself; without it the modem is polled, but either
+// way CALL_STATE_CHANGED is only sent when the list really changed.
+static pthread_mutex_t s_callTableMutex = PTHREAD_MUTEX_INITIALIZER;
+static CallTable s_callTable;
+static int s_callTableValid = 0;
+static int s_callPushReporting = 0;
+static int s_callRefreshPending = 0;
+// Bumped for each pushed +CLCC line applied to s_callTable, so that an
+// AT+CLCC answer read meanwhile is not stored over it
+static unsigned int s_callTableGeneration = 0;
+
+// PDP-context cache: s_pdpTable mirrors AT+CGACT? and AT+CGDCONT?. With
+// +CGEV reporting each event only rereads the context it names, and the
+// table answers DATA_CALL_LIST by itself; DATA_CALL_LIST_CHANGED is only
+// sent when a context really changed.
+static pthread_mutex_t s_pdpTableMutex = PTHREAD_MUTEX_INITIALIZER;
+static PdpTable s_pdpTable;
+static int s_pdpTableValid = 0;
+static int s_pdpEventReporting = 0;
+// Cleared once AT+CGPADDR fails; activations then reread every context
+static int s_pdpAddressQuery = 1;
+// +CGEV events not yet applied by refreshPdpTable(), as bitmasks of cids
+static uint32_t s_pdpActivated = 0;
+static uint32_t s_pdpDeactivated = 0;
+static int s_pdpRescan = 0;
+static int s_pdpRefreshPending = 0;
+// Bumped for each change to s_pdpTable, so that a full read of the contexts
+// started before it is not stored over it
+static unsigned int s_pdpTableGeneration = 0;
 
 static int s_cell_info_rate_ms = INT_MAX;
 static int s_mcc = 0;
@@ -261,11 +307,15 @@ static int s_cid = 0;
 
 static void pollSIMState (void *param);
 static void setRadioState(RIL_RadioState newState);
+static void markBootStage(const char *stage, int final);
 static void setRadioTechnology(ModemInfo *mdm, int newtech);
 static int query_ctec(ModemInfo *mdm, int *current, int32_t *preferred);
 static int parse_technology_response(const char *response, int *current, int32_t *preferred);
 static int techFromModemType(int mdmtype);
 
+/* +CLCC <stat> some modems push when a call is released; not in 27.007 */
+#define CLCC_STAT_RELEASED 6
+
 static int clccStateToRILState(int state, RIL_CallState *p_state)
 
 {
@@ -296,42 +346,23 @@ static int callFromCLCCLine(char *line, RIL_Call *p_call)
     err = at_tok_start(&line);
     if (err < 0) goto error;
 
-    err = at_tok_nextint(&line, &(p_call->index));
-    if (err < 0) goto error;
-
-    err = at_tok_nextbool(&line, &(p_call->isMT));
-    if (err < 0) goto error;
+    p_call->number = NULL;
 
-    err = at_tok_nextint(&line, &state);
+    err = at_tok_scan(&line, "dbddb|sd", &p_call->index, &p_call->isMT, &state,
+            &mode, &p_call->isMpty, &p_call->number, &p_call->toa);
     if (err < 0) goto error;
 
     err = clccStateToRILState(state, &(p_call->state));
     if (err < 0) goto error;
 
-    err = at_tok_nextint(&line, &mode);
-    if (err < 0) goto error;
-
     p_call->isVoice = (mode == 0);
 
-    err = at_tok_nextbool(&line, &(p_call->isMpty));
-    if (err < 0) goto error;
-
-    if (at_tok_hasmore(&line)) {
-        err = at_tok_nextstr(&line, &(p_call->number));
-
-        /* tolerate null here */
-        if (err < 0) return 0;
-
-        // Some lame implementations return strings
-        // like "NOT AVAILABLE" in the CLCC line
-        if (p_call->number != NULL
-            && 0 == strspn(p_call->number, "+0123456789")
-        ) {
-            p_call->number = NULL;
-        }
-
-        err = at_tok_nextint(&line, &p_call->toa);
-        if (err < 0) goto error;
+    // Some lame implementations return strings
+    // like "NOT AVAILABLE" in the CLCC line
+    if (p_call->number != NULL
+        && 0 == strspn(p_call->number, "+0123456789")
+    ) {
+        p_call->number = NULL;
     }
 
     p_call->uusInfo = NULL;
@@ -497,18 +528,6 @@ static void requestShutdown(RIL_Token t)
     return;
 }
 
-static void requestOrSendDataCallList(RIL_Token *t);
-
-static void onDataCallListChanged(void *param __unused)
-{
-    requestOrSendDataCallList(NULL);
-}
-
-static void requestDataCallList(void *data __unused, size_t datalen __unused, RIL_Token t)
-{
-    requestOrSendDataCallList(&t);
-}
-
 // Hang up, reject, conference, call waiting
 static void requestCallSelection(
                 void *data __unused, size_t datalen __unused, RIL_Token t, int request)
@@ -575,50 +594,78 @@ static const char* getRadioInterfaceName(bool hasWifi)
     return hasWifi ? PPP_TTY_PATH_RADIO0 : PPP_TTY_PATH_ETH0;
 }
 
-static void requestOrSendDataCallList(RIL_Token *t)
+/**
+ * Completes *t with the contexts in table, or sends them as
+ * RIL_UNSOL_DATA_CALL_LIST_CHANGED if t is NULL
+ */
+static void sendDataCallList(RIL_Token *t, const PdpTable *table)
+{
+    RIL_Data_Call_Response_v11 responses[PDP_TABLE_MAX_CONTEXTS];
+    bool hasWifi = hasWifiCapability();
+    const char* radioInterfaceName = getRadioInterfaceName(hasWifi);
+    int i;
+
+    for (i = 0; i < table->numContexts; i++) {
+        const PdpContext *ctx = &table->contexts[i];
+        RIL_Data_Call_Response_v11 *response = &responses[i];
+
+        response->suggestedRetryTime = -1;
+        response->cid = ctx->cid;
+        response->active = ctx->active;
+        response->gateways = "";
+        response->pcscf = "";
+        response->mtu = 0;
+
+        if (ctx->defined) {
+            // Assume no error
+            response->status = 0;
+            response->type = (char *)ctx->type;
+            response->ifname = (char *)radioInterfaceName;
+            response->addresses = (char *)ctx->address;
+            /* I don't know where we are, so use the public Google DNS
+             * servers by default and no gateway.
+             */
+            response->dnses = "8.8.8.8 8.8.4.4";
+        } else {
+            response->status = -1;
+            response->type = "";
+            response->ifname = "";
+            response->addresses = "";
+            response->dnses = "";
+        }
+    }
+
+    if (t != NULL)
+        RIL_onRequestComplete(*t, RIL_E_SUCCESS, responses,
+                              i * sizeof(RIL_Data_Call_Response_v11));
+    else
+        RIL_onUnsolicitedResponse(RIL_UNSOL_DATA_CALL_LIST_CHANGED,
+                                  responses,
+                                  i * sizeof(RIL_Data_Call_Response_v11));
+}
+
+/**
+ * Reads every context from the modem with AT+CGACT? and AT+CGDCONT?
+ * returns 0 on success, -1 on error
+ */
+static int queryPdpTable(PdpTable *table)
 {
     ATResponse *p_response;
     ATLine *p_cur;
+    PdpContext ctx;
+    PdpContext *p_ctx;
+    char *type;
+    char *address;
     int err;
-    int n = 0;
-    char *out;
-    char propValue[PROP_VALUE_MAX];
-    bool hasWifi = hasWifiCapability();
-    const char* radioInterfaceName = getRadioInterfaceName(hasWifi);
+
+    pdp_table_init(table);
 
     err = at_send_command_multiline ("AT+CGACT?", "+CGACT:", &p_response);
     if (err != 0 || p_response->success == 0) {
-        if (t != NULL)
-            RIL_onRequestComplete(*t, RIL_E_GENERIC_FAILURE, NULL, 0);
-        else
-            RIL_onUnsolicitedResponse(RIL_UNSOL_DATA_CALL_LIST_CHANGED,
-                                      NULL, 0);
-        return;
+        goto error;
     }
 
-    for (p_cur = p_response->p_intermediates; p_cur != NULL;
-         p_cur = p_cur->p_next)
-        n++;
-
-    RIL_Data_Call_Response_v11 *responses =
-        alloca(n * sizeof(RIL_Data_Call_Response_v11));
-
-    int i;
-    for (i = 0; i < n; i++) {
-        responses[i].status = -1;
-        responses[i].suggestedRetryTime = -1;
-        responses[i].cid = -1;
-        responses[i].active = -1;
-        responses[i].type = "";
-        responses[i].ifname = "";
-        responses[i].addresses = "";
-        responses[i].dnses = "";
-        responses[i].gateways = "";
-        responses[i].pcscf = "";
-        responses[i].mtu = 0;
-    }
-
-    RIL_Data_Call_Response_v11 *response = responses;
+    memset(&ctx, 0, sizeof(ctx));
     for (p_cur = p_response->p_intermediates; p_cur != NULL;
          p_cur = p_cur->p_next) {
         char *line = p_cur->line;
@@ -627,27 +674,21 @@ static void requestOrSendDataCallList(RIL_Token *t)
         if (err < 0)
             goto error;
 
-        err = at_tok_nextint(&line, &response->cid);
+        err = at_tok_scan(&line, "dd", &ctx.cid, &ctx.active);
         if (err < 0)
             goto error;
 
-        err = at_tok_nextint(&line, &response->active);
-        if (err < 0)
+        if (pdp_table_update(table, &ctx) < 0) {
+            RLOGE("AT+CGACT?: more than %d contexts", PDP_TABLE_MAX_CONTEXTS);
             goto error;
-
-        response++;
+        }
     }
 
     at_response_free(p_response);
 
     err = at_send_command_multiline ("AT+CGDCONT?", "+CGDCONT:", &p_response);
     if (err != 0 || p_response->success == 0) {
-        if (t != NULL)
-            RIL_onRequestComplete(*t, RIL_E_GENERIC_FAILURE, NULL, 0);
-        else
-            RIL_onUnsolicitedResponse(RIL_UNSOL_DATA_CALL_LIST_CHANGED,
-                                      NULL, 0);
-        return;
+        goto error;
     }
 
     for (p_cur = p_response->p_intermediates; p_cur != NULL;
@@ -659,76 +700,308 @@ static void requestOrSendDataCallList(RIL_Token *t)
         if (err < 0)
             goto error;
 
-        err = at_tok_nextint(&line, &cid);
+        err = at_tok_scan(&line, "d", &cid);
         if (err < 0)
             goto error;
 
-        for (i = 0; i < n; i++) {
-            if (responses[i].cid == cid)
-                break;
-        }
-
-        if (i >= n) {
-            /* details for a context we didn't hear about in the last request */
+        p_ctx = pdp_table_find(table, cid);
+        if (p_ctx == NULL) {
+            /* details for a context we didn't hear about in AT+CGACT? */
             continue;
         }
 
-        // Assume no error
-        responses[i].status = 0;
-
-        // type
-        err = at_tok_nextstr(&line, &out);
+        // type, APN (ignored for v5), address
+        err = at_tok_scan(&line, "s_s", &type, &address);
         if (err < 0)
             goto error;
 
-        int type_size = strlen(out) + 1;
-        responses[i].type = alloca(type_size);
-        strlcpy(responses[i].type, out, type_size);
+        p_ctx->defined = 1;
+        snprintf(p_ctx->type, sizeof(p_ctx->type), "%s", type);
+        snprintf(p_ctx->address, sizeof(p_ctx->address), "%s", address);
+    }
 
-        // APN ignored for v5
-        err = at_tok_nextstr(&line, &out);
-        if (err < 0)
-            goto error;
+    at_response_free(p_response);
+    return 0;
 
-        int ifname_size = strlen(radioInterfaceName) + 1;
-        responses[i].ifname = alloca(ifname_size);
-        strlcpy(responses[i].ifname, radioInterfaceName, ifname_size);
+error:
+    at_response_free(p_response);
+    return -1;
+}
 
-        err = at_tok_nextstr(&line, &out);
-        if (err < 0)
-            goto error;
+/**
+ * Reads the address of one context with AT+CGPADDR
+ * returns 0 on success, -1 on error
+ */
+static int queryPdpAddress(int cid, char *address, size_t size)
+{
+    ATResponse *p_response = NULL;
+    char *cmd;
+    char *line;
+    char *out;
+    int outCid;
+    int err;
 
-        int addresses_size = strlen(out) + 1;
-        responses[i].addresses = alloca(addresses_size);
-        strlcpy(responses[i].addresses, out, addresses_size);
+    asprintf(&cmd, "AT+CGPADDR=%d", cid);
+    err = at_send_command_singleline(cmd, "+CGPADDR:", &p_response);
+    free(cmd);
 
-        /* I don't know where we are, so use the public Google DNS
-            * servers by default and no gateway.
-            */
-        responses[i].dnses = "8.8.8.8 8.8.4.4";
-        responses[i].gateways = "";
+    if (err < 0 || p_response->success == 0) {
+        goto error;
     }
 
-    at_response_free(p_response);
+    line = p_response->p_intermediates->line;
 
-    if (t != NULL)
-        RIL_onRequestComplete(*t, RIL_E_SUCCESS, responses,
-                              n * sizeof(RIL_Data_Call_Response_v11));
-    else
-        RIL_onUnsolicitedResponse(RIL_UNSOL_DATA_CALL_LIST_CHANGED,
-                                  responses,
-                                  n * sizeof(RIL_Data_Call_Response_v11));
+    err = at_tok_start(&line);
+    if (err < 0)
+        goto error;
 
-    return;
+    err = at_tok_scan(&line, "ds", &outCid, &out);
+    if (err < 0 || outCid != cid)
+        goto error;
 
-error:
-    if (t != NULL)
-        RIL_onRequestComplete(*t, RIL_E_GENERIC_FAILURE, NULL, 0);
-    else
-        RIL_onUnsolicitedResponse(RIL_UNSOL_DATA_CALL_LIST_CHANGED,
-                                  NULL, 0);
+    snprintf(address, size, "%s", out);
+    at_response_free(p_response);
+    return 0;
 
+error:
     at_response_free(p_response);
+    return -1;
+}
+
+static unsigned int getPdpTableGeneration()
+{
+    unsigned int generation;
+
+    pthread_mutex_lock(&s_pdpTableMutex);
+    generation = s_pdpTableGeneration;
+    pthread_mutex_unlock(&s_pdpTableMutex);
+
+    return generation;
+}
+
+/**
+ * Makes table the engine's context list; "generation" is what
+ * getPdpTableGeneration() returned before table was queried
+ * returns 1 if that changes what the framework was last told, 0 if not,
+ * or -1 if s_pdpTable changed meanwhile: table may be older than it and
+ * was not stored
+ */
+static int storePdpTable(const PdpTable *table, unsigned int generation)
+{
+    int changed = -1;
+
+    pthread_mutex_lock(&s_pdpTableMutex);
+    if (generation == s_pdpTableGeneration) {
+        changed = pdp_table_set(&s_pdpTable, table) != 0 || !s_pdpTableValid;
+        s_pdpTableValid = 1;
+        s_pdpTableGeneration++;
+    }
+    pthread_mutex_unlock(&s_pdpTableMutex);
+
+    return changed;
+}
+
+static void invalidatePdpTable()
+{
+    pthread_mutex_lock(&s_pdpTableMutex);
+    s_pdpTableValid = 0;
+    pdp_table_init(&s_pdpTable);
+    s_pdpTableGeneration++;
+    pthread_mutex_unlock(&s_pdpTableMutex);
+}
+
+static void refreshPdpTable(void *param);
+
+/**
+ * Records that cid was activated or deactivated, for refreshPdpTable() to
+ * apply; cid -1 has every context read again
+ */
+static void queuePdpEvent(int cid, int active)
+{
+    int schedule;
+
+    pthread_mutex_lock(&s_pdpTableMutex);
+    if (cid < 0 || cid > 31) {
+        s_pdpRescan = 1;
+    } else if (active) {
+        s_pdpActivated |= (uint32_t)1 << cid;
+        s_pdpDeactivated &= ~((uint32_t)1 << cid);
+    } else {
+        s_pdpDeactivated |= (uint32_t)1 << cid;
+        s_pdpActivated &= ~((uint32_t)1 << cid);
+    }
+    schedule = !s_pdpRefreshPending;
+    s_pdpRefreshPending = 1;
+    pthread_mutex_unlock(&s_pdpTableMutex);
+
+    if (schedule) {
+        RIL_requestTimedCallback (refreshPdpTable, NULL, NULL);
+    }
+}
+
+/**
+ * Applies one event to the context with the given cid in s_pdpTable,
+ * reading its address again if it was activated. Only "active" and
+ * "address" are taken from the event, so a full read stored meanwhile
+ * keeps the rest
+ * returns 1 if s_pdpTable changed, 0 if not, -1 if every context has to
+ * be read
+ */
+static int refreshPdpContext(int cid, int active)
+{
+    PdpContext *p_ctx;
+    PdpContext ctx;
+    char address[PDP_TABLE_MAX_ADDRESS];
+    int known;
+    int changed = -1;
+
+    pthread_mutex_lock(&s_pdpTableMutex);
+    p_ctx = pdp_table_find(&s_pdpTable, cid);
+    known = s_pdpTableValid && p_ctx != NULL && p_ctx->defined;
+    pthread_mutex_unlock(&s_pdpTableMutex);
+
+    if (!known) {
+        /* a new context; only AT+CGDCONT? has its type */
+        return -1;
+    }
+
+    if (active) {
+        if (!s_pdpAddressQuery) {
+            return -1;
+        }
+        if (queryPdpAddress(cid, address, sizeof(address)) < 0) {
+            RLOGI("AT+CGPADDR failed; rereading all PDP contexts on activation");
+            s_pdpAddressQuery = 0;
+            return -1;
+        }
+    }
+
+    pthread_mutex_lock(&s_pdpTableMutex);
+    p_ctx = pdp_table_find(&s_pdpTable, cid);
+    if (s_pdpTableValid && p_ctx != NULL && p_ctx->defined) {
+        ctx = *p_ctx;
+        ctx.active = active;
+        if (active) {
+            snprintf(ctx.address, sizeof(ctx.address), "%s", address);
+        }
+        changed = pdp_table_update(&s_pdpTable, &ctx);
+        if (changed > 0) {
+            s_pdpTableGeneration++;
+        }
+    }
+    pthread_mutex_unlock(&s_pdpTableMutex);
+
+    return changed;
+}
+
+/**
+ * Applies the queued +CGEV events and tells the framework if a context
+ * changed
+ * Called on the request thread
+ */
+static void refreshPdpTable(void *param __unused)
+{
+    PdpTable table;
+    unsigned int generation;
+    uint32_t activated;
+    uint32_t deactivated;
+    int rescan;
+    int changed = 0;
+    int valid;
+    int cid;
+
+    pthread_mutex_lock(&s_pdpTableMutex);
+    activated = s_pdpActivated;
+    deactivated = s_pdpDeactivated;
+    rescan = s_pdpRescan || !s_pdpTableValid;
+    s_pdpActivated = 0;
+    s_pdpDeactivated = 0;
+    s_pdpRescan = 0;
+    s_pdpRefreshPending = 0;
+    pthread_mutex_unlock(&s_pdpTableMutex);
+
+    for (cid = 0; !rescan && cid <= 31; cid++) {
+        int result = 0;
+
+        if (activated & ((uint32_t)1 << cid)) {
+            result = refreshPdpContext(cid, 1);
+        } else if (deactivated & ((uint32_t)1 << cid)) {
+            result = refreshPdpContext(cid, 0);
+        }
+        rescan = result < 0;
+        changed |= result > 0;
+    }
+
+    if (rescan) {
+        int result;
+
+        generation = getPdpTableGeneration();
+        if (queryPdpTable(&table) < 0) {
+            /* the next DATA_CALL_LIST reads the modem again */
+            invalidatePdpTable();
+            return;
+        }
+        result = storePdpTable(&table, generation);
+        if (result < 0) {
+            /* s_pdpTable changed while the modem was read; read it again */
+            queuePdpEvent(-1, 0);
+            return;
+        }
+        changed |= result;
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    pthread_mutex_lock(&s_pdpTableMutex);
+    valid = s_pdpTableValid;
+    if (valid) {
+        table = s_pdpTable;
+    }
+    pthread_mutex_unlock(&s_pdpTableMutex);
+
+    if (valid) {
+        sendDataCallList(NULL, &table);
+    }
+}
+
+/* Reads every context from the modem and completes t with them */
+static void queryAndSendDataCallList(RIL_Token t)
+{
+    PdpTable table;
+    unsigned int generation = getPdpTableGeneration();
+
+    if (queryPdpTable(&table) < 0) {
+        RIL_onRequestComplete(t, RIL_E_GENERIC_FAILURE, NULL, 0);
+        return;
+    }
+
+    if (storePdpTable(&table, generation) < 0 && s_pdpEventReporting) {
+        /* s_pdpTable changed meanwhile; the cache reads the modem again */
+        queuePdpEvent(-1, 0);
+    }
+    sendDataCallList(&t, &table);
+}
+
+static void requestDataCallList(void *data __unused, size_t datalen __unused, RIL_Token t)
+{
+    PdpTable table;
+    int cached;
+
+    pthread_mutex_lock(&s_pdpTableMutex);
+    cached = s_pdpEventReporting && s_pdpTableValid;
+    if (cached) {
+        table = s_pdpTable;
+    }
+    pthread_mutex_unlock(&s_pdpTableMutex);
+
+    if (!cached) {
+        queryAndSendDataCallList(t);
+        return;
+    }
+
+    sendDataCallList(&t, &table);
 }
 
 static void requestQueryNetworkSelectionMode(
@@ -775,50 +1048,40 @@ static void sendCallStateChanged(void *param __unused)
         NULL, 0);
 }
 
-static void requestGetCurrentCalls(void *data __unused, size_t datalen __unused, RIL_Token t)
+/**
+ * Reads the call list from the modem with AT+CLCC
+ * returns 0 on success, 1 if the list looks wrong and should be read
+ * again shortly, -1 on error
+ */
+static int queryCallTable(CallTable *table)
 {
     int err;
     ATResponse *p_response;
     ATLine *p_cur;
-    int countCalls;
-    int countValidCalls;
     RIL_Call *p_calls;
-    RIL_Call **pp_calls;
-    int i;
-    int needRepoll = 0;
+    int countValidCalls;
 
 #ifdef WORKAROUND_ERRONEOUS_ANSWER
     int prevIncomingOrWaitingLine;
+    int i;
 
     prevIncomingOrWaitingLine = s_incomingOrWaitingLine;
     s_incomingOrWaitingLine = -1;
 #endif /*WORKAROUND_ERRONEOUS_ANSWER*/
 
+    call_table_init(table);
+
     err = at_send_command_multiline ("AT+CLCC", "+CLCC:", &p_response);
 
     if (err != 0 || p_response->success == 0) {
-        RIL_onRequestComplete(t, RIL_E_GENERIC_FAILURE, NULL, 0);
-        return;
-    }
-
-    /* count the calls */
-    for (countCalls = 0, p_cur = p_response->p_intermediates
-            ; p_cur != NULL
-            ; p_cur = p_cur->p_next
-    ) {
-        countCalls++;
+        at_response_free(p_response);
+        return -1;
     }
 
-    /* yes, there's an array of pointers and then an array of structures */
-
-    pp_calls = (RIL_Call **)alloca(countCalls * sizeof(RIL_Call *));
-    p_calls = (RIL_Call *)alloca(countCalls * sizeof(RIL_Call));
-    memset (p_calls, 0, countCalls * sizeof(RIL_Call));
-
-    /* init the pointer array */
-    for(i = 0; i < countCalls ; i++) {
-        pp_calls[i] = &(p_calls[i]);
-    }
+    p_calls = (RIL_Call *)alloca(
+            at_response_get_line_count(p_response) * sizeof(RIL_Call));
+    memset (p_calls, 0,
+            at_response_get_line_count(p_response) * sizeof(RIL_Call));
 
     for (countValidCalls = 0, p_cur = p_response->p_intermediates
             ; p_cur != NULL
@@ -838,12 +1101,6 @@ static void requestGetCurrentCalls(void *data __unused, size_t datalen __unused,
         }
 #endif /*WORKAROUND_ERRONEOUS_ANSWER*/
 
-        if (p_calls[countValidCalls].state != RIL_CALL_ACTIVE
-            && p_calls[countValidCalls].state != RIL_CALL_HOLDING
-        ) {
-            needRepoll = 1;
-        }
-
         countValidCalls++;
     }
 
@@ -869,7 +1126,8 @@ static void requestGetCurrentCalls(void *data __unused, size_t datalen __unused,
                     "Hit WORKAROUND_ERRONOUS_ANSWER case."
                     " Repoll count: %d\n", s_repollCallsCount);
                 s_repollCallsCount++;
-                goto error;
+                at_response_free(p_response);
+                return 1;
             }
         }
     }
@@ -878,26 +1136,177 @@ static void requestGetCurrentCalls(void *data __unused, size_t datalen __unused,
     s_repollCallsCount = 0;
 #endif /*WORKAROUND_ERRONEOUS_ANSWER*/
 
-    RIL_onRequestComplete(t, RIL_E_SUCCESS, pp_calls,
-            countValidCalls * sizeof (RIL_Call *));
-
+    /* the numbers point into p_response; the table copies them */
+    call_table_set(table, p_calls, countValidCalls);
     at_response_free(p_response);
 
-#ifdef POLL_CALL_STATE
-    if (countValidCalls) {  // We don't seem to get a "NO CARRIER" message from
-                            // smd, so we're forced to poll until the call ends.
-#else
-    if (needRepoll) {
-#endif
-        RIL_requestTimedCallback (sendCallStateChanged, NULL, &TIMEVAL_CALLSTATEPOLL);
+    return 0;
+}
+
+static unsigned int getCallTableGeneration()
+{
+    unsigned int generation;
+
+    pthread_mutex_lock(&s_callTableMutex);
+    generation = s_callTableGeneration;
+    pthread_mutex_unlock(&s_callTableMutex);
+
+    return generation;
+}
+
+/**
+ * Makes table the engine's call list; "generation" is what
+ * getCallTableGeneration() returned before table was queried
+ * returns 1 if that changes what the framework was last told, 0 if not,
+ * or -1 if a pushed +CLCC line was applied meanwhile: table may be older
+ * than the engine's list and was not stored
+ */
+static int storeCallTable(const CallTable *table, unsigned int generation)
+{
+    int changed = -1;
+
+    pthread_mutex_lock(&s_callTableMutex);
+    if (generation == s_callTableGeneration) {
+        changed = call_table_set(&s_callTable, table->calls, table->numCalls) != 0
+                || !s_callTableValid;
+        s_callTableValid = 1;
+    }
+    pthread_mutex_unlock(&s_callTableMutex);
+
+    return changed;
+}
+
+static void invalidateCallTable()
+{
+    pthread_mutex_lock(&s_callTableMutex);
+    s_callTableValid = 0;
+    call_table_init(&s_callTable);
+    pthread_mutex_unlock(&s_callTableMutex);
+}
+
+static void refreshCallTable(void *param);
+
+/* Schedules one refreshCallTable() unless one is already pending */
+static void scheduleCallTableRefresh(const struct timeval *relativeTime)
+{
+    int schedule;
+
+    pthread_mutex_lock(&s_callTableMutex);
+    schedule = !s_callRefreshPending;
+    s_callRefreshPending = 1;
+    pthread_mutex_unlock(&s_callTableMutex);
+
+    if (schedule) {
+        RIL_requestTimedCallback (refreshCallTable, NULL, relativeTime);
+    }
+}
+
+/**
+ * Without push reporting, nothing tells us when a call moves on from
+ * dialing, alerting, incoming or waiting, so the modem is polled until no
+ * call is in one of those states.
+ */
+static void pollCallStateIfNeeded(const CallTable *table)
+{
+    int needRepoll = 0;
+    int i;
+
+    if (s_callPushReporting) {
+        return;
+    }
+
+    for (i = 0; i < table->numCalls; i++) {
+        if (table->calls[i].state != RIL_CALL_ACTIVE
+            && table->calls[i].state != RIL_CALL_HOLDING
+        ) {
+            needRepoll = 1;
+        }
+    }
+
+#ifdef POLL_CALL_STATE
+    // We don't seem to get a "NO CARRIER" message from
+    // smd, so we're forced to poll until the call ends.
+    needRepoll = table->numCalls > 0;
+#endif
+
+    if (needRepoll) {
+        scheduleCallTableRefresh(&TIMEVAL_CALLSTATEPOLL);
+    }
+}
+
+/**
+ * Re-reads the call list and tells the framework if it changed
+ * Called on the request thread
+ */
+static void refreshCallTable(void *param __unused)
+{
+    CallTable table;
+    unsigned int generation;
+    int changed;
+    int err;
+
+    pthread_mutex_lock(&s_callTableMutex);
+    s_callRefreshPending = 0;
+    generation = s_callTableGeneration;
+    pthread_mutex_unlock(&s_callTableMutex);
+
+    err = queryCallTable(&table);
+    if (err > 0) {
+        scheduleCallTableRefresh(&TIMEVAL_CALLSTATEPOLL);
+        return;
+    } else if (err < 0) {
+        /* the next GET_CURRENT_CALLS reads the modem again */
+        invalidateCallTable();
+        return;
+    }
+
+    changed = storeCallTable(&table, generation);
+    if (changed < 0) {
+        /* a pushed +CLCC line overtook the answer; read the modem again */
+        scheduleCallTableRefresh(&TIMEVAL_0);
+        return;
+    } else if (changed > 0) {
+        sendCallStateChanged(NULL);
+    }
+
+    pollCallStateIfNeeded(&table);
+}
+
+static void requestGetCurrentCalls(void *data __unused, size_t datalen __unused, RIL_Token t)
+{
+    CallTable table;
+    RIL_Call *pp_calls[CALL_TABLE_MAX_CALLS];
+    int cached;
+    int i;
+
+    pthread_mutex_lock(&s_callTableMutex);
+    cached = s_callPushReporting && s_callTableValid;
+    if (cached) {
+        call_table_copy(&table, &s_callTable);
+    }
+    pthread_mutex_unlock(&s_callTableMutex);
+
+    if (!cached) {
+        unsigned int generation = getCallTableGeneration();
+
+        if (queryCallTable(&table) != 0) {
+            RIL_onRequestComplete(t, RIL_E_GENERIC_FAILURE, NULL, 0);
+            return;
+        }
+        if (storeCallTable(&table, generation) < 0) {
+            scheduleCallTableRefresh(&TIMEVAL_0);
+        }
+    }
+
+    /* yes, there's an array of pointers and then an array of structures */
+    for (i = 0; i < table.numCalls; i++) {
+        pp_calls[i] = &table.calls[i];
     }
 
-    return;
-#ifdef WORKAROUND_ERRONEOUS_ANSWER
-error:
-    RIL_onRequestComplete(t, RIL_E_GENERIC_FAILURE, NULL, 0);
-    at_response_free(p_response);
-#endif
+    RIL_onRequestComplete(t, RIL_E_SUCCESS, pp_calls,
+            table.numCalls * sizeof (RIL_Call *));
+
+    pollCallStateIfNeeded(&table);
 }
 
 static void requestDial(void *data, size_t datalen __unused, RIL_Token t)
@@ -1010,9 +1419,9 @@ static void requestSignalStrength(void *data __unused, size_t datalen __unused,
     if (err < 0) goto error;
 
     for (count = 0; count < maxNumOfElements; count++) {
-        err = at_tok_nextint(&line, &(response[count]));
-        if (err < 0 && count < minNumOfElements) goto error;
+        if (at_tok_scan(&line, "d", &response[count]) < 0) break;
     }
+    if (count < minNumOfElements) goto error;
 
     RIL_onRequestComplete(t, RIL_E_SUCCESS, response, sizeof(response));
 
@@ -1330,7 +1739,6 @@ static int parseRegistrationState(char *str, int *type, int *items, int **respon
     int err;
     char *line = str, *p;
     int *resp = NULL;
-    int skip;
     int count = 3;
     int commas;
 
@@ -1369,59 +1777,34 @@ static int parseRegistrationState(char *str, int *type, int *items, int **respon
     if (!resp) goto error;
     switch (commas) {
         case 0: /* +CREG: <stat> */
-            err = at_tok_nextint(&line, &resp[0]);
-            if (err < 0) goto error;
+            err = at_tok_scan(&line, "d", &resp[0]);
             resp[1] = -1;
             resp[2] = -1;
         break;
 
         case 1: /* +CREG: <n>, <stat> */
-            err = at_tok_nextint(&line, &skip);
-            if (err < 0) goto error;
-            err = at_tok_nextint(&line, &resp[0]);
-            if (err < 0) goto error;
+            err = at_tok_scan(&line, "_d", &resp[0]);
             resp[1] = -1;
             resp[2] = -1;
-            if (err < 0) goto error;
         break;
 
         case 2: /* +CREG: <stat>, <lac>, <cid> */
-            err = at_tok_nextint(&line, &resp[0]);
-            if (err < 0) goto error;
-            err = at_tok_nexthexint(&line, &resp[1]);
-            if (err < 0) goto error;
-            err = at_tok_nexthexint(&line, &resp[2]);
-            if (err < 0) goto error;
+            err = at_tok_scan(&line, "dxx", &resp[0], &resp[1], &resp[2]);
         break;
         case 3: /* +CREG: <n>, <stat>, <lac>, <cid> */
-            err = at_tok_nextint(&line, &skip);
-            if (err < 0) goto error;
-            err = at_tok_nextint(&line, &resp[0]);
-            if (err < 0) goto error;
-            err = at_tok_nexthexint(&line, &resp[1]);
-            if (err < 0) goto error;
-            err = at_tok_nexthexint(&line, &resp[2]);
-            if (err < 0) goto error;
+            err = at_tok_scan(&line, "_dxx", &resp[0], &resp[1], &resp[2]);
         break;
         /* special case for CGREG, there is a fourth parameter
          * that is the network type (unknown/gprs/edge/umts)
          */
         case 4: /* +CGREG: <n>, <stat>, <lac>, <cid>, <networkType> */
-            err = at_tok_nextint(&line, &skip);
-            if (err < 0) goto error;
-            err = at_tok_nextint(&line, &resp[0]);
-            if (err < 0) goto error;
-            err = at_tok_nexthexint(&line, &resp[1]);
-            if (err < 0) goto error;
-            err = at_tok_nexthexint(&line, &resp[2]);
-            if (err < 0) goto error;
-            err = at_tok_nexthexint(&line, &resp[3]);
-            if (err < 0) goto error;
+            err = at_tok_scan(&line, "_dxxx", &resp[0], &resp[1], &resp[2], &resp[3]);
             count = 4;
         break;
         default:
             goto error;
     }
+    if (err < 0) goto error;
     s_lac = resp[1];
     s_cid = resp[2];
     if (response)
@@ -2003,7 +2386,7 @@ static void requestSetupDataCall(void *data, size_t datalen, RIL_Token t)
         }
     }
 
-    requestOrSendDataCallList(&t);
+    queryAndSendDataCallList(t);
 
     at_response_free(p_response);
 
@@ -2842,6 +3225,7 @@ setRadioState(RIL_RadioState newState)
          * will need to be dispatched on the request thread
          */
         if (sState == RADIO_STATE_ON) {
+            markBootStage("radio on", 1);
             onRadioPowerOn();
         }
     }
@@ -3157,32 +3541,37 @@ static int isRadioOn()
 {
     ATResponse *p_response = NULL;
     int err;
-    char *line;
-    char ret;
+    int ret;
 
     err = at_send_command_singleline("AT+CFUN?", "+CFUN:", &p_response);
 
-    if (err < 0 || p_response->success == 0) {
-        // assume radio is off
-        goto error;
-    }
+    ret = (err < 0) ? -1 : radioOnFromResponse(p_response);
 
-    line = p_response->p_intermediates->line;
+    at_response_free(p_response);
 
-    err = at_tok_start(&line);
-    if (err < 0) goto error;
+    return ret;
+}
 
-    err = at_tok_nextbool(&line, &ret);
-    if (err < 0) goto error;
+/**
+ * Returns 1 if the AT+CFUN? response says the radio is on,
+ * 0 if off, and -1 on error (assume radio is off)
+ */
+static int radioOnFromResponse(ATResponse *p_response)
+{
+    char *line;
+    char ret;
 
-    at_response_free(p_response);
+    if (p_response == NULL || p_response->success == 0) {
+        return -1;
+    }
 
-    return (int)ret;
+    line = p_response->p_intermediates->line;
 
-error:
+    if (at_tok_start(&line) < 0) return -1;
 
-    at_response_free(p_response);
-    return -1;
+    if (at_tok_scan(&line, "b", &ret) < 0) return -1;
+
+    return (int)ret;
 }
 
 /**
@@ -3197,38 +3586,33 @@ error:
 int parse_technology_response( const char *response, int *current, int32_t *preferred )
 {
     int err;
-    char *line, *p;
+    /* numeric fields only, so at_tok_scan() leaves the line untouched */
+    char *p = (char *) response;
     int ct;
-    int32_t pt = 0;
-    char *str_pt;
+    int pt = 0;
 
-    line = p = strdup(response);
-    RLOGD("Response: %s", line);
+    RLOGD("Response: %s", response);
     err = at_tok_start(&p);
     if (err || !at_tok_hasmore(&p)) {
         RLOGD("err: %d. p: %s", err, p);
-        free(line);
         return -1;
     }
 
-    err = at_tok_nextint(&p, &ct);
-    if (err) {
-        free(line);
+    err = at_tok_scan(&p, "d", &ct);
+    if (err < 0) {
         return -1;
     }
     if (current) *current = ct;
 
     RLOGD("line remaining after int: %s", p);
 
-    err = at_tok_nexthexint(&p, &pt);
-    if (err) {
-        free(line);
+    err = at_tok_scan(&p, "x", &pt);
+    if (err < 0) {
         return 1;
     }
     if (preferred) {
         *preferred = pt;
     }
-    free(line);
 
     return 0;
 }
@@ -3347,86 +3731,199 @@ static void probeForModemMode(ModemInfo *info)
     RLOGI("Found GSM Modem");
 }
 
+static long long elapsedRealtimeMsec()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/** Starts a new bring-up timeline; called right after at_open() */
+static void startBootTimeline()
+{
+    pthread_mutex_lock(&s_boot_mutex);
+    s_bootStart = elapsedRealtimeMsec();
+    s_numBootStages = 0;
+    pthread_mutex_unlock(&s_boot_mutex);
+}
+
+/**
+ * Records the end of a bring-up stage. "final" ends the timeline and
+ * logs the whole of it, so later radio power changes don't show up
+ */
+static void markBootStage(const char *stage, int final)
+{
+    long long now = elapsedRealtimeMsec();
+    long long prev = 0;
+    int i;
+
+    pthread_mutex_lock(&s_boot_mutex);
+
+    if (s_bootStart < 0) {
+        pthread_mutex_unlock(&s_boot_mutex);
+        return;
+    }
+
+    if (s_numBootStages < MAX_BOOT_STAGES) {
+        s_bootStages[s_numBootStages].stage = stage;
+        s_bootStages[s_numBootStages].msec = now - s_bootStart;
+        s_numBootStages++;
+    }
+
+    if (final) {
+        for (i = 0; i < s_numBootStages; i++) {
+            RLOGI("bring-up: %-12s +%5lld ms (%lld ms)", s_bootStages[i].stage,
+                    s_bootStages[i].msec, s_bootStages[i].msec - prev);
+            prev = s_bootStages[i].msec;
+        }
+        s_bootStart = -1;
+    }
+
+    pthread_mutex_unlock(&s_boot_mutex);
+}
+
+/** returns the entry of script sending command, or NULL */
+static ATBatchCommand *findBatchCommand(ATBatchCommand *script, int count,
+                                        const char *command)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (strcmp(script[i].command, command) == 0) {
+            return &script[i];
+        }
+    }
+    return NULL;
+}
+
+/** returns 1 if p_command was sent and answered OK */
+static int batchCommandSucceeded(const ATBatchCommand *p_command)
+{
+    return p_command != NULL && p_command->err == 0 && p_command->p_response->success;
+}
+
 /**
  * Initialize everything that can be configured while we're still in
  * AT+CFUN=0
  */
 static void initializeCallback(void *param __unused)
 {
-    ATResponse *p_response = NULL;
-    int err;
+    /* Sent as one batch: each command goes out as soon as the previous
+       one is answered. AT+CFUN? comes last and decides the radio state */
+    ATBatchCommand script[] = {
+        /*  atchannel is tolerant of echo but it must */
+        /*  have verbose result codes */
+        { "ATE0Q0V1", NO_RESULT, NULL, 0, NULL },
 
-    setRadioState (RADIO_STATE_OFF);
+        /*  No auto-answer */
+        { "ATS0=0", NO_RESULT, NULL, 0, NULL },
 
-    at_handshake();
+        /*  Extended errors */
+        { "AT+CMEE=1", NO_RESULT, NULL, 0, NULL },
 
-    probeForModemMode(sMdmInfo);
-    /* note: we don't check errors here. Everything important will
-       be handled in onATTimeout and onATReaderClosed */
+        /*  Network registration events */
+        { "AT+CREG=2", NO_RESULT, NULL, 0, NULL },
 
-    /*  atchannel is tolerant of echo but it must */
-    /*  have verbose result codes */
-    at_send_command("ATE0Q0V1", NULL);
+        /*  GPRS registration events */
+        { "AT+CGREG=1", NO_RESULT, NULL, 0, NULL },
 
-    /*  No auto-answer */
-    at_send_command("ATS0=0", NULL);
+        /*  Call Waiting notifications */
+        { "AT+CCWA=1", NO_RESULT, NULL, 0, NULL },
 
-    /*  Extended errors */
-    at_send_command("AT+CMEE=1", NULL);
+        /*  Push +CLCC on call changes; polled instead if unsupported */
+        { "AT+CLCC=1", NO_RESULT, NULL, 0, NULL },
 
-    /*  Network registration events */
-    err = at_send_command("AT+CREG=2", &p_response);
+        /*  Alternating voice/data off */
+        { "AT+CMOD=0", NO_RESULT, NULL, 0, NULL },
 
-    /* some handsets -- in tethered mode -- don't support CREG=2 */
-    if (err < 0 || p_response->success == 0) {
-        at_send_command("AT+CREG=1", NULL);
-    }
+        /*  Not muted */
+        { "AT+CMUT=0", NO_RESULT, NULL, 0, NULL },
 
-    at_response_free(p_response);
+        /*  +CSSU unsolicited supp service notifications */
+        { "AT+CSSN=0,1", NO_RESULT, NULL, 0, NULL },
+
+        /*  no connected line identification */
+        { "AT+COLP=0", NO_RESULT, NULL, 0, NULL },
 
-    /*  GPRS registration events */
-    at_send_command("AT+CGREG=1", NULL);
+        /*  HEX character set */
+        { "AT+CSCS=\"HEX\"", NO_RESULT, NULL, 0, NULL },
 
-    /*  Call Waiting notifications */
-    at_send_command("AT+CCWA=1", NULL);
+        /*  USSD unsolicited */
+        { "AT+CUSD=1", NO_RESULT, NULL, 0, NULL },
 
-    /*  Alternating voice/data off */
-    at_send_command("AT+CMOD=0", NULL);
+        /*  Enable +CGEV GPRS event notifications, but don't buffer */
+        { "AT+CGEREP=1,0", NO_RESULT, NULL, 0, NULL },
 
-    /*  Not muted */
-    at_send_command("AT+CMUT=0", NULL);
+        /*  SMS PDU mode */
+        { "AT+CMGF=0", NO_RESULT, NULL, 0, NULL },
 
-    /*  +CSSU unsolicited supp service notifications */
-    at_send_command("AT+CSSN=0,1", NULL);
+#ifdef USE_TI_COMMANDS
 
-    /*  no connected line identification */
-    at_send_command("AT+COLP=0", NULL);
+        { "AT%CPI=3", NO_RESULT, NULL, 0, NULL },
 
-    /*  HEX character set */
-    at_send_command("AT+CSCS=\"HEX\"", NULL);
+        /*  TI specific -- notifications when SMS is ready (currently ignored) */
+        { "AT%CSTAT=1", NO_RESULT, NULL, 0, NULL },
 
-    /*  USSD unsolicited */
-    at_send_command("AT+CUSD=1", NULL);
+#endif /* USE_TI_COMMANDS */
 
-    /*  Enable +CGEV GPRS event notifications, but don't buffer */
-    at_send_command("AT+CGEREP=1,0", NULL);
+        { "AT+CFUN?", SINGLELINE, "+CFUN:", 0, NULL },
+    };
+    const int numCommands = sizeof(script) / sizeof(script[0]);
+    ATBatchCommand *p_creg = findBatchCommand(script, numCommands, "AT+CREG=2");
+    ATBatchCommand *p_clcc = findBatchCommand(script, numCommands, "AT+CLCC=1");
+    ATBatchCommand *p_cgerep = findBatchCommand(script, numCommands, "AT+CGEREP=1,0");
+    ATBatchCommand *p_cfun = findBatchCommand(script, numCommands, "AT+CFUN?");
+    int radioOn = -1;
+    int i;
 
-    /*  SMS PDU mode */
-    at_send_command("AT+CMGF=0", NULL);
+    setRadioState (RADIO_STATE_OFF);
 
-#ifdef USE_TI_COMMANDS
+    at_handshake();
+    markBootStage("handshake", 0);
+
+    probeForModemMode(sMdmInfo);
+    markBootStage("probe", 0);
+    /* note: we don't check errors here. Everything important will
+       be handled in onATTimeout and onATReaderClosed */
+
+    invalidateCallTable();
+    s_callPushReporting = 0;
+    invalidatePdpTable();
+    s_pdpEventReporting = 0;
+    s_pdpAddressQuery = 1;
 
-    at_send_command("AT%CPI=3", NULL);
+    if (at_send_command_batch(script, numCommands) == 0) {
+        /* some handsets -- in tethered mode -- don't support CREG=2 */
+        if (!batchCommandSucceeded(p_creg)) {
+            at_send_command("AT+CREG=1", NULL);
+        }
 
-    /*  TI specific -- notifications when SMS is ready (currently ignored) */
-    at_send_command("AT%CSTAT=1", NULL);
+        s_callPushReporting = batchCommandSucceeded(p_clcc);
+        RLOGI("Call state %s", s_callPushReporting ? "pushed by the modem" : "polled");
 
-#endif /* USE_TI_COMMANDS */
+        s_pdpEventReporting = batchCommandSucceeded(p_cgerep);
+#ifdef WORKAROUND_FAKE_CGEV
+        /* the stack may take AT+CGEREP and still never send +CGEV */
+        s_pdpEventReporting = 0;
+#endif /* WORKAROUND_FAKE_CGEV */
+
+        if (p_cfun != NULL && p_cfun->err == 0) {
+            radioOn = radioOnFromResponse(p_cfun->p_response);
+        }
 
+        for (i = 0; i < numCommands; i++) {
+            at_response_free(script[i].p_response);
+        }
+    }
+    markBootStage("configure", 0);
 
     /* assume radio is off on error */
-    if (isRadioOn() > 0) {
+    if (radioOn > 0) {
         setRadioState (RADIO_STATE_ON);
+    } else {
+        /* RADIO_STATE_ON will wait for RIL_REQUEST_RADIO_POWER */
+        markBootStage("radio off", 1);
     }
 }
 
@@ -3453,170 +3950,283 @@ static void sendUnsolImsNetworkStateChanged()
             NULL, 0);
 }
 
-/**
- * Called by atchannel when an unsolicited line appears
- * This is called on atchannel's reader thread. AT commands may
- * not be issued here
+/*
+ * Unsolicited response handlers, registered with at_urc_register() by
+ * registerUrcHandlers(). All of them run on atchannel's reader thread,
+ * so AT commands may not be issued here.
  */
-static void onUnsolicited (const char *s, const char *sms_pdu)
+
+static void onNitzTime(const ATUrcView *view, const char *sms_pdu __unused)
 {
-    char *line = NULL, *p;
-    int err;
+    /* TI specific -- NITZ time */
+    char response[64];
 
-    /* Ignore unsolicited responses until we're initialized.
-     * This is OK because the RIL library will poll for initial state
-     */
-    if (sState == RADIO_STATE_UNAVAILABLE) {
+    if (at_urc_arg_str(view, 0, response, sizeof(response)) < 0) {
+        RLOGE("invalid NITZ line %s\n", view->line);
         return;
     }
 
-    if (strStartsWith(s, "%CTZV:")) {
-        /* TI specific -- NITZ time */
-        char *response;
-
-        line = p = strdup(s);
-        at_tok_start(&p);
-
-        err = at_tok_nextstr(&p, &response);
+    RIL_onUnsolicitedResponse (
+        RIL_UNSOL_NITZ_TIME_RECEIVED,
+        response, strlen(response) + 1);
+}
 
-        if (err != 0) {
-            RLOGE("invalid NITZ line %s\n", s);
-        } else {
-            RIL_onUnsolicitedResponse (
-                RIL_UNSOL_NITZ_TIME_RECEIVED,
-                response, strlen(response) + 1);
-        }
-        free(line);
-    } else if (strStartsWith(s,"+CRING:")
-                || strStartsWith(s,"RING")
-                || strStartsWith(s,"NO CARRIER")
-                || strStartsWith(s,"+CCWA")
-    ) {
+static void onCallStateChanged(const ATUrcView *view __unused, const char *sms_pdu __unused)
+{
+    if (s_callPushReporting) {
+        /* RING repeats while the call rings; only a real change is reported */
+        scheduleCallTableRefresh(&TIMEVAL_0);
+    } else {
         RIL_onUnsolicitedResponse (
             RIL_UNSOL_RESPONSE_CALL_STATE_CHANGED,
             NULL, 0);
+    }
 #ifdef WORKAROUND_FAKE_CGEV
-        RIL_requestTimedCallback (onDataCallListChanged, NULL, NULL); //TODO use new function
-#endif /* WORKAROUND_FAKE_CGEV */
-    } else if (strStartsWith(s,"+CREG:")
-                || strStartsWith(s,"+CGREG:")
-    ) {
-        RIL_onUnsolicitedResponse (
-            RIL_UNSOL_RESPONSE_VOICE_NETWORK_STATE_CHANGED,
-            NULL, 0);
-#ifdef WORKAROUND_FAKE_CGEV
-        RIL_requestTimedCallback (onDataCallListChanged, NULL, NULL);
-#endif /* WORKAROUND_FAKE_CGEV */
-    } else if (strStartsWith(s, "+CMT:")) {
-        RIL_onUnsolicitedResponse (
-            RIL_UNSOL_RESPONSE_NEW_SMS,
-            sms_pdu, strlen(sms_pdu));
-    } else if (strStartsWith(s, "+CDS:")) {
-        RIL_onUnsolicitedResponse (
-            RIL_UNSOL_RESPONSE_NEW_SMS_STATUS_REPORT,
-            sms_pdu, strlen(sms_pdu));
-    } else if (strStartsWith(s, "+CGEV:")) {
-        /* Really, we can ignore NW CLASS and ME CLASS events here,
-         * but right now we don't since extranous
-         * RIL_UNSOL_DATA_CALL_LIST_CHANGED calls are tolerated
-         */
-        /* can't issue AT commands here -- call on main thread */
-        RIL_requestTimedCallback (onDataCallListChanged, NULL, NULL);
-#ifdef WORKAROUND_FAKE_CGEV
-    } else if (strStartsWith(s, "+CME ERROR: 150")) {
-        RIL_requestTimedCallback (onDataCallListChanged, NULL, NULL);
+    queuePdpEvent(-1, 0);
 #endif /* WORKAROUND_FAKE_CGEV */
-    } else if (strStartsWith(s, "+CTEC: ")) {
-        int tech, mask;
-        switch (parse_technology_response(s, &tech, NULL))
-        {
-            case -1: // no argument could be parsed.
-                RLOGE("invalid CTEC line %s\n", s);
-                break;
-            case 1: // current mode correctly parsed
-            case 0: // preferred mode correctly parsed
-                mask = 1 << tech;
-                if (mask != MDM_GSM && mask != MDM_CDMA &&
-                     mask != MDM_WCDMA && mask != MDM_LTE) {
-                    RLOGE("Unknown technology %d\n", tech);
-                } else {
-                    setRadioTechnology(sMdmInfo, tech);
-                }
-                break;
-        }
-    } else if (strStartsWith(s, "+CCSS: ")) {
-        int source = 0;
-        line = p = strdup(s);
-        if (!line) {
-            RLOGE("+CCSS: Unable to allocate memory");
-            return;
-        }
-        if (at_tok_start(&p) < 0) {
-            free(line);
-            return;
-        }
-        if (at_tok_nextint(&p, &source) < 0) {
-            RLOGE("invalid +CCSS response: %s", line);
-            free(line);
-            return;
-        }
-        SSOURCE(sMdmInfo) = source;
-        RIL_onUnsolicitedResponse(RIL_UNSOL_CDMA_SUBSCRIPTION_SOURCE_CHANGED,
-                                  &source, sizeof(source));
-    } else if (strStartsWith(s, "+WSOS: ")) {
-        char state = 0;
-        int unsol;
-        line = p = strdup(s);
-        if (!line) {
-            RLOGE("+WSOS: Unable to allocate memory");
-            return;
-        }
-        if (at_tok_start(&p) < 0) {
-            free(line);
-            return;
+}
+
+/**
+ * "+CLCC: <id>,<dir>,<stat>,..." pushed for each call that changed, once
+ * AT+CLCC=1 is on. <stat> 6 is the release of the call.
+ */
+static void onCallListUpdate(const ATUrcView *view, const char *sms_pdu __unused)
+{
+    char line[MAX_AT_RESPONSE];
+    RIL_Call call;
+    int index;
+    int stat;
+    int changed = -1;
+
+    if (at_urc_arg_int(view, 0, &index) < 0 || at_urc_arg_int(view, 2, &stat) < 0) {
+        RLOGE("invalid CLCC line %s\n", view->line);
+        scheduleCallTableRefresh(&TIMEVAL_0);
+        return;
+    }
+
+    if (stat == CLCC_STAT_RELEASED) {
+        pthread_mutex_lock(&s_callTableMutex);
+        if (s_callTableValid) {
+            changed = call_table_remove(&s_callTable, index);
+            s_callTableGeneration++;
         }
-        if (at_tok_nextbool(&p, &state) < 0) {
-            RLOGE("invalid +WSOS response: %s", line);
-            free(line);
-            return;
+        pthread_mutex_unlock(&s_callTableMutex);
+    } else {
+        memset(&call, 0, sizeof(call));
+        snprintf(line, sizeof(line), "%s", view->line);
+        if (callFromCLCCLine(line, &call) == 0) {
+            pthread_mutex_lock(&s_callTableMutex);
+            if (s_callTableValid) {
+                changed = call_table_update(&s_callTable, &call);
+                s_callTableGeneration++;
+            }
+            pthread_mutex_unlock(&s_callTableMutex);
         }
-        free(line);
+    }
+
+    if (changed < 0) {
+        /* not tracking yet, or the line could not be applied */
+        scheduleCallTableRefresh(&TIMEVAL_0);
+    } else if (changed > 0) {
+        sendCallStateChanged(NULL);
+    }
+}
+
+static void onNetworkStateChanged(const ATUrcView *view __unused, const char *sms_pdu __unused)
+{
+    RIL_onUnsolicitedResponse (
+        RIL_UNSOL_RESPONSE_VOICE_NETWORK_STATE_CHANGED,
+        NULL, 0);
+#ifdef WORKAROUND_FAKE_CGEV
+    queuePdpEvent(-1, 0);
+#endif /* WORKAROUND_FAKE_CGEV */
+}
+
+static void onNewSms(const ATUrcView *view __unused, const char *sms_pdu)
+{
+    RIL_onUnsolicitedResponse (
+        RIL_UNSOL_RESPONSE_NEW_SMS,
+        sms_pdu, strlen(sms_pdu));
+}
+
+static void onNewSmsStatusReport(const ATUrcView *view __unused, const char *sms_pdu)
+{
+    RIL_onUnsolicitedResponse (
+        RIL_UNSOL_RESPONSE_NEW_SMS_STATUS_REPORT,
+        sms_pdu, strlen(sms_pdu));
+}
 
-        unsol = state ?
-                RIL_UNSOL_ENTER_EMERGENCY_CALLBACK_MODE : RIL_UNSOL_EXIT_EMERGENCY_CALLBACK_MODE;
+static void onPacketDomainEvent(const ATUrcView *view, const char *sms_pdu __unused)
+{
+    char event[64];
+    const char *p;
+    int cid = -1;
+    int active = 0;
+
+    /* can't issue AT commands here -- the event is applied on main thread */
+    if (at_urc_arg_str(view, 0, event, sizeof(event)) < 0) {
+        queuePdpEvent(-1, 0);
+        return;
+    }
 
-        RIL_onUnsolicitedResponse(unsol, NULL, 0);
+    /* 27.007 10.1.19; whether the network or the ME started it is moot */
+    p = event;
+    if (!strncmp(p, "NW ", 3) || !strncmp(p, "ME ", 3)) {
+        p += 3;
+    }
 
-    } else if (strStartsWith(s, "+WPRL: ")) {
-        int version = -1;
-        line = p = strdup(s);
-        if (!line) {
-            RLOGE("+WPRL: Unable to allocate memory");
-            return;
+    if (!strncmp(p, "CLASS", 5)) {
+        /* mobile class changes leave the contexts alone */
+        return;
+    } else if (!strncmp(p, "PDN ACT ", 8)) {
+        active = 1;
+        cid = atoi(p + 8);
+    } else if (!strncmp(p, "PDN DEACT ", 10)) {
+        cid = atoi(p + 10);
+    } else if (!strncmp(p, "ACT ", 4)) {
+        /* secondary context: <p_cid>, <cid>, <event_type> */
+        active = 1;
+        if (at_urc_arg_int(view, 1, &cid) < 0) {
+            cid = -1;
         }
-        if (at_tok_start(&p) < 0) {
-            RLOGE("invalid +WPRL response: %s", s);
-            free(line);
-            return;
+    } else if (!strncmp(p, "DEACT ", 6)) {
+        /* <p_cid>, <cid>, <event_type> or <PDP_type>, <PDP_addr>[, <cid>] */
+        if (at_urc_arg_int(view, p[6] >= '0' && p[6] <= '9' ? 1 : 2, &cid) < 0) {
+            cid = -1;
         }
-        if (at_tok_nextint(&p, &version) < 0) {
-            RLOGE("invalid +WPRL response: %s", s);
-            free(line);
-            return;
+    }
+
+    /* anything else, like a detach, has every context read again */
+    queuePdpEvent(cid, active);
+}
+
+static void onTechnologyChanged(const ATUrcView *view, const char *sms_pdu __unused)
+{
+    int tech, mask;
+    switch (parse_technology_response(view->line, &tech, NULL))
+    {
+        case -1: // no argument could be parsed.
+            RLOGE("invalid CTEC line %s\n", view->line);
+            break;
+        case 1: // current mode correctly parsed
+        case 0: // preferred mode correctly parsed
+            mask = 1 << tech;
+            if (mask != MDM_GSM && mask != MDM_CDMA &&
+                 mask != MDM_WCDMA && mask != MDM_LTE) {
+                RLOGE("Unknown technology %d\n", tech);
+            } else {
+                setRadioTechnology(sMdmInfo, tech);
+            }
+            break;
+    }
+}
+
+static void onSubscriptionSourceChanged(const ATUrcView *view, const char *sms_pdu __unused)
+{
+    int source = 0;
+
+    if (at_urc_arg_int(view, 0, &source) < 0) {
+        RLOGE("invalid +CCSS response: %s", view->line);
+        return;
+    }
+    SSOURCE(sMdmInfo) = source;
+    RIL_onUnsolicitedResponse(RIL_UNSOL_CDMA_SUBSCRIPTION_SOURCE_CHANGED,
+                              &source, sizeof(source));
+}
+
+static void onEmergencyCallbackMode(const ATUrcView *view, const char *sms_pdu __unused)
+{
+    char state = 0;
+    int unsol;
+
+    if (at_urc_arg_bool(view, 0, &state) < 0) {
+        RLOGE("invalid +WSOS response: %s", view->line);
+        return;
+    }
+
+    unsol = state ?
+            RIL_UNSOL_ENTER_EMERGENCY_CALLBACK_MODE : RIL_UNSOL_EXIT_EMERGENCY_CALLBACK_MODE;
+
+    RIL_onUnsolicitedResponse(unsol, NULL, 0);
+}
+
+static void onPrlChanged(const ATUrcView *view, const char *sms_pdu __unused)
+{
+    int version = -1;
+
+    if (at_urc_arg_int(view, 0, &version) < 0) {
+        RLOGE("invalid +WPRL response: %s", view->line);
+        return;
+    }
+    RIL_onUnsolicitedResponse(RIL_UNSOL_CDMA_PRL_CHANGED, &version, sizeof(version));
+}
+
+static void onRadioOff(const ATUrcView *view __unused, const char *sms_pdu __unused)
+{
+    setRadioState(RADIO_STATE_OFF);
+}
+
+static const struct {
+    const char *prefix;
+    ATUrcHandler handler;
+} s_urcHandlers[] = {
+    { "%CTZV:",         onNitzTime },
+    { "+CRING:",        onCallStateChanged },
+    { "RING",           onCallStateChanged },
+    { "NO CARRIER",     onCallStateChanged },
+    { "+CCWA",          onCallStateChanged },
+    { "+CLCC:",         onCallListUpdate },
+    { "+CREG:",         onNetworkStateChanged },
+    { "+CGREG:",        onNetworkStateChanged },
+    { "+CMT:",          onNewSms },
+    { "+CDS:",          onNewSmsStatusReport },
+    { "+CGEV:",         onPacketDomainEvent },
+#ifdef WORKAROUND_FAKE_CGEV
+    { "+CME ERROR: 150", onPacketDomainEvent },
+#endif /* WORKAROUND_FAKE_CGEV */
+    { "+CTEC: ",        onTechnologyChanged },
+    { "+CCSS: ",        onSubscriptionSourceChanged },
+    { "+WSOS: ",        onEmergencyCallbackMode },
+    { "+WPRL: ",        onPrlChanged },
+    { "+CFUN: 0",       onRadioOff },
+};
+
+static void registerUrcHandlers()
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(s_urcHandlers) / sizeof(s_urcHandlers[0]); i++) {
+        if (at_urc_register(s_urcHandlers[i].prefix, s_urcHandlers[i].handler) < 0) {
+            RLOGE("Unable to register handler for %s", s_urcHandlers[i].prefix);
         }
-        free(line);
-        RIL_onUnsolicitedResponse(RIL_UNSOL_CDMA_PRL_CHANGED, &version, sizeof(version));
-    } else if (strStartsWith(s, "+CFUN: 0")) {
-        setRadioState(RADIO_STATE_OFF);
     }
 }
 
+/**
+ * Called by atchannel when an unsolicited line appears
+ * This is called on atchannel's reader thread. AT commands may
+ * not be issued here
+ */
+static void onUnsolicited (const char *s, const char *sms_pdu)
+{
+    /* Ignore unsolicited responses until we're initialized.
+     * This is OK because the RIL library will poll for initial state
+     */
+    if (sState == RADIO_STATE_UNAVAILABLE) {
+        return;
+    }
+
+    at_urc_dispatch(s, sms_pdu);
+}
+
 /* Called on command or reader thread */
 static void onATReaderClosed()
 {
     RLOGI("AT channel closed\n");
     at_close();
     s_closed = 1;
+    invalidateCallTable();
+    invalidatePdpTable();
 
     setRadioState (RADIO_STATE_UNAVAILABLE);
 }
@@ -3628,6 +4238,8 @@ static void onATTimeout()
     at_close();
 
     s_closed = 1;
+    invalidateCallTable();
+    invalidatePdpTable();
 
     /* FIXME cause a radio reset here */
 
@@ -3661,6 +4273,7 @@ mainLoop(void *param __unused)
     AT_DUMP("== ", "entering mainLoop()", -1 );
     at_set_on_reader_closed(onATReaderClosed);
     at_set_on_timeout(onATTimeout);
+    registerUrcHandlers();
 
     for (;;) {
         fd = -1;
@@ -3697,6 +4310,8 @@ mainLoop(void *param __unused)
             return 0;
         }
 
+        startBootTimeline();
+
         RIL_requestTimedCallback(initializeCallback, NULL, &TIMEVAL_0);
 
         // Give initializeCallback a chance to dispatched, since